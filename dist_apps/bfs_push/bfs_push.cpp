@@ -232,6 +232,9 @@ struct BFS {
       _graph.sync<writeDestination, readSource, Reduce_min_dist_current,
                   Broadcast_dist_current, Bitset_dist_current, true>("BFS");
 #else
+      // the active count is final once the operator is done, so reduce it
+      // while the sync is in flight
+      dga.reduce_async(_graph.get_run_identifier());
       _graph.sync<writeDestination, readSource, Reduce_min_dist_current,
                   Broadcast_dist_current, Bitset_dist_current>("BFS");
 #endif
@@ -243,9 +246,11 @@ struct BFS {
       ++_num_iterations;
     } while (
 #ifndef __GALOIS_HET_ASYNC__
-             (_num_iterations < maxIterations) &&
+             (_num_iterations < maxIterations) && dga.wait()
+#else
+             dga.reduce(_graph.get_run_identifier())
 #endif
-             dga.reduce(_graph.get_run_identifier()));
+    );
 
     galois::runtime::reportStat_Tmax(
         regionname, "NumIterations_" + std::to_string(_graph.get_run_num()),
@@ -315,8 +320,10 @@ struct BFSSanityCheck {
                      galois::no_stats(), galois::loopname("BFSSanityCheck"));
     }
 
-    uint64_t num_visited  = dgas.reduce();
-    uint32_t max_distance = dgm.reduce();
+    galois::DGReduceGroup group;
+    group.add(dgas).add(dgm).reduce();
+    uint64_t num_visited  = dgas.read();
+    uint32_t max_distance = dgm.read();
 
     // Only host 0 will print the info
     if (galois::runtime::getSystemNetworkInterface().ID == 0) {
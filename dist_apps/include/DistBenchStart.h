@@ -151,6 +151,7 @@ loadDGraph(std::vector<unsigned>& scaleFactor,
   // Save local graph structure
   if (saveLocalGraph)
     (*loadedGraph).save_local_graph_to_file(localGraphFileName);
+  (*loadedGraph).save_partition_cache();
 
   return loadedGraph;
 }
@@ -200,6 +201,7 @@ loadSymmetricDGraph(std::vector<unsigned>& scaleFactor,
   // Save local graph structure
   if (saveLocalGraph)
     (*loadedGraph).save_local_graph_to_file(localGraphFileName);
+  (*loadedGraph).save_partition_cache();
 
   return loadedGraph;
 }
@@ -242,6 +244,9 @@ loadBDGraph(std::vector<unsigned>& scaleFactor,
 
   dGraphTimer.stop();
 
+  // Save local graph structure
+  (*loadedGraph).save_partition_cache();
+
   return loadedGraph;
 }
 
@@ -26,15 +26,136 @@
 #ifndef GALOIS_DISTACCUMULATOR_H
 #define GALOIS_DISTACCUMULATOR_H
 
+#include <cstring>
 #include <limits>
+#include <vector>
 #include "galois/Galois.h"
 #include "galois/Reduction.h"
 #include "galois/AtomicHelpers.h"
+#include "galois/Timer.h"
+#include "galois/gIO.h"
 #include "galois/runtime/LWCI.h"
 #include "galois/runtime/DistStats.h"
 
 namespace galois {
 
+class DGReduceGroup;
+
+namespace internal {
+
+#ifndef GALOIS_USE_LWCI
+/**
+ * Maps the value type of a distributed reducer to its MPI datatype.
+ *
+ * @tparam Ty type of value being reduced
+ */
+template <typename Ty>
+struct MPIType {
+  static_assert(sizeof(Ty) == 0,
+                "Type of distributed reducer not supported for MPI reduction");
+};
+
+template <>
+struct MPIType<int32_t> {
+  static MPI_Datatype get() { return MPI_INT; }
+};
+template <>
+struct MPIType<int64_t> {
+  static MPI_Datatype get() { return MPI_LONG; }
+};
+template <>
+struct MPIType<uint32_t> {
+  static MPI_Datatype get() { return MPI_UNSIGNED; }
+};
+template <>
+struct MPIType<uint64_t> {
+  static MPI_Datatype get() { return MPI_UNSIGNED_LONG; }
+};
+template <>
+struct MPIType<float> {
+  static MPI_Datatype get() { return MPI_FLOAT; }
+};
+template <>
+struct MPIType<double> {
+  static MPI_Datatype get() { return MPI_DOUBLE; }
+};
+template <>
+struct MPIType<long double> {
+  static MPI_Datatype get() { return MPI_LONG_DOUBLE; }
+};
+#endif
+
+/**
+ * State of a reduction that has been started but not yet waited on: the
+ * outstanding request plus the timers behind the latency statistics.
+ *
+ * Reports (when MORE_COMM_STATS is on) ReduceLatency_<runID>, the time in
+ * microseconds between starting the reduction and its completion, and
+ * ReduceWait_<runID>, the part of it the caller actually blocked for. The
+ * difference is the latency hidden behind other work.
+ */
+class PendingReduce {
+  std::string runID;
+  galois::Timer latencyTimer;
+  bool active = false;
+#ifndef GALOIS_USE_LWCI
+  MPI_Request request = MPI_REQUEST_NULL;
+#endif
+
+public:
+  PendingReduce() = default;
+  PendingReduce(const PendingReduce&) = delete;
+  PendingReduce& operator=(const PendingReduce&) = delete;
+
+  //! Completes any reduction still in flight so its buffers stay valid
+  ~PendingReduce() { complete(); }
+
+  //! @returns true if a reduction has been started and not completed
+  bool pending() const { return active; }
+
+  /**
+   * Marks the start of a reduction.
+   *
+   * @param id run identifier used in the statistic names
+   */
+  void begin(const std::string& id) {
+    GALOIS_ASSERT(!active, "Reduction started while another is in flight");
+    runID  = id;
+    active = true;
+    latencyTimer.start();
+  }
+
+#ifndef GALOIS_USE_LWCI
+  //! @returns the request the non-blocking collective should complete
+  MPI_Request* handle() { return &request; }
+#endif
+
+  /**
+   * Blocks until the outstanding reduction (if any) is done and reports
+   * its latency statistics.
+   */
+  void complete() {
+    if (!active)
+      return;
+
+    galois::Timer waitTimer;
+    waitTimer.start();
+#ifndef GALOIS_USE_LWCI
+    MPI_Wait(&request, MPI_STATUS_IGNORE);
+#endif
+    waitTimer.stop();
+    latencyTimer.stop();
+    active = false;
+
+    galois::runtime::reportStatCond_Tsum<MORE_COMM_STATS>(
+        "DGReducible", "ReduceLatency_" + runID, latencyTimer.get_usec());
+    galois::runtime::reportStatCond_Tsum<MORE_COMM_STATS>(
+        "DGReducible", "ReduceWait_" + runID, waitTimer.get_usec());
+  }
+};
+
+} // namespace internal
+
 /**
  * Distributed sum-reducer for getting the sum of some value across multiple
  * hosts.
@@ -48,6 +169,9 @@ class DGAccumulator {
 
   galois::GAccumulator<Ty> mdata;
   Ty local_mdata, global_mdata;
+  internal::PendingReduce pendingReduce;
+
+  friend class galois::DGReduceGroup;
 
 #ifdef GALOIS_USE_LWCI
   /**
@@ -151,6 +275,7 @@ public:
    * @returns the value of the last reduce call
    */
   Ty reset() {
+    pendingReduce.complete();
     Ty retval = global_mdata;
     mdata.reset();
     local_mdata = global_mdata = 0;
@@ -186,6 +311,38 @@ public:
 
     return global_mdata;
   }
+
+  /**
+   * Starts a non-blocking reduction of the local value across all hosts so
+   * that it can be overlapped with other work (e.g. the next sync). Every
+   * host must call it; the result is available from wait. The reducer must
+   * not be updated or reset in between.
+   *
+   * @param runID optional argument used to name the latency statistics
+   */
+  void reduce_async(std::string runID = std::string()) {
+    if (local_mdata == 0)
+      local_mdata = mdata.reduce();
+
+    pendingReduce.begin(runID);
+#ifdef GALOIS_USE_LWCI
+    reduce_lwci();
+#else
+    MPI_Iallreduce(&local_mdata, &global_mdata, 1,
+                   internal::MPIType<Ty>::get(), MPI_SUM, MPI_COMM_WORLD,
+                   pendingReduce.handle());
+#endif
+  }
+
+  /**
+   * Waits for the reduction started by reduce_async to finish.
+   *
+   * @returns the reduced value
+   */
+  Ty wait() {
+    pendingReduce.complete();
+    return global_mdata;
+  }
 };
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -203,6 +360,9 @@ class DGReduceMax {
 
   galois::GReduceMax<Ty> mdata; // local max reducer
   Ty local_mdata, global_mdata;
+  internal::PendingReduce pendingReduce;
+
+  friend class galois::DGReduceGroup;
 
 #ifdef GALOIS_USE_LWCI
   /**
@@ -290,6 +450,7 @@ public:
    * never reduced, it will be 0
    */
   Ty reset() {
+    pendingReduce.complete();
     Ty retval = global_mdata;
     mdata.reset();
     local_mdata = global_mdata = 0;
@@ -321,6 +482,38 @@ public:
 
     return global_mdata;
   }
+
+  /**
+   * Starts a non-blocking reduction of the local value across all hosts so
+   * that it can be overlapped with other work (e.g. the next sync). Every
+   * host must call it; the result is available from wait. The reducer must
+   * not be updated or reset in between.
+   *
+   * @param runID optional argument used to name the latency statistics
+   */
+  void reduce_async(std::string runID = std::string()) {
+    if (local_mdata == 0)
+      local_mdata = mdata.reduce();
+
+    pendingReduce.begin(runID);
+#ifdef GALOIS_USE_LWCI
+    reduce_lwci();
+#else
+    MPI_Iallreduce(&local_mdata, &global_mdata, 1,
+                   internal::MPIType<Ty>::get(), MPI_MAX, MPI_COMM_WORLD,
+                   pendingReduce.handle());
+#endif
+  }
+
+  /**
+   * Waits for the reduction started by reduce_async to finish.
+   *
+   * @returns the reduced value
+   */
+  Ty wait() {
+    pendingReduce.complete();
+    return global_mdata;
+  }
 };
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -338,6 +531,9 @@ class DGReduceMin {
 
   galois::GReduceMin<Ty> mdata; // local min reducer
   Ty local_mdata, global_mdata;
+  internal::PendingReduce pendingReduce;
+
+  friend class galois::DGReduceGroup;
 
 #ifdef GALOIS_USE_LWCI
   /**
@@ -426,6 +622,7 @@ public:
    * never reduced, it will be 0
    */
   Ty reset() {
+    pendingReduce.complete();
     Ty retval = global_mdata;
     mdata.reset();
     local_mdata = global_mdata = std::numeric_limits<Ty>::max();
@@ -457,6 +654,192 @@ public:
 
     return global_mdata;
   }
+
+  /**
+   * Starts a non-blocking reduction of the local value across all hosts so
+   * that it can be overlapped with other work (e.g. the next sync). Every
+   * host must call it; the result is available from wait. The reducer must
+   * not be updated or reset in between.
+   *
+   * @param runID optional argument used to name the latency statistics
+   */
+  void reduce_async(std::string runID = std::string()) {
+    if (local_mdata == std::numeric_limits<Ty>::max())
+      local_mdata = mdata.reduce();
+
+    pendingReduce.begin(runID);
+#ifdef GALOIS_USE_LWCI
+    reduce_lwci();
+#else
+    MPI_Iallreduce(&local_mdata, &global_mdata, 1,
+                   internal::MPIType<Ty>::get(), MPI_MIN, MPI_COMM_WORLD,
+                   pendingReduce.handle());
+#endif
+  }
+
+  /**
+   * Waits for the reduction started by reduce_async to finish.
+   *
+   * @returns the reduced value
+   */
+  Ty wait() {
+    pendingReduce.complete();
+    return global_mdata;
+  }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Fuses the reductions of several distributed reducers into one collective.
+ *
+ * Loops typically reduce a handful of scalars every round (work items,
+ * active nodes, max delta, ...), and each one is its own latency-bound
+ * allreduce. A group packs the local values of all registered reducers into
+ * one buffer, exchanges the buffers with a single MPI_Iallgather, and then
+ * combines them per reducer (sum, max or min). Every host combines the
+ * buffers in host order, so all hosts end up with identical values.
+ *
+ * Reducers must be registered in the same order on all hosts and must
+ * outlive the group. After wait returns, read on each registered reducer
+ * returns its reduced value.
+ */
+class DGReduceGroup {
+  //! Type-erased reducer registered with the group
+  struct Entry {
+    void* reducer;
+    size_t offset;
+    //! writes the local value of the reducer into the send buffer
+    void (*pack)(void* reducer, uint8_t* out);
+    //! combines the values of all hosts and stores them in the reducer
+    void (*unpack)(void* reducer, const uint8_t* in, size_t stride,
+                   unsigned numHosts);
+    //! blocking reduction of the reducer on its own
+    void (*reduce)(void* reducer, const std::string& runID);
+  };
+
+  std::vector<Entry> entries;
+  size_t stride = 0;
+  std::vector<uint8_t> sendBuffer;
+  std::vector<uint8_t> recvBuffer;
+  internal::PendingReduce pendingReduce;
+
+  template <typename R, typename Ty>
+  static void packEntry(void* reducer, uint8_t* out) {
+    Ty value = static_cast<R*>(reducer)->read_local();
+    std::memcpy(out, &value, sizeof(Ty));
+  }
+
+  template <typename R, typename Ty, typename Combine>
+  static void unpackEntry(void* reducer, const uint8_t* in, size_t stride,
+                          unsigned numHosts) {
+    Combine combine;
+    Ty result;
+    std::memcpy(&result, in, sizeof(Ty));
+    for (unsigned h = 1; h < numHosts; ++h) {
+      Ty value;
+      std::memcpy(&value, in + h * stride, sizeof(Ty));
+      result = combine(result, value);
+    }
+    static_cast<R*>(reducer)->global_mdata = result;
+  }
+
+  template <typename R>
+  static void reduceEntry(void* reducer, const std::string& runID) {
+    static_cast<R*>(reducer)->reduce(runID);
+  }
+
+  template <typename R, typename Ty, typename Combine>
+  void addEntry(R& reducer) {
+    GALOIS_ASSERT(!pendingReduce.pending(),
+                  "Cannot add to a group with a reduction in flight");
+    entries.push_back(Entry{&reducer, stride, &packEntry<R, Ty>,
+                            &unpackEntry<R, Ty, Combine>, &reduceEntry<R>});
+    stride += sizeof(Ty);
+  }
+
+public:
+  DGReduceGroup() = default;
+  DGReduceGroup(const DGReduceGroup&) = delete;
+  DGReduceGroup& operator=(const DGReduceGroup&) = delete;
+
+  //! Registers a sum-reducer with the group
+  template <typename Ty>
+  DGReduceGroup& add(DGAccumulator<Ty>& reducer) {
+    addEntry<DGAccumulator<Ty>, Ty, std::plus<Ty>>(reducer);
+    return *this;
+  }
+
+  //! Registers a max-reducer with the group
+  template <typename Ty>
+  DGReduceGroup& add(DGReduceMax<Ty>& reducer) {
+    addEntry<DGReduceMax<Ty>, Ty, galois::gmax<Ty>>(reducer);
+    return *this;
+  }
+
+  //! Registers a min-reducer with the group
+  template <typename Ty>
+  DGReduceGroup& add(DGReduceMin<Ty>& reducer) {
+    addEntry<DGReduceMin<Ty>, Ty, galois::gmin<Ty>>(reducer);
+    return *this;
+  }
+
+  /**
+   * Starts a single non-blocking collective that reduces every registered
+   * reducer. The reducers must not be updated or reset until wait returns.
+   *
+   * @param runID optional argument used to name the latency statistics
+   */
+  void reduce_async(std::string runID = std::string()) {
+    pendingReduce.begin(runID);
+#ifdef GALOIS_USE_LWCI
+    // no non-blocking gather under LWCI: reduce the members one by one
+    for (auto& e : entries) {
+      e.reduce(e.reducer, runID);
+    }
+#else
+    int numHosts;
+    MPI_Comm_size(MPI_COMM_WORLD, &numHosts);
+    sendBuffer.resize(stride);
+    recvBuffer.resize(stride * numHosts);
+    for (auto& e : entries) {
+      e.pack(e.reducer, sendBuffer.data() + e.offset);
+    }
+    MPI_Iallgather(sendBuffer.data(), stride, MPI_BYTE, recvBuffer.data(),
+                   stride, MPI_BYTE, MPI_COMM_WORLD, pendingReduce.handle());
+#endif
+  }
+
+  /**
+   * Waits for the collective started by reduce_async and stores the reduced
+   * value in every registered reducer.
+   */
+  void wait() {
+    if (!pendingReduce.pending())
+      return;
+    pendingReduce.complete();
+#ifndef GALOIS_USE_LWCI
+    unsigned numHosts = recvBuffer.size() / std::max<size_t>(stride, 1);
+    for (auto& e : entries) {
+      e.unpack(e.reducer, recvBuffer.data() + e.offset, stride, numHosts);
+    }
+#endif
+  }
+
+  /**
+   * Blocking reduction of every registered reducer in one collective.
+   *
+   * @param runID optional argument used to name the statistics
+   */
+  void reduce(std::string runID = std::string()) {
+    std::string timer_str("ReduceDGReduceGroup_" + runID);
+    galois::CondStatTimer<MORE_COMM_STATS> reduceTimer(timer_str.c_str(),
+                                                       "DGReducible");
+    reduceTimer.start();
+    reduce_async(runID);
+    wait();
+    reduceTimer.stop();
+  }
 };
 
 } // namespace galois
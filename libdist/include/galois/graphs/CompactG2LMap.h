@@ -0,0 +1,178 @@
+/*
+ * This file belongs to the Galois project, a C++ library for exploiting parallelism.
+ * The code is being released under the terms of the 3-Clause BSD License (a
+ * copy is located in LICENSE.txt at the top-level directory).
+ *
+ * Copyright (C) 2018, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ */
+
+
+/**
+ * @file CompactG2LMap.h
+ *
+ * Global to local id maps for distributed graphs that avoid a hash table.
+ * Masters, whose global ids form one contiguous range, are mapped with
+ * arithmetic; the remaining (mirror) global ids are kept in a sorted array
+ * next to their local ids and found by search.
+ */
+
+#ifndef GALOIS_GRAPHS_COMPACT_G2L_MAP_H
+#define GALOIS_GRAPHS_COMPACT_G2L_MAP_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace galois {
+namespace graphs {
+
+//! Data structure used to map global ids to local ids
+enum G2LMapKind {
+  hashG2L,   //!< std::unordered_map of every node
+  sortedG2L, //!< sorted mirror ids, interpolation search
+  radixG2L   //!< sorted mirror ids bucketed by the high bits of the id
+};
+
+/**
+ * Global to local id map stored as sorted arrays. Uses 8 bytes per mirror
+ * when global ids fit in 32 bits (12 otherwise), plus about 1 byte per
+ * mirror of buckets in radix mode, and nothing per master.
+ */
+class CompactG2LMap {
+  //! first global id of the contiguous master range
+  uint64_t masterGIDBegin;
+  //! number of masters; they have local ids [0, numMasters)
+  uint32_t numMasters;
+  //! sorted mirror global ids if all global ids fit in 32 bits
+  std::vector<uint32_t> keys32;
+  //! sorted mirror global ids otherwise
+  std::vector<uint64_t> keys64;
+  //! local id of each mirror, in key order
+  std::vector<uint32_t> lids;
+  //! radix mode: keys with (gid >> bucketShift) == b are in
+  //! [buckets[b], buckets[b + 1]); empty in sorted mode
+  std::vector<uint32_t> buckets;
+  //! radix mode: number of low bits of an id not used to pick a bucket
+  unsigned bucketShift;
+
+  //! Number of interpolation steps before falling back to binary search
+  static const unsigned INTERPOLATION_PROBES = 3;
+
+  /**
+   * Interpolation search; guesses a position from the key values at the
+   * ends of the current window, then finishes with binary search so that
+   * skewed id distributions cannot degrade it past O(log n).
+   */
+  template <typename K>
+  size_t interpolationSearch(const std::vector<K>& keys, uint64_t gid) const {
+    if (keys.empty() || gid < keys.front() || gid > keys.back()) {
+      return keys.size();
+    }
+    size_t lo = 0;
+    size_t hi = keys.size() - 1;
+    for (unsigned probe = 0; probe < INTERPOLATION_PROBES && lo < hi;
+         ++probe) {
+      uint64_t lowKey  = keys[lo];
+      uint64_t highKey = keys[hi];
+      if (gid < lowKey || gid > highKey) {
+        return keys.size();
+      }
+      size_t mid = lo + (size_t)((double)(gid - lowKey) / (highKey - lowKey) *
+                                 (hi - lo));
+      if (keys[mid] == gid) {
+        return mid;
+      } else if (keys[mid] < gid) {
+        lo = mid + 1;
+      } else if (mid == 0) {
+        return keys.size();
+      } else {
+        hi = mid - 1;
+      }
+    }
+    return binarySearch(keys, gid, lo, hi + 1);
+  }
+
+  //! Binary search for gid in keys [lo, hi); keys.size() if missing
+  template <typename K>
+  size_t binarySearch(const std::vector<K>& keys, uint64_t gid, size_t lo,
+                      size_t hi) const {
+    auto it = std::lower_bound(keys.begin() + lo, keys.begin() + hi, gid,
+                               [](K key, uint64_t g) { return key < g; });
+    if (it != keys.begin() + hi && *it == gid) {
+      return it - keys.begin();
+    }
+    return keys.size();
+  }
+
+  template <typename K>
+  size_t search(const std::vector<K>& keys, uint64_t gid) const {
+    if (buckets.empty()) {
+      return interpolationSearch(keys, gid);
+    }
+    uint64_t b = gid >> bucketShift;
+    if (b + 1 >= buckets.size()) {
+      return keys.size();
+    }
+    return binarySearch(keys, gid, buckets[b], buckets[b + 1]);
+  }
+
+public:
+  //! Returned by find for ids that are not local
+  static const uint32_t npos = ~uint32_t(0);
+
+  CompactG2LMap() : masterGIDBegin(0), numMasters(0), bucketShift(0) {}
+
+  /**
+   * Builds the map.
+   *
+   * @param kind sortedG2L or radixG2L
+   * @param l2g global id of each local id
+   * @param masters number of leading local ids whose global ids are
+   * candidates for the arithmetic range; used only if those ids are
+   * consecutive
+   * @param numGlobalNodes number of nodes in the whole graph
+   */
+  void build(G2LMapKind kind, const std::vector<uint64_t>& l2g,
+             uint32_t masters, uint64_t numGlobalNodes);
+
+  //! Frees all memory of the map
+  void clear();
+
+  //! @returns local id of gid, or npos if gid is not local
+  uint32_t find(uint64_t gid) const {
+    if (gid - masterGIDBegin < numMasters) {
+      return gid - masterGIDBegin;
+    }
+    if (keys64.empty()) {
+      size_t pos = search(keys32, gid);
+      return pos == keys32.size() ? npos : lids[pos];
+    }
+    size_t pos = search(keys64, gid);
+    return pos == keys64.size() ? npos : lids[pos];
+  }
+
+  //! @returns bytes of memory held by the map
+  size_t memoryBytes() const {
+    return keys32.capacity() * sizeof(uint32_t) +
+           keys64.capacity() * sizeof(uint64_t) +
+           lids.capacity() * sizeof(uint32_t) +
+           buckets.capacity() * sizeof(uint32_t);
+  }
+};
+
+} // namespace graphs
+} // namespace galois
+
+#endif
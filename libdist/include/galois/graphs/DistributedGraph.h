@@ -29,15 +29,27 @@
 
 #include <unordered_map>
 #include <fstream>
+#include <sstream>
+#include <cstring>
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <tuple>
+#include <typeindex>
 
 #include "galois/runtime/GlobalObj.h"
 #include "galois/graphs/BufferedGraph.h"
 #include "galois/graphs/B_LC_CSR_Graph.h"
 #include "galois/runtime/DistStats.h"
 #include "galois/graphs/OfflineGraph.h"
+#include "galois/graphs/PartitionCache.h"
+#include "galois/graphs/CompactG2LMap.h"
 #include "galois/runtime/SyncStructures.h"
 #include "galois/runtime/DataCommMode.h"
 #include "galois/DynamicBitset.h"
+#include "galois/ParallelSTL.h"
+#include "galois/substrate/PageAlloc.h"
+#include "galois/substrate/ThreadPool.h"
 
 #ifdef __GALOIS_HET_CUDA__
 #include "galois/cuda/HostDecls.h"
@@ -47,6 +59,7 @@
 #endif
 
 #include "galois/runtime/BareMPI.h"
+#include "galois/runtime/SyncCompression.h"
 
 #include "llvm/Support/CommandLine.h"
 
@@ -79,6 +92,14 @@ enum MASTERS_DISTRIBUTION {
 extern cll::opt<bool> partitionAgnostic;
 //! Specifies what format to send metadata in
 extern cll::opt<DataCommMode> enforce_metadata;
+//! Specifies how many shared nodes go in one message of a pipelined sync
+extern cll::opt<unsigned> syncPipelineChunk;
+//! Specifies the message size from which sync messages are block-compressed
+extern cll::opt<unsigned> syncCompressMin;
+//! Specifies how many rounds a memoized all-data sync is reused
+extern cll::opt<unsigned> syncMemoRounds;
+//! Specifies if received sync data is applied by the socket owning the nodes
+extern cll::opt<bool> syncNumaApply;
 //! Specifies how to distribute masters among hosts
 extern cll::opt<MASTERS_DISTRIBUTION> masters_distribution;
 //! Specifies how much weight to give to a node when
@@ -91,6 +112,13 @@ extern cll::opt<uint32_t> nodeAlphaRanges;
 extern cll::opt<unsigned> numFileThreads;
 //! Specifies the size of the buffer used for
 extern cll::opt<unsigned> edgePartitionSendBufSize;
+//! Specifies if generic partitioners read, exchange, and build edges in one
+//! streaming pass
+extern cll::opt<bool> streamPartition;
+//! Directory of the on-disk partition cache; empty disables the cache
+extern cll::opt<std::string> partitionCacheDir;
+//! Structure the generic partitioners use to map global ids to local ids
+extern cll::opt<galois::graphs::G2LMapKind> g2lMap;
 
 //! Enumeration for specifiying write location for sync calls
 enum WriteLocation {
@@ -136,6 +164,18 @@ private:
   //! Tracks current round number; has to be set manually by the user
   bool round;
 
+  //! Mapping of the partition cache that graph's topology points into, if
+  //! the graph was loaded from one. Declared before graph so that it is
+  //! unmapped only after graph is destroyed.
+  PartitionCacheMapping partitionCacheMapping;
+  //! Partition cache file that save_partition_cache writes; empty if the
+  //! cache is disabled or the graph was loaded from it
+  std::string partitionCacheFile;
+  //! Key of partitionCacheFile
+  PartitionCacheKey partitionCacheKey;
+  //! Policy string of partitionCacheFile
+  std::string partitionCachePolicy;
+
 protected:
   //! The internal graph used by DistGraph to represent the graph
   GraphTy graph;
@@ -221,6 +261,52 @@ private:
   galois::DynamicBitSet syncBitset;
   galois::PODResizeableArray<unsigned int> syncOffsets;
 
+  //! Chunk size the pipeline chunks below were built with
+  unsigned pipelineChunkSize = 0;
+  //! mirrorNodes of each host split into chunks of pipelineChunkSize; empty
+  //! if the whole list fits in one chunk
+  std::vector<std::vector<std::vector<size_t>>> mirrorChunks;
+  //! masterNodes of each host split into chunks of pipelineChunkSize; empty
+  //! if the whole list fits in one chunk
+  std::vector<std::vector<std::vector<size_t>>> masterChunks;
+
+  /**
+   * Memoized sync state of one shared-node list for one loop and sync
+   * structure (see syncMemoRounds). The sender and the receiver of the list
+   * run the same state machine on the messages they exchange, so both know
+   * when a message may be a raw value stream without any metadata. Such a
+   * message starts with a byte that says whether it is one (see
+   * sync_memo_valid).
+   */
+  struct SyncMemo {
+    //! consecutive onlyData messages exchanged over the list
+    unsigned onlyDataStreak = 0;
+    //! raw value streams exchanged since the plan was last revalidated
+    unsigned rawRounds = 0;
+    //! 1 if the list is a range of consecutive LIDs, 0 if not, -1 if unknown
+    int contiguous = -1;
+  };
+  //! Memoized sync states keyed by loop name, sync structure, shared-node
+  //! list, and direction (true for the sending side)
+  std::map<std::tuple<std::string, std::type_index, const size_t*, bool>,
+           SyncMemo>
+      syncMemos;
+
+  //! For each socket, one past the last LID whose node data was paged in by
+  //! a thread of that socket; empty if socket-local apply is not possible
+  std::vector<uint32_t> socketLIDEnd;
+  //! For each socket, the first thread on it, followed by the number of
+  //! threads the node data was paged in with
+  std::vector<unsigned> socketThreadBegin;
+  //! Caches whether a shared-node list (or chunk) is sorted by LID
+  std::map<const size_t*, bool> sortedSharedNodes;
+  //! Counts nodes applied by a thread of another socket than their data
+  galois::GAccumulator<size_t> remoteApplies;
+  //! Bytes of received sync data applied socket-locally and remotely in the
+  //! current reduce or broadcast; reported once it is done
+  size_t applyLocalBytes  = 0;
+  size_t applyRemoteBytes = 0;
+
 protected:
   //! Prints graph statistics.
   void printStatistics() {
@@ -561,10 +647,21 @@ protected:
       break;
     }
 
+    // the partitioner reads the edges of this host's nodes next (from the
+    // same page cache), so start reading them ahead of it
+    for (unsigned d = 0; id + d * numHosts < gid2host.size(); ++d) {
+      auto& nodes = gid2host[id + d * numHosts];
+      g.prefetchEdges(*g.edge_begin(nodes.first), *g.edge_begin(nodes.second));
+    }
+
     timer.stop();
 
     galois::runtime::reportStatCond_Tmax<MORE_DIST_STATS>(
         GRNAME, "MasterDistTime", timer.get());
+    galois::runtime::reportStatCond_Tmax<MORE_DIST_STATS>(
+        GRNAME, "MasterDistBytesRead", g.num_bytes_read());
+    galois::runtime::reportStatCond_Tmax<MORE_DIST_STATS>(
+        GRNAME, "MasterDistPrefetchTime", g.prefetch_usec() / 1000);
 
     galois::gPrint(
         "[", id, "] Master distribution time : ", timer.get_usec() / 1000000.0f,
@@ -1271,72 +1368,14 @@ private:
 
     Toffsets.start();
 
-    auto activeThreads = galois::getActiveThreads();
-    std::vector<unsigned int> t_prefix_bit_counts(activeThreads);
-
-    // count how many bits are set on each thread
-    galois::on_each([&](unsigned tid, unsigned nthreads) {
-      // TODO use block_range instead
-      unsigned int block_size = bitset_comm.size() / nthreads;
-      if ((bitset_comm.size() % nthreads) > 0)
-        ++block_size;
-      assert((block_size * nthreads) >= bitset_comm.size());
-
-      unsigned int start = tid * block_size;
-      unsigned int end   = (tid + 1) * block_size;
-      if (end > bitset_comm.size())
-        end = bitset_comm.size();
-
-      unsigned int count = 0;
-      for (unsigned int i = start; i < end; ++i) {
-        if (bitset_comm.test(i))
-          ++count;
-      }
+    // indices of the set bits in order; offsets is only resized to the
+    // number of set bits, so it stays small when few nodes are dirty
+    galois::ParallelSTL::compact_into(
+        boost::counting_iterator<unsigned int>(0),
+        boost::counting_iterator<unsigned int>(bitset_comm.size()), offsets,
+        [&](unsigned int i) { return bitset_comm.test(i); });
+    bit_set_count = offsets.size();
 
-      t_prefix_bit_counts[tid] = count;
-    });
-
-    // calculate prefix sum of bits per thread
-    for (unsigned int i = 1; i < activeThreads; ++i) {
-      t_prefix_bit_counts[i] += t_prefix_bit_counts[i - 1];
-    }
-    // total num of set bits
-    bit_set_count = t_prefix_bit_counts[activeThreads - 1];
-
-    // calculate the indices of the set bits and save them to the offset
-    // vector
-    if (bit_set_count > 0) {
-      offsets.resize(bit_set_count);
-      galois::on_each([&](unsigned tid, unsigned nthreads) {
-        // TODO use block_range instead
-        // TODO this is same calculation as above; maybe refactor it
-        // into function?
-        unsigned int block_size = bitset_comm.size() / nthreads;
-        if ((bitset_comm.size() % nthreads) > 0)
-          ++block_size;
-        assert((block_size * nthreads) >= bitset_comm.size());
-
-        unsigned int start = tid * block_size;
-        unsigned int end   = (tid + 1) * block_size;
-        if (end > bitset_comm.size())
-          end = bitset_comm.size();
-
-        unsigned int count = 0;
-        unsigned int t_prefix_bit_count;
-        if (tid == 0) {
-          t_prefix_bit_count = 0;
-        } else {
-          t_prefix_bit_count = t_prefix_bit_counts[tid - 1];
-        }
-
-        for (unsigned int i = start; i < end; ++i) {
-          if (bitset_comm.test(i)) {
-            offsets[t_prefix_bit_count + count] = i;
-            ++count;
-          }
-        }
-      });
-    }
     Toffsets.stop();
   }
 
@@ -1397,8 +1436,20 @@ private:
                                         bit_set_count);
     }
 
-    data_mode =
-        get_data_mode<typename FnTy::ValTy>(bit_set_count, indices.size());
+    // measure the run-length encoding of the offsets so the mode can be
+    // picked on its actual size (GPUs cannot decode it)
+    size_t runs_size = 0;
+#ifndef __GALOIS_HET_CUDA__
+    if ((enforce_data_mode == noData || enforce_data_mode == neverOnlyData ||
+         enforce_data_mode == runLengthData) &&
+        bit_set_count > 0) {
+      runs_size =
+          galois::runtime::offsetRunsSize(offsets.data(), bit_set_count);
+    }
+#endif
+
+    data_mode = get_data_mode<typename FnTy::ValTy>(
+        bit_set_count, indices.size(), runs_size);
   }
 
   /**
@@ -1919,6 +1970,39 @@ private:
                           get_run_identifier(loopName));
 
     if (parallelize) {
+      if (set_subset_socket_local<VecTy, FnTy, syncType, identity_offsets>(
+              loopName, indices, size, offsets, val_vec, bit_set_compute,
+              start)) {
+        return;
+      }
+
+      // with syncNumaApply, count the nodes applied by a thread of another
+      // socket than the one holding their data; each thread looks up the
+      // LID range of its socket once
+      if (syncNumaApply && !socketLIDEnd.empty()) {
+        remoteApplies.reset();
+        galois::on_each([&](unsigned tid, unsigned nthreads) {
+          unsigned socket = galois::substrate::ThreadPool::getSocket();
+          size_t lidBegin = socket ? socketLIDEnd[socket - 1] : 0;
+          size_t lidEnd   = socketLIDEnd[socket];
+          auto range =
+              galois::block_range(start, start + size, tid, nthreads);
+          size_t remote = 0;
+
+          for (size_t n = range.first; n < range.second; ++n) {
+            auto lid = indices[identity_offsets ? n : offsets[n]];
+            set_wrapper<FnTy, syncType>(lid, val_vec[n - start],
+                                        bit_set_compute);
+            remote += (lid < lidBegin || lid >= lidEnd);
+          }
+          remoteApplies += remote;
+        });
+
+        note_apply_bytes<FnTy>(size - remoteApplies.reduce(),
+                               remoteApplies.reduce());
+        return;
+      }
+
       galois::do_all(galois::iterate(start, start + size),
                      [&](unsigned int n) {
                        unsigned int offset;
@@ -1951,6 +2035,164 @@ private:
     }
   }
 
+  /**
+   * Determines which LIDs have their node data on which socket.
+   * LargeArray's blocked allocation has each thread page in an equal share
+   * of the bytes of the node data, so the LIDs of a socket are the
+   * contiguous range paged in by its threads. Leaves socketLIDEnd empty if
+   * threads are not numbered socket by socket.
+   */
+  void determineSocketLIDRanges() {
+    auto& pool        = galois::substrate::getThreadPool();
+    unsigned nthreads = galois::getActiveThreads();
+    size_t numNodes   = graph.size();
+    size_t pageSize   = galois::substrate::allocSize();
+    size_t bytes      = (numNodes * sizeof(NodeTy) + pageSize - 1) / pageSize *
+                   pageSize;
+
+    socketLIDEnd.clear();
+    socketThreadBegin.clear();
+
+    for (unsigned t = 0; t < nthreads; ++t) {
+      unsigned socket = pool.getSocket(t);
+      if (t > 0 && socket == pool.getSocket(t - 1)) {
+        continue;
+      }
+      if (socket != socketThreadBegin.size()) {
+        socketThreadBegin.clear();
+        return;
+      }
+      if (t > 0) {
+        // first node that starts in the share of thread t
+        size_t firstByte = t * bytes / nthreads;
+        socketLIDEnd.push_back(std::min(
+            numNodes, (firstByte + sizeof(NodeTy) - 1) / sizeof(NodeTy)));
+      }
+      socketThreadBegin.push_back(t);
+    }
+    socketLIDEnd.push_back(numNodes);
+    socketThreadBegin.push_back(nthreads);
+  }
+
+  //! Adds the values of a message applied socket-locally and remotely to
+  //! the bytes reported by report_apply_bytes
+  template <typename FnTy>
+  void note_apply_bytes(size_t local, size_t remote) {
+    applyLocalBytes += local * sizeof(typename FnTy::ValTy);
+    applyRemoteBytes += remote * sizeof(typename FnTy::ValTy);
+  }
+
+  //! Reports the bytes of received sync data applied socket-locally and
+  //! remotely since the last report
+  void report_apply_bytes(const std::string& loopName,
+                          const std::string& syncTypeStr) {
+    if (!syncNumaApply) {
+      return;
+    }
+    galois::runtime::reportStat_Tsum(
+        GRNAME, syncTypeStr + "ApplyLocalBytes_" + get_run_identifier(loopName),
+        applyLocalBytes);
+    galois::runtime::reportStat_Tsum(
+        GRNAME,
+        syncTypeStr + "ApplyRemoteBytes_" + get_run_identifier(loopName),
+        applyRemoteBytes);
+    applyLocalBytes  = 0;
+    applyRemoteBytes = 0;
+  }
+
+  /**
+   * Socket-local variant of the parallel set_subset (see syncNumaApply):
+   * the threads of each socket apply only the received values of the nodes
+   * whose data is on their socket. This requires the shared nodes to be
+   * sorted by LID, so that the values of a socket are a contiguous range of
+   * the message that can be found by binary search.
+   *
+   * @returns false (without applying anything) if socket-local apply is
+   * disabled or not possible for this message
+   */
+  template <typename VecTy, typename FnTy, SyncType syncType,
+            bool identity_offsets,
+            typename std::enable_if<std::is_same<
+                typename std::decay<VecTy>::type,
+                std::vector<size_t>>::value>::type* = nullptr>
+  bool set_subset_socket_local(
+      const std::string& loopName, const VecTy& indices, size_t size,
+      const galois::PODResizeableArray<unsigned int>& offsets,
+      galois::PODResizeableArray<typename FnTy::ValTy>& val_vec,
+      galois::DynamicBitSet& bit_set_compute, size_t start) {
+    if (!syncNumaApply || size == 0) {
+      return false;
+    }
+    if (socketThreadBegin.empty() ||
+        socketThreadBegin.back() != galois::getActiveThreads()) {
+      determineSocketLIDRanges();
+      if (socketThreadBegin.empty()) {
+        return false;
+      }
+    }
+    auto sorted = sortedSharedNodes.find(indices.data());
+    if (sorted == sortedSharedNodes.end()) {
+      sorted = sortedSharedNodes
+                   .emplace(indices.data(),
+                            std::is_sorted(indices.begin(), indices.end()))
+                   .first;
+    }
+    if (!sorted->second) {
+      return false;
+    }
+
+    auto lidOf = [&](size_t n) -> size_t {
+      return indices[identity_offsets ? n : offsets[n]];
+    };
+    // first value of the message whose node is at or after lid
+    auto lowerBound = [&](size_t lid) {
+      size_t lo = start;
+      size_t hi = start + size;
+      while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (lidOf(mid) < lid) {
+          lo = mid + 1;
+        } else {
+          hi = mid;
+        }
+      }
+      return lo;
+    };
+
+    auto& pool = galois::substrate::getThreadPool();
+    galois::on_each([&](unsigned tid, unsigned) {
+      unsigned socket = pool.getSocket(tid);
+      size_t nBegin   = lowerBound(socket ? socketLIDEnd[socket - 1] : 0);
+      size_t nEnd     = lowerBound(socketLIDEnd[socket]);
+      auto range      = galois::block_range(
+          nBegin, nEnd, tid - socketThreadBegin[socket],
+          socketThreadBegin[socket + 1] - socketThreadBegin[socket]);
+
+      for (size_t n = range.first; n < range.second; ++n) {
+        set_wrapper<FnTy, syncType>(lidOf(n), val_vec[n - start],
+                                    bit_set_compute);
+      }
+    });
+
+    note_apply_bytes<FnTy>(size, 0);
+    return true;
+  }
+
+  //! gidsData messages index nodes by an unsorted list of LIDs, so they are
+  //! never applied socket-locally
+  template <typename VecTy, typename FnTy, SyncType syncType,
+            bool identity_offsets,
+            typename std::enable_if<!std::is_same<
+                typename std::decay<VecTy>::type,
+                std::vector<size_t>>::value>::type* = nullptr>
+  bool set_subset_socket_local(
+      const std::string&, const VecTy&, size_t,
+      const galois::PODResizeableArray<unsigned int>&,
+      galois::PODResizeableArray<typename FnTy::ValTy>&,
+      galois::DynamicBitSet&, size_t) {
+    return false;
+  }
+
   /**
    * VECTOR BITSET VARIANT.
    *
@@ -2338,11 +2580,15 @@ private:
    * necessarily all nodees will be sent)
    * @param bitSetCount Number of nodes that will actually be sent
    * @param bitSetComm bitset used to send data
+   * @param messageSize Size of the serialized message, if known; used to
+   * report the bytes saved over the smallest of the bitset, offsets and
+   * only-data encodings
    */
   template <typename SyncFnTy>
   void reportRedundantSize(std::string loopName, std::string syncTypeStr,
                            uint32_t totalToSend, size_t bitSetCount,
-                           const galois::DynamicBitSet& bitSetComm) {
+                           const galois::DynamicBitSet& bitSetComm,
+                           size_t messageSize = 0) {
     size_t redundant_size =
         (totalToSend - bitSetCount) * sizeof(typename SyncFnTy::ValTy);
     size_t bit_set_size = (bitSetComm.get_vec().size() * sizeof(uint64_t));
@@ -2354,6 +2600,25 @@ private:
       galois::runtime::reportStatCond_Tsum<MORE_DIST_STATS>(
           GRNAME, statSavedBytes_str, (redundant_size - bit_set_size));
     }
+
+    if (messageSize > 0 && bitSetCount > 0) {
+      using ValTy       = typename SyncFnTy::ValTy;
+      size_t plain_size = std::min(
+          get_data_mode_size<ValTy>(onlyData, bitSetCount, totalToSend),
+          std::min(
+              get_data_mode_size<ValTy>(bitsetData, bitSetCount, totalToSend),
+              get_data_mode_size<ValTy>(offsetsData, bitSetCount,
+                                        totalToSend)));
+      plain_size += sizeof(DataCommMode);
+
+      if (plain_size > messageSize) {
+        std::string statEncodingSavedBytes_str(
+            syncTypeStr + "EncodingSavedBytes_" + get_run_identifier(loopName));
+
+        galois::runtime::reportStatCond_Tsum<MORE_DIST_STATS>(
+            GRNAME, statEncodingSavedBytes_str, (plain_size - messageSize));
+      }
+    }
   }
 
   /**
@@ -2408,6 +2673,18 @@ private:
       Tserialize.start();
       gSerialize(b, data_mode, bit_set_count, bit_set_comm, val_vec);
       Tserialize.stop();
+    } else if (data_mode == runLengthData) {
+      val_vec.resize(bit_set_count);
+      Tserialize.start();
+      gSerialize(b, data_mode, bit_set_count);
+      size_t runs_size =
+          galois::runtime::offsetRunsSize(offsets.data(), bit_set_count);
+      gSerialize(b, runs_size);
+      size_t runs_start = b.encomber(runs_size);
+      galois::runtime::encodeOffsetRuns(offsets.data(), bit_set_count,
+                                        b.getVec().data() + runs_start);
+      gSerialize(b, val_vec);
+      Tserialize.stop();
     } else { // onlyData
       Tserialize.start();
       gSerialize(b, data_mode, val_vec);
@@ -2567,7 +2844,7 @@ private:
       }
 
       reportRedundantSize<SyncFnTy>(loopName, syncTypeStr, num, bit_set_count,
-                                    bit_set_comm);
+                                    bit_set_comm, b.size());
     } else {
       b.resize(0);
       if (!async) {
@@ -2685,6 +2962,241 @@ private:
     // galois::runtime::reportStat_Single(GRNAME, metadata_str, 1);
   }
 
+  /**
+   * Returns the memoized sync state of a shared-node list, or nullptr if
+   * memoization is disabled or does not apply to this sync. Async sync does
+   * not exchange a message every round and the GPU batch functions choose
+   * their own data mode, so neither is memoized.
+   *
+   * @param loopName Name of the loop being synchronized
+   * @param indices Shared nodes (or the chunk of them) of the message
+   * @param sending true on the sending side of the list
+   */
+  template <typename SyncFnTy, bool async>
+  SyncMemo* get_sync_memo(const std::string& loopName,
+                          const std::vector<size_t>& indices, bool sending) {
+#if defined(__GALOIS_HET_CUDA__) || defined(__GALOIS_HET_OPENCL__)
+    return nullptr;
+#else
+    if (async || syncMemoRounds == 0 || indices.empty() ||
+        !galois::runtime::is_memory_copyable<
+            typename SyncFnTy::ValTy>::value) {
+      return nullptr;
+    }
+    return &syncMemos[std::make_tuple(loopName,
+                                      std::type_index(typeid(SyncFnTy)),
+                                      indices.data(), sending)];
+#endif
+  }
+
+  /**
+   * Returns true if the next message of a memoized list may be a raw value
+   * stream: a list whose last two messages were onlyData is expected to stay
+   * all-data for syncMemoRounds messages before its data mode is picked
+   * again. The sender still checks the expectation every message.
+   */
+  bool sync_memo_raw(const SyncMemo* memo) const {
+    return memo && memo->onlyDataStreak >= 2 &&
+           memo->rawRounds < syncMemoRounds;
+  }
+
+  /**
+   * Returns true if every node of a memoized list is dirty. The normal path
+   * then picks onlyData, as every other mode adds metadata to the same
+   * values, so a raw value stream carries what it would have sent. With a
+   * clean node runLengthData may be smaller, and pricing it needs the offsets
+   * the normal path builds anyway, so the list falls back to it.
+   *
+   * This saves building the comm bitset and offsets, not reading the compute
+   * bitset: a list of consecutive LIDs is tested a word at a time, any other
+   * list a node at a time, and all threads stop at the first clean node.
+   *
+   * @param memo memoized state of the list
+   * @param indices Shared nodes (or the chunk of them) of the message
+   */
+  template <typename SyncFnTy, typename BitsetFnTy>
+  bool sync_memo_valid(SyncMemo* memo, const std::vector<size_t>& indices) {
+    // without a bitset (or with onlyData enforced) every message is onlyData
+    if (!BitsetFnTy::is_valid() || enforce_data_mode == onlyData) {
+      return true;
+    }
+    if (memo->contiguous < 0) {
+      // shared nodes are unique, so a sorted list spanning its size has no
+      // gaps
+      memo->contiguous =
+          std::is_sorted(indices.begin(), indices.end()) &&
+          indices.back() - indices.front() + 1 == indices.size();
+    }
+    const galois::DynamicBitSet& bitset = BitsetFnTy::get();
+    std::atomic<bool> clean(false);
+
+    if (memo->contiguous) {
+      const auto& words = bitset.get_vec();
+      size_t first      = indices.front();
+      size_t last       = indices.back() + 1;
+      galois::on_each([&](unsigned tid, unsigned nthreads) {
+        auto range = galois::block_range(first / 64, (last + 63) / 64, tid,
+                                         nthreads);
+        for (size_t w = range.first; w < range.second; ++w) {
+          if (clean.load(std::memory_order_relaxed)) {
+            return;
+          }
+          size_t lo     = std::max(first, w * 64) - w * 64;
+          size_t hi     = std::min(last, w * 64 + 64) - w * 64;
+          uint64_t mask = (hi - lo == 64) ? ~uint64_t(0)
+                                          : ((uint64_t(1) << (hi - lo)) - 1)
+                                                << lo;
+          if ((words[w] & mask) != mask) {
+            clean = true;
+          }
+        }
+      });
+    } else {
+      galois::on_each([&](unsigned tid, unsigned nthreads) {
+        auto range = galois::block_range(size_t{0}, indices.size(), tid,
+                                         nthreads);
+        for (size_t n = range.first; n < range.second; ++n) {
+          if (clean.load(std::memory_order_relaxed)) {
+            return;
+          }
+          if (!bitset.test(indices[n])) {
+            clean = true;
+          }
+        }
+      });
+    }
+    return !clean;
+  }
+
+  //! Forgets the onlyData streak of a list whose memoized plan failed
+  void sync_memo_reset(SyncMemo* memo) {
+    memo->onlyDataStreak = 0;
+    memo->rawRounds      = 0;
+  }
+
+  //! Advances a memoized sync state past one message of the list
+  void sync_memo_advance(SyncMemo* memo, bool raw, DataCommMode data_mode) {
+    if (!memo) {
+      return;
+    }
+    if (raw) {
+      ++memo->rawRounds;
+    } else {
+      memo->onlyDataStreak =
+          (data_mode == onlyData) ? memo->onlyDataStreak + 1 : 0;
+      memo->rawRounds = 0;
+    }
+  }
+
+  /**
+   * Extracts the values of all nodes in indices as a raw value stream with
+   * no data mode, count, or offsets, behind a byte of 1. Only sent when the
+   * receiver's memoized state allows one (see sync_memo_raw).
+   *
+   * @param loopName loop name used for timers
+   * @param indices Shared nodes (or the chunk of them) to extract
+   * @param b OUTPUT: buffer that will be sent over the network
+   */
+  template <SyncType syncType, typename SyncFnTy>
+  void syncExtractMemo(std::string loopName, std::vector<size_t>& indices,
+                       galois::runtime::SendBuffer& b) {
+    using ValTy = typename SyncFnTy::ValTy;
+    std::string syncTypeStr = (syncType == syncReduce) ? "Reduce" : "Broadcast";
+    std::string extract_timer_str(syncTypeStr + "ExtractMemo_" +
+                                  get_run_identifier(loopName));
+    galois::CondStatTimer<MORE_COMM_STATS> Textract(extract_timer_str.c_str(),
+                                                    GRNAME);
+
+    Textract.start();
+    b.resize(0);
+    b.push(1);
+    galois::runtime::LazyRef<ValTy> lseq{
+        b.encomber(indices.size() * sizeof(ValTy))};
+    extract_subset<SyncFnTy, decltype(lseq), syncType, true, true>(
+        loopName, indices, indices.size(), syncOffsets, b, lseq);
+    Textract.stop();
+
+    galois::runtime::reportStatCond_Tsum<MORE_DIST_STATS>(
+        GRNAME, syncTypeStr + "MemoMessages_" + get_run_identifier(loopName),
+        1);
+  }
+
+  /**
+   * Block-compresses an extracted message in place if it is at least
+   * syncCompressMin bytes and compression makes it smaller. A compressed
+   * message is the compressedData mode, the raw size, and the compressed
+   * bytes.
+   *
+   * @param loopName Name of loop used to name statistics
+   * @param syncTypeStr String used to name statistics
+   * @param b Buffer holding the message to compress
+   */
+  void compressSendBuffer(std::string loopName, const std::string& syncTypeStr,
+                          galois::runtime::SendBuffer& b) {
+    if (syncCompressMin == 0 || b.size() < syncCompressMin) {
+      return;
+    }
+
+    std::string compress_timer_str(syncTypeStr + "Compress_" +
+                                   get_run_identifier(loopName));
+    galois::CondStatTimer<MORE_COMM_STATS> Tcompress(
+        compress_timer_str.c_str(), GRNAME);
+    Tcompress.start();
+
+    size_t rawSize = b.size();
+    galois::runtime::SendBuffer out;
+    gSerialize(out, compressedData, rawSize);
+    size_t header = out.size();
+
+    // only worth it if the compressed message is smaller than the raw one
+    if (rawSize > header + 1) {
+      size_t capacity = rawSize - header - 1;
+      out.encomber(capacity);
+      size_t compressedSize = galois::runtime::blockCompress(
+          b.linearData(), rawSize, out.getVec().data() + header, capacity);
+
+      if (compressedSize > 0) {
+        out.resize(header + compressedSize);
+        b.getVec().swap(out.getVec());
+
+        std::string statCompressSavedBytes_str(
+            syncTypeStr + "CompressSavedBytes_" + get_run_identifier(loopName));
+        galois::runtime::reportStatCond_Tsum<MORE_DIST_STATS>(
+            GRNAME, statCompressSavedBytes_str, rawSize - b.size());
+      }
+    }
+
+    Tcompress.stop();
+  }
+
+  /**
+   * Replaces a block-compressed message with its decompressed contents;
+   * other messages are left untouched.
+   *
+   * @param buf Buffer holding a received message
+   */
+  void decompressRecvBuffer(galois::runtime::RecvBuffer& buf) {
+    if (buf.r_size() < sizeof(DataCommMode)) {
+      return;
+    }
+
+    DataCommMode data_mode;
+    galois::runtime::gDeserializeRaw(buf.r_linearData(), data_mode);
+    if (data_mode != compressedData) {
+      return;
+    }
+
+    size_t rawSize;
+    galois::runtime::gDeserialize(buf, data_mode, rawSize);
+    galois::PODResizeableArray<uint8_t> raw;
+    raw.resize(rawSize);
+    if (!galois::runtime::blockDecompress(buf.r_linearData(), buf.r_size(),
+                                          raw.data(), rawSize)) {
+      GALOIS_DIE("Corrupt compressed sync message");
+    }
+    buf = galois::runtime::RecvBuffer(std::move(raw));
+  }
+
   /**
    * Get data that is going to be sent for synchronization and returns
    * it in a send buffer.
@@ -2704,14 +3216,62 @@ private:
                        galois::runtime::SendBuffer& b) {
     auto& sharedNodes = (syncType == syncReduce) ? mirrorNodes : masterNodes;
 
-    if (BitsetFnTy::is_valid()) {
-      syncExtract<syncType, SyncFnTy, BitsetFnTy, async>(loopName, x, sharedNodes[x],
-                                                  b);
+    get_send_buffer<syncType, SyncFnTy, BitsetFnTy, async>(loopName, x,
+                                                           sharedNodes[x], b);
+  }
+
+  /**
+   * Extracts the data of a subset of the nodes shared with a host into a
+   * buffer.
+   *
+   * @param loopName Name to give timer
+   * @param x Host to send to
+   * @param indices Shared nodes (or a chunk of them) to extract
+   * @param b OUTPUT: Buffer that will hold data to send
+   */
+  template <
+      SyncType syncType, typename SyncFnTy, typename BitsetFnTy, bool async,
+      typename std::enable_if<!BitsetFnTy::is_vector_bitset()>::type* = nullptr>
+  void get_send_buffer(std::string loopName, unsigned x,
+                       std::vector<size_t>& indices,
+                       galois::runtime::SendBuffer& b) {
+    std::string syncTypeStr = (syncType == syncReduce) ? "Reduce" : "Broadcast";
+    SyncMemo* memo = get_sync_memo<SyncFnTy, async>(loopName, indices, true);
+    bool memoized  = sync_memo_raw(memo);
+    bool raw =
+        memoized && sync_memo_valid<SyncFnTy, BitsetFnTy>(memo, indices);
+    DataCommMode data_mode = onlyData;
+
+    if (raw) {
+      // raw value streams are never compressed so that the receiver does
+      // not mistake their first bytes for a data mode
+      syncExtractMemo<syncType, SyncFnTy>(loopName, indices, b);
     } else {
-      syncExtract<syncType, SyncFnTy, async>(loopName, x, sharedNodes[x], b);
+      if (memoized) {
+        // the dirty set changed: both sides drop the plan, and a byte of 0
+        // in front of the normal message tells the receiver so
+        sync_memo_reset(memo);
+      }
+      if (BitsetFnTy::is_valid()) {
+        syncExtract<syncType, SyncFnTy, BitsetFnTy, async>(loopName, x,
+                                                           indices, b);
+      } else {
+        syncExtract<syncType, SyncFnTy, async>(loopName, x, indices, b);
+      }
+      if (memo) {
+        galois::runtime::gDeserializeRaw(b.linearData(), data_mode);
+      }
+      compressSendBuffer(loopName, syncTypeStr, b);
+      if (memoized) {
+        galois::runtime::SendBuffer out;
+        out.reserve(1 + b.size());
+        out.push(0);
+        out.insert(b.linearData(), b.size());
+        b.getVec().swap(out.getVec());
+      }
     }
+    sync_memo_advance(memo, raw, data_mode);
 
-    std::string syncTypeStr = (syncType == syncReduce) ? "Reduce" : "Broadcast";
     std::string statSendBytes_str(syncTypeStr + "SendBytes_" +
                                   get_run_identifier(loopName));
 
@@ -2729,6 +3289,7 @@ private:
     syncExtract<syncType, SyncFnTy, BitsetFnTy, async>(loopName, x, sharedNodes[x], b);
 
     std::string syncTypeStr = (syncType == syncReduce) ? "Reduce" : "Broadcast";
+    compressSendBuffer(loopName, syncTypeStr, b);
     std::string statSendBytes_str(syncTypeStr + "SendBytesVector_" +
                                   get_run_identifier(loopName));
 
@@ -2944,6 +3505,16 @@ private:
       } else if (data_mode == bitsetData) {
         bit_set_comm.resize(num);
         galois::runtime::gDeserialize(buf, bit_set_comm);
+      } else if (data_mode == runLengthData) {
+        size_t runs_size;
+        galois::runtime::gDeserialize(buf, runs_size);
+        offsets.resize(bit_set_count);
+        if (!galois::runtime::decodeOffsetRuns(buf.r_linearData(), runs_size,
+                                               offsets.data(),
+                                               bit_set_count)) {
+          GALOIS_DIE("Corrupt run-length offsets in sync message");
+        }
+        buf.setOffset(buf.getOffset() + runs_size);
       } else if (data_mode == dataSplit) {
         galois::runtime::gDeserialize(buf, buf_start);
       } else if (data_mode == dataSplitFirst) {
@@ -2974,9 +3545,31 @@ private:
    */
   template <
       SyncType syncType, typename SyncFnTy, typename BitsetFnTy,
+      bool async = false,
       typename std::enable_if<!BitsetFnTy::is_vector_bitset()>::type* = nullptr>
   size_t syncRecvApply(uint32_t from_id, galois::runtime::RecvBuffer& buf,
                        std::string loopName) {
+    auto& sharedNodes = (syncType == syncReduce) ? masterNodes : mirrorNodes;
+    return syncRecvApply<syncType, SyncFnTy, BitsetFnTy, async>(
+        from_id, sharedNodes[from_id], buf, loopName);
+  }
+
+  /**
+   * Applies a message that covers a subset of the nodes shared with a host.
+   *
+   * @param from_id ID of host which the message we are processing was received
+   * from
+   * @param indices Shared nodes (or the chunk of them) the message covers
+   * @param buf Buffer that contains received message from other host
+   * @param loopName used to name timers for statistics
+   */
+  template <
+      SyncType syncType, typename SyncFnTy, typename BitsetFnTy,
+      bool async = false,
+      typename std::enable_if<!BitsetFnTy::is_vector_bitset()>::type* = nullptr>
+  size_t syncRecvApply(uint32_t from_id, std::vector<size_t>& indices,
+                       galois::runtime::RecvBuffer& buf,
+                       std::string loopName) {
     std::string syncTypeStr = (syncType == syncReduce) ? "Reduce" : "Broadcast";
     std::string set_timer_str(syncTypeStr + "Set_" +
                               get_run_identifier(loopName));
@@ -2990,16 +3583,46 @@ private:
     static galois::PODResizeableArray<typename SyncFnTy::ValTy> val_vec;
     galois::PODResizeableArray<unsigned int>& offsets = syncOffsets;
 
-    auto& sharedNodes = (syncType == syncReduce) ? masterNodes : mirrorNodes;
-    uint32_t num      = sharedNodes[from_id].size();
-    size_t retval     = 0;
+    uint32_t num  = indices.size();
+    size_t retval = 0;
+    SyncMemo* memo = get_sync_memo<SyncFnTy, async>(loopName, indices, false);
 
     Tset.start();
 
-    if (num > 0) { // only enter if we expect message from that host
+    // a list expecting a raw value stream gets a byte saying whether the
+    // sender kept to the plan
+    bool raw = false;
+    if (sync_memo_raw(memo)) {
+      if (buf.r_size() == 0) {
+        GALOIS_DIE("Memoized sync message is empty");
+      }
+      raw = buf.pop();
+      if (!raw) {
+        sync_memo_reset(memo);
+      }
+    }
+
+    if (raw) {
+      // raw value stream: the shared nodes are the scatter plan
+      size_t bytes = num * sizeof(typename SyncFnTy::ValTy);
+      if (buf.r_size() != bytes) {
+        GALOIS_DIE("Memoized sync message has unexpected size ", buf.r_size(),
+                   " (expected ", bytes, ")");
+      }
+      val_vec.reserve(maxSharedSize);
+      val_vec.resize(num);
+      buf.extract((uint8_t*)val_vec.data(), bytes);
+
+      set_subset<decltype(indices), SyncFnTy, syncType, true, true>(
+          loopName, indices, num, offsets, val_vec, BitsetFnTy::get());
+      sync_memo_advance(memo, true, onlyData);
+    } else if (num > 0) { // only enter if we expect message from that host
+      decompressRecvBuffer(buf);
+
       DataCommMode data_mode;
       // 1st deserialize gets data mode
       galois::runtime::gDeserialize(buf, data_mode);
+      sync_memo_advance(memo, false, data_mode);
 
       if (data_mode != noData) {
         // GPU update call
@@ -3033,20 +3656,20 @@ private:
           }
 
           if (data_mode == onlyData) {
-            set_subset<decltype(sharedNodes[from_id]), SyncFnTy, syncType, true,
-                       true>(loopName, sharedNodes[from_id], bit_set_count,
+            set_subset<decltype(indices), SyncFnTy, syncType, true,
+                       true>(loopName, indices, bit_set_count,
                              offsets, val_vec, bit_set_compute);
           } else if (data_mode == dataSplit || data_mode == dataSplitFirst) {
-            set_subset<decltype(sharedNodes[from_id]), SyncFnTy, syncType, true,
-                       true>(loopName, sharedNodes[from_id], bit_set_count,
+            set_subset<decltype(indices), SyncFnTy, syncType, true,
+                       true>(loopName, indices, bit_set_count,
                              offsets, val_vec, bit_set_compute, buf_start);
           } else if (data_mode == gidsData) {
             set_subset<decltype(offsets), SyncFnTy, syncType, true, true>(
                 loopName, offsets, bit_set_count, offsets, val_vec,
                 bit_set_compute);
-          } else { // bitsetData or offsetsData
-            set_subset<decltype(sharedNodes[from_id]), SyncFnTy, syncType,
-                       false, true>(loopName, sharedNodes[from_id],
+          } else { // bitsetData, offsetsData, or runLengthData
+            set_subset<decltype(indices), SyncFnTy, syncType,
+                       false, true>(loopName, indices,
                                     bit_set_count, offsets, val_vec,
                                     bit_set_compute);
           }
@@ -3083,6 +3706,7 @@ private:
    */
   template <
       SyncType syncType, typename SyncFnTy, typename BitsetFnTy,
+      bool async = false,
       typename std::enable_if<BitsetFnTy::is_vector_bitset()>::type* = nullptr>
   size_t syncRecvApply(uint32_t from_id, galois::runtime::RecvBuffer& buf,
                        std::string loopName) {
@@ -3102,6 +3726,8 @@ private:
     Tset.start();
 
     if (num > 0) { // only enter if we expect message from that host
+      decompressRecvBuffer(buf);
+
       for (unsigned i = 0; i < BitsetFnTy::numBitsets(); i++) {
         DataCommMode data_mode;
         // 1st deserialize gets data mode
@@ -3143,7 +3769,7 @@ private:
             set_subset<decltype(offsets), SyncFnTy, syncType, true, true, true>(
                 loopName, offsets, bit_set_count, offsets, val_vec,
                 bit_set_compute, i);
-          } else { // bitsetData or offsetsData
+          } else { // bitsetData, offsetsData, or runLengthData
             set_subset<decltype(sharedNodes[from_id]), SyncFnTy, syncType,
                        false, true, true>(loopName, sharedNodes[from_id],
                                           bit_set_count, offsets, val_vec,
@@ -3258,8 +3884,8 @@ private:
         p = net.recieveTagged(galois::runtime::evilPhase + syncTypePhase, nullptr);
 
         if (p) {
-          syncRecvApply<syncType, SyncFnTy, BitsetFnTy>(p->first, p->second,
-                                                        loopName);
+          syncRecvApply<syncType, SyncFnTy, BitsetFnTy, async>(
+              p->first, p->second, loopName);
         }
       } while (p);
     } else {
@@ -3276,8 +3902,8 @@ private:
         } while (!p);
         Twait.stop();
 
-        syncRecvApply<syncType, SyncFnTy, BitsetFnTy>(p->first, p->second,
-                                                      loopName);
+        syncRecvApply<syncType, SyncFnTy, BitsetFnTy, async>(
+            p->first, p->second, loopName);
       }
       increment_evilPhase();
     }
@@ -3308,6 +3934,214 @@ private:
     TRecvTime.stop();
   }
 
+  /**
+   * Splits the shared node lists into chunks of syncPipelineChunk nodes for
+   * pipelined sync. Lists that fit in one chunk are not copied.
+   */
+  void init_pipeline_chunks() {
+    if (pipelineChunkSize == syncPipelineChunk)
+      return;
+    pipelineChunkSize = syncPipelineChunk;
+
+    auto split = [&](std::vector<std::vector<size_t>>& lists,
+                     std::vector<std::vector<std::vector<size_t>>>& chunks) {
+      chunks.clear();
+      chunks.resize(numHosts);
+      for (unsigned x = 0; x < numHosts; ++x) {
+        auto& list = lists[x];
+        if (list.size() <= pipelineChunkSize)
+          continue;
+        for (size_t begin = 0; begin < list.size();
+             begin += pipelineChunkSize) {
+          size_t end = std::min(begin + pipelineChunkSize, list.size());
+          chunks[x].emplace_back(list.begin() + begin, list.begin() + end);
+        }
+      }
+    };
+    split(mirrorNodes, mirrorChunks);
+    split(masterNodes, masterChunks);
+  }
+
+  //! @returns number of chunks a pipelined sync splits a shared node list into
+  size_t num_pipeline_chunks(const std::vector<size_t>& list) const {
+    if (list.size() <= pipelineChunkSize)
+      return 1;
+    return (list.size() + pipelineChunkSize - 1) / pipelineChunkSize;
+  }
+
+  /**
+   * Returns one chunk of the nodes shared with a host.
+   *
+   * @param lists mirrorNodes or masterNodes
+   * @param chunks mirrorChunks or masterChunks (must match lists)
+   * @param x host the nodes are shared with
+   * @param c chunk number
+   */
+  std::vector<size_t>&
+  get_pipeline_chunk(std::vector<std::vector<size_t>>& lists,
+                     std::vector<std::vector<std::vector<size_t>>>& chunks,
+                     unsigned x, uint32_t c) {
+    if (chunks[x].empty()) {
+      assert(c == 0);
+      return lists[x];
+    }
+    assert(c < chunks[x].size());
+    return chunks[x][c];
+  }
+
+  /**
+   * Pipelined variant of sync_send + sync_recv. The shared nodes of each host
+   * are split into chunks, and every chunk is extracted and sent as its own
+   * message (tagged with its chunk number at the end) as soon as it is ready.
+   * Between chunks, messages that have already arrived are applied, so the
+   * network is busy while this host extracts and the cores apply while other
+   * hosts are still sending.
+   *
+   * Extraction reads only the nodes this sync sends (mirrors for reduce,
+   * masters for broadcast) and applying writes only the other set, so the
+   * two can be interleaved.
+   *
+   * @tparam SendBitsetFnTy bitset used to extract the data to send
+   * @tparam RecvBitsetFnTy bitset updated when applying received data
+   *
+   * @param loopName used to name timers for statistics
+   */
+  template <WriteLocation writeLocation, ReadLocation readLocation,
+            SyncType syncType, typename SyncFnTy, typename SendBitsetFnTy,
+            typename RecvBitsetFnTy>
+  void sync_net_pipelined(std::string loopName) {
+    auto& net = galois::runtime::getSystemNetworkInterface();
+    std::string syncTypeStr = (syncType == syncReduce) ? "Reduce" : "Broadcast";
+    galois::CondStatTimer<MORE_COMM_STATS> TPipeline(
+        (syncTypeStr + "Pipeline_" + get_run_identifier(loopName)).c_str(),
+        GRNAME);
+    galois::CondStatTimer<MORE_COMM_STATS> Twait(
+        ("Wait_" + get_run_identifier(loopName)).c_str(), GRNAME);
+
+    TPipeline.start();
+    init_pipeline_chunks();
+
+    auto& sendLists  = (syncType == syncReduce) ? mirrorNodes : masterNodes;
+    auto& sendChunks = (syncType == syncReduce) ? mirrorChunks : masterChunks;
+    auto& recvLists  = (syncType == syncReduce) ? masterNodes : mirrorNodes;
+    auto& recvChunks = (syncType == syncReduce) ? masterChunks : mirrorChunks;
+
+    size_t expected = 0;
+    for (unsigned x = 0; x < numHosts; ++x) {
+      if (x == id || nothingToRecv(x, syncType, writeLocation, readLocation))
+        continue;
+      expected += num_pipeline_chunks(recvLists[x]);
+    }
+
+    size_t received = 0;
+    auto apply      = [&](uint32_t from,
+                     galois::runtime::RecvBuffer& buf) {
+      uint32_t c;
+      galois::runtime::gDeserializeRaw(
+          buf.r_linearData() + buf.r_size() - sizeof(uint32_t), c);
+      buf.pop_back(sizeof(uint32_t));
+      syncRecvApply<syncType, SyncFnTy, RecvBitsetFnTy>(
+          from, get_pipeline_chunk(recvLists, recvChunks, from, c), buf,
+          loopName);
+      ++received;
+    };
+
+    galois::runtime::SendBuffer b;
+    size_t numMessages = 0;
+    for (unsigned h = 1; h < numHosts; ++h) {
+      unsigned x = (id + h) % numHosts;
+
+      if (nothingToSend(x, syncType, writeLocation, readLocation))
+        continue;
+
+      uint32_t numChunks = num_pipeline_chunks(sendLists[x]);
+      for (uint32_t c = 0; c < numChunks; ++c) {
+        get_send_buffer<syncType, SyncFnTy, SendBitsetFnTy, false>(
+            loopName, x, get_pipeline_chunk(sendLists, sendChunks, x, c), b);
+        galois::runtime::gSerialize(b, c);
+        net.sendTagged(x, galois::runtime::evilPhase, b);
+        // do not let the chunk wait for the aggregation timeout
+        net.flush();
+        ++numMessages;
+
+        // apply whatever has arrived in the meantime
+        while (received < expected) {
+          auto p = net.recieveTagged(galois::runtime::evilPhase, nullptr);
+          if (!p)
+            break;
+          apply(p->first, p->second);
+        }
+      }
+    }
+
+    if (SendBitsetFnTy::is_valid()) {
+      reset_bitset(syncType, &SendBitsetFnTy::reset_range);
+    }
+
+    while (received < expected) {
+      Twait.start();
+      decltype(net.recieveTagged(galois::runtime::evilPhase, nullptr)) p;
+      do {
+        p = net.recieveTagged(galois::runtime::evilPhase, nullptr);
+      } while (!p);
+      Twait.stop();
+
+      apply(p->first, p->second);
+    }
+    increment_evilPhase();
+
+    TPipeline.stop();
+
+    galois::runtime::reportStat_Tsum(
+        GRNAME, syncTypeStr + "NumMessages_" + get_run_identifier(loopName),
+        numMessages);
+  }
+
+  /**
+   * Sends data to and receives data from all other hosts, pipelining the
+   * two if requested with syncPipelineChunk.
+   *
+   * Pipelining needs per-chunk extraction, which the GPU batch functions
+   * and vector bitsets do not support, and does not apply to async sync.
+   *
+   * @tparam SendBitsetFnTy bitset used to extract the data to send
+   * @tparam RecvBitsetFnTy bitset updated when applying received data
+   *
+   * @param loopName used to name timers for statistics
+   */
+  template <WriteLocation writeLocation, ReadLocation readLocation,
+            SyncType syncType, typename SyncFnTy, typename SendBitsetFnTy,
+            typename RecvBitsetFnTy, bool async,
+            typename std::enable_if<
+                async || SendBitsetFnTy::is_vector_bitset() ||
+                RecvBitsetFnTy::is_vector_bitset()>::type* = nullptr>
+  void sync_net(std::string loopName) {
+    sync_send<writeLocation, readLocation, syncType, SyncFnTy, SendBitsetFnTy,
+              async>(loopName);
+    sync_recv<writeLocation, readLocation, syncType, SyncFnTy, RecvBitsetFnTy,
+              async>(loopName);
+  }
+
+  template <WriteLocation writeLocation, ReadLocation readLocation,
+            SyncType syncType, typename SyncFnTy, typename SendBitsetFnTy,
+            typename RecvBitsetFnTy, bool async,
+            typename std::enable_if<
+                !async && !SendBitsetFnTy::is_vector_bitset() &&
+                !RecvBitsetFnTy::is_vector_bitset()>::type* = nullptr>
+  void sync_net(std::string loopName) {
+#if !defined(__GALOIS_HET_CUDA__) && !defined(__GALOIS_HET_OPENCL__)
+    if (syncPipelineChunk > 0) {
+      sync_net_pipelined<writeLocation, readLocation, syncType, SyncFnTy,
+                         SendBitsetFnTy, RecvBitsetFnTy>(loopName);
+      return;
+    }
+#endif
+    sync_send<writeLocation, readLocation, syncType, SyncFnTy, SendBitsetFnTy,
+              async>(loopName);
+    sync_recv<writeLocation, readLocation, syncType, SyncFnTy, RecvBitsetFnTy,
+              async>(loopName);
+  }
+
 #ifdef __GALOIS_BARE_MPI_COMMUNICATION__
   /**
    * Nonblocking MPI sync
@@ -3480,10 +4314,8 @@ private:
     switch (bare_mpi) {
     case noBareMPI:
 #endif
-      sync_send<writeLocation, readLocation, syncReduce, ReduceFnTy,
-                BitsetFnTy, async>(loopName);
-      sync_recv<writeLocation, readLocation, syncReduce, ReduceFnTy,
-                BitsetFnTy, async>(loopName);
+      sync_net<writeLocation, readLocation, syncReduce, ReduceFnTy, BitsetFnTy,
+               BitsetFnTy, async>(loopName);
 #ifdef __GALOIS_BARE_MPI_COMMUNICATION__
       break;
     case nonBlockingBareMPI:
@@ -3499,6 +4331,7 @@ private:
     }
 #endif
 
+    report_apply_bytes(loopName, "Reduce");
     TsyncReduce.stop();
   }
 
@@ -3549,14 +4382,12 @@ private:
     case noBareMPI:
 #endif
       if (use_bitset) {
-        sync_send<writeLocation, readLocation, syncBroadcast, BroadcastFnTy,
-                  BitsetFnTy, async>(loopName);
+        sync_net<writeLocation, readLocation, syncBroadcast, BroadcastFnTy,
+                 BitsetFnTy, BitsetFnTy, async>(loopName);
       } else {
-        sync_send<writeLocation, readLocation, syncBroadcast, BroadcastFnTy,
-                  galois::InvalidBitsetFnTy, async>(loopName);
+        sync_net<writeLocation, readLocation, syncBroadcast, BroadcastFnTy,
+                 galois::InvalidBitsetFnTy, BitsetFnTy, async>(loopName);
       }
-      sync_recv<writeLocation, readLocation, syncBroadcast, BroadcastFnTy,
-                BitsetFnTy, async>(loopName);
 #ifdef __GALOIS_BARE_MPI_COMMUNICATION__
       break;
     case nonBlockingBareMPI:
@@ -3572,6 +4403,7 @@ private:
     }
 #endif
 
+    report_apply_bytes(loopName, "Broadcast");
     TsyncBroadcast.stop();
   }
 
@@ -4379,27 +5211,7 @@ public:
 
     // graph topology
     ar << graph;
-    ar << numGlobalNodes;
-    ar << numGlobalEdges;
-
-    // bool
-    ar << transposed;
-
-    // Proxy information
-    // TODO: Find better way to serialize vector of vectors in boost
-    // serialization
-    for (uint32_t i = 0; i < numHosts; ++i) {
-      ar << masterNodes[i];
-      ar << mirrorNodes[i];
-    }
-
-    ar << numOwned;
-    ar << beginMaster;
-    ar << numNodesWithEdges;
-    ar << gid2host;
-
-    // Serialize partitioning scheme specific data structures.
-    boostSerializeLocalGraph(ar);
+    boostSerializeDistInfo(ar);
 
     outputStream.close();
     dGraphTimerSaveLocalGraph.stop();
@@ -4430,6 +5242,219 @@ public:
 
     // Graph topology
     ar >> graph;
+    boostDeSerializeDistInfo(ar);
+
+    allNodesRanges.clear();
+    masterRanges.clear();
+    withEdgeRanges.clear();
+    specificRanges.clear();
+
+    // find ranges again
+    determineThreadRanges();
+    determineThreadRangesMaster();
+    determineThreadRangesWithEdges();
+    initializeSpecificRanges();
+
+    // Exchange information among hosts
+    // send_info_to_host();
+
+    inputStream.close();
+    dGraphTimerReadLocalGraph.stop();
+  }
+
+  /**
+   * Write this host's partition to the partition cache. Does nothing if the
+   * cache is disabled or the graph was loaded from it. Call it right after
+   * construction, before the topology is modified.
+   */
+  void save_partition_cache() {
+    if (partitionCacheFile.empty()) {
+      return;
+    }
+    galois::StatTimer Tsave("TimerSavePartitionCache", GRNAME);
+    Tsave.start();
+
+    std::ostringstream metaStream;
+    {
+      boost::archive::binary_oarchive ar(metaStream,
+                                         boost::archive::no_header);
+      boostSerializeDistInfo(ar);
+    }
+    const std::string meta = metaStream.str();
+
+    PartitionCacheHeader header;
+    memset(&header, 0, sizeof(header));
+    header.key      = partitionCacheKey;
+    header.numNodes = graph.size();
+    header.numEdges = graph.sizeEdges();
+    strncpy(header.policy, partitionCachePolicy.c_str(),
+            sizeof(header.policy) - 1);
+
+    PartitionCacheWriter writer(partitionCacheFile);
+    header.edgeIndOffset = writer.append(graph.getEdgePrefixSum().data(),
+                                         header.numNodes * sizeof(uint64_t));
+    header.edgeDstOffset = writer.append(graph.getEdgeDestinations().data(),
+                                         header.numEdges * sizeof(uint32_t));
+    header.edgeDataOffset =
+        writer.append(graph.getEdgeDataArray().data(),
+                      header.numEdges * partitionCacheKey.edgeDataSize);
+    header.metaOffset = writer.append(meta.data(), meta.size());
+    header.metaSize   = meta.size();
+    writer.finish(header);
+
+    galois::gPrint("[", id, "] Saved partition cache ", partitionCacheFile,
+                   "\n");
+    partitionCacheFile.clear();
+    Tsave.stop();
+  }
+
+protected:
+  /**
+   * Load this host's partition from the partition cache if the cache is
+   * enabled and every host has a valid cache file for this input, policy,
+   * and host count. The CSR arrays are used in place from a private mapping
+   * of the file. On a miss, remembers the key so that save_partition_cache
+   * can write the file once the graph is partitioned.
+   *
+   * Partitioning is collective, so all hosts must call this together.
+   *
+   * @param filename input graph file
+   * @param policy policy string from partitionPolicyString; the master
+   * distribution options are appended to it
+   * @returns true if the partition was loaded; the caller must then skip
+   * partitioning and communication setup
+   */
+  bool read_partition_cache(const std::string& filename,
+                            const std::string& policy) {
+    if (partitionCacheDir.empty()) {
+      return false;
+    }
+    galois::StatTimer Tread("TimerReadPartitionCache", GRNAME);
+    Tread.start();
+
+    // options read by computeMasters and the thread ranges change the
+    // partition for every partitioner
+    partitionCachePolicy = partitionPolicyString(
+        policy, static_cast<int>(masters_distribution),
+        static_cast<uint32_t>(nodeWeightOfMaster),
+        static_cast<uint32_t>(edgeWeightOfMaster),
+        static_cast<uint32_t>(nodeAlphaRanges));
+    partitionCacheKey = makePartitionCacheKey(
+        filename, partitionCachePolicy, id, numHosts,
+        internal::EdgeDataBytes<EdgeTy>::value);
+    partitionCacheFile = partitionCachePath(partitionCacheDir,
+                                            partitionCacheKey);
+
+    // fast path: only headers are checked before every host agrees
+    bool valid = validatePartitionCache(partitionCacheFile, partitionCacheKey);
+    auto& net  = galois::runtime::getSystemNetworkInterface();
+    for (unsigned x = 0; x < numHosts; ++x) {
+      if (x == id)
+        continue;
+
+      galois::runtime::SendBuffer b;
+      gSerialize(b, valid);
+      net.sendTagged(x, galois::runtime::evilPhase, b);
+    }
+    bool allValid = valid;
+    for (unsigned x = 0; x < numHosts; ++x) {
+      if (x == id)
+        continue;
+
+      decltype(net.recieveTagged(galois::runtime::evilPhase, nullptr)) p;
+      do {
+        p = net.recieveTagged(galois::runtime::evilPhase, nullptr);
+      } while (!p);
+
+      bool otherValid;
+      galois::runtime::gDeserialize(p->second, otherValid);
+      allValid = allValid && otherValid;
+    }
+    increment_evilPhase();
+
+    if (!allValid) {
+      galois::gPrint("[", id, "] Partition cache miss; partitioning\n");
+      Tread.stop();
+      return false;
+    }
+
+    partitionCacheMapping.map(partitionCacheFile);
+    const PartitionCacheHeader& header = partitionCacheMapping.header();
+    graph.wrapTopology(header.numNodes, header.numEdges,
+                       partitionCacheMapping.section(header.edgeIndOffset),
+                       partitionCacheMapping.section(header.edgeDstOffset),
+                       partitionCacheMapping.section(header.edgeDataOffset));
+
+    {
+      std::istringstream metaStream(
+          std::string(partitionCacheMapping.section(header.metaOffset),
+                      header.metaSize));
+      boost::archive::binary_iarchive ar(metaStream,
+                                         boost::archive::no_header);
+      boostDeSerializeDistInfo(ar);
+    }
+
+    determineThreadRanges();
+    determineThreadRangesMaster();
+    determineThreadRangesWithEdges();
+    initializeSpecificRanges();
+    constructIncomingEdges();
+
+    maxSharedSize = 0;
+    for (unsigned x = 0; x < numHosts; ++x) {
+      if (x == id)
+        continue;
+      maxSharedSize = std::max(maxSharedSize, masterNodes[x].size());
+      maxSharedSize = std::max(maxSharedSize, mirrorNodes[x].size());
+    }
+
+    galois::gPrint("[", id, "] Loaded partition cache ", partitionCacheFile,
+                   "\n");
+    partitionCacheFile.clear();
+    Tread.stop();
+
+    send_info_to_host();
+    return true;
+  }
+
+private:
+  /**
+   * Serialize everything about the local partition besides the topology:
+   * global sizes, proxy lists, ownership ranges, and the state of the
+   * partitioning scheme (including its global to local id map).
+   *
+   * @param ar archive to serialize to
+   */
+  void boostSerializeDistInfo(boost::archive::binary_oarchive& ar) const {
+    ar << numGlobalNodes;
+    ar << numGlobalEdges;
+
+    // bool
+    ar << transposed;
+
+    // Proxy information
+    // TODO: Find better way to serialize vector of vectors in boost
+    // serialization
+    for (uint32_t i = 0; i < numHosts; ++i) {
+      ar << masterNodes[i];
+      ar << mirrorNodes[i];
+    }
+
+    ar << numOwned;
+    ar << beginMaster;
+    ar << numNodesWithEdges;
+    ar << gid2host;
+
+    // Serialize partitioning scheme specific data structures.
+    boostSerializeLocalGraph(ar);
+  }
+
+  /**
+   * Deserialize what boostSerializeDistInfo wrote.
+   *
+   * @param ar archive to deserialize from
+   */
+  void boostDeSerializeDistInfo(boost::archive::binary_iarchive& ar) {
     ar >> numGlobalNodes;
     ar >> numGlobalEdges;
 
@@ -4451,25 +5476,9 @@ public:
 
     // Serialize partitioning scheme specific data structures.
     boostDeSerializeLocalGraph(ar);
-
-    allNodesRanges.clear();
-    masterRanges.clear();
-    withEdgeRanges.clear();
-    specificRanges.clear();
-
-    // find ranges again
-    determineThreadRanges();
-    determineThreadRangesMaster();
-    determineThreadRangesWithEdges();
-    initializeSpecificRanges();
-
-    // Exchange information among hosts
-    // send_info_to_host();
-
-    inputStream.close();
-    dGraphTimerReadLocalGraph.stop();
   }
 
+public:
   /**
    * Given a sync structure, reset the field specified by the structure
    * to the 0 of the reduction on mirrors.
@@ -371,6 +371,14 @@ public:
       Tgraph_construct.stop();
       return;
     }
+    // reuse this host's partition if every host has it cached
+    if (base_DistGraph::read_partition_cache(
+            filename, partitionPolicyString(GRNAME, columnBlocked,
+                                            moreColumnHosts, DecomposeFactor,
+                                            scalefactor, transpose))) {
+      Tgraph_construct.stop();
+      return;
+    }
 
     // only used to determine node splits among hosts; abandonded later
     // for the BufferedGraph
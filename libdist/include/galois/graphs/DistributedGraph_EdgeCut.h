@@ -170,6 +170,12 @@ public:
       Tgraph_construct.stop();
       return;
     }
+    // reuse this host's partition if every host has it cached
+    if (base_DistGraph::read_partition_cache(
+            filename, partitionPolicyString(GRNAME, isBipartite, scalefactor, transpose))) {
+      Tgraph_construct.stop();
+      return;
+    }
     uint32_t _numNodes;
     uint64_t _numEdges;
 
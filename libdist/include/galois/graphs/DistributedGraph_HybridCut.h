@@ -143,6 +143,13 @@ public:
       Tgraph_construct.stop();
       return;
     }
+    // reuse this host's partition if every host has it cached
+    if (base_DistGraph::read_partition_cache(
+            filename, partitionPolicyString(GRNAME, VCutThreshold, bipartite,
+                                            transpose))) {
+      Tgraph_construct.stop();
+      return;
+    }
 
     galois::graphs::OfflineGraph g(filename);
     isBipartite = bipartite;
@@ -28,6 +28,11 @@
 
 #include "galois/graphs/DistributedGraph.h"
 #include <sstream>
+#include <cstring>
+#include <typeinfo>
+#include <chrono>
+#include <fcntl.h>
+#include <unistd.h>
 
 namespace galois {
 namespace graphs {
@@ -53,8 +58,13 @@ class DistGraphGeneric : public DistGraph<NodeTy, EdgeTy> {
 
   //! GID = localToGlobalVector[LID]
   std::vector<uint64_t> localToGlobalVector;
-  //! LID = globalToLocalMap[GID]
+  //! LID = globalToLocalMap[GID]; emptied after construction unless the
+  //! hash map is the chosen G2L structure
   std::unordered_map<uint64_t, uint32_t> globalToLocalMap;
+  //! G2L structure chosen at construction time
+  G2LMapKind g2lKind;
+  //! LID = compactG2L.find(GID) if g2lKind is not hashG2L
+  CompactG2LMap compactG2L;
 
   uint32_t numNodes;
   uint64_t numEdges;
@@ -81,11 +91,17 @@ class DistGraphGeneric : public DistGraph<NodeTy, EdgeTy> {
 
   virtual bool isLocal(uint64_t gid) const {
     assert(gid < base_DistGraph::numGlobalNodes);
+    if (g2lKind != hashG2L) {
+      return compactG2L.find(gid) != CompactG2LMap::npos;
+    }
     return (globalToLocalMap.find(gid) != globalToLocalMap.end());
   }
 
   virtual uint32_t G2L(uint64_t gid) const {
     assert(isLocal(gid));
+    if (g2lKind != hashG2L) {
+      return compactG2L.find(gid);
+    }
     return globalToLocalMap.at(gid);
   }
 
@@ -95,7 +111,7 @@ class DistGraphGeneric : public DistGraph<NodeTy, EdgeTy> {
     if (gid >= globalOffset && gid < globalOffset + base_DistGraph::numOwned)
       return gid - globalOffset;
 
-    return globalToLocalMap.at(gid);
+    return G2L(gid);
   }
 
 
@@ -164,7 +180,7 @@ class DistGraphGeneric : public DistGraph<NodeTy, EdgeTy> {
                    unsigned _numHosts, bool transpose = false,
                    bool readFromFile = false,
                    std::string localGraphFileName = "local_graph")
-      : base_DistGraph(host, _numHosts) {
+      : base_DistGraph(host, _numHosts), g2lKind(g2lMap) {
     galois::runtime::reportParam("dGraph", "GenericPartitioner", "0");
     galois::CondStatTimer<MORE_DIST_STATS> Tgraph_construct(
         "GraphPartitioningTime", GRNAME);
@@ -178,6 +194,14 @@ class DistGraphGeneric : public DistGraph<NodeTy, EdgeTy> {
       Tgraph_construct.stop();
       return;
     }
+    // reuse this host's partition if every host has it cached
+    if (base_DistGraph::read_partition_cache(
+            filename, partitionPolicyString(GRNAME,
+                                            typeid(Partitioner).name(),
+                                            transpose))) {
+      Tgraph_construct.stop();
+      return;
+    }
 
     galois::graphs::OfflineGraph g(filename);
     base_DistGraph::numGlobalNodes = g.size();
@@ -190,6 +214,67 @@ class DistGraphGeneric : public DistGraph<NodeTy, EdgeTy> {
     // TODO abstract this away somehow
     graphPartitioner->saveGIDToHost(base_DistGraph::gid2host);
 
+    if (streamPartition) {
+      streamingPartition(filename);
+    } else {
+      multiPassPartition(g, filename);
+    }
+
+    // Finalization
+
+    // TODO this is a hack; fix it somehow
+    if (graphPartitioner->isVertexCut() && !graphPartitioner->isCartCut()) {
+      base_DistGraph::numNodesWithEdges = numNodes;
+    }
+
+    if (transpose && (numNodes > 0)) {
+      // consider all nodes to have outgoing edges (TODO better way to do this?)
+      // for now it's fine I guess
+      base_DistGraph::numNodesWithEdges = numNodes;
+      base_DistGraph::graph.transpose(GRNAME);
+      base_DistGraph::transposed = true;
+    }
+
+    galois::CondStatTimer<MORE_DIST_STATS> Tthread_ranges("ThreadRangesTime",
+                                                          GRNAME);
+
+    Tthread_ranges.start();
+    base_DistGraph::determineThreadRanges();
+    Tthread_ranges.stop();
+
+    base_DistGraph::determineThreadRangesMaster();
+    base_DistGraph::determineThreadRangesWithEdges();
+    base_DistGraph::initializeSpecificRanges();
+
+    Tgraph_construct.stop();
+    galois::gPrint("[", base_DistGraph::id, "] Graph construction complete.\n");
+
+    galois::CondStatTimer<MORE_DIST_STATS> Tgraph_construct_comm(
+        "GraphCommSetupTime", GRNAME);
+
+    Tgraph_construct_comm.start();
+    base_DistGraph::setup_communication();
+    Tgraph_construct_comm.stop();
+  }
+
+  /**
+   * Free the graph partitioner
+   */
+  ~DistGraphGeneric() {
+    delete graphPartitioner;
+  }
+
+ private:
+  /**
+   * Partition by loading this host's slice of the graph into memory,
+   * inspecting it to build the node mapping and CSR layout, then sending
+   * edges to their owners in a second pass.
+   *
+   * @param g offline graph used to find this host's edge range
+   * @param filename graph file to read
+   */
+  void multiPassPartition(galois::graphs::OfflineGraph& g,
+                          const std::string& filename) {
     uint64_t nodeBegin = base_DistGraph::gid2host[base_DistGraph::id].first;
     typename galois::graphs::OfflineGraph::edge_iterator edgeBegin =
         g.edge_begin(nodeBegin);
@@ -284,52 +369,8 @@ class DistGraphGeneric : public DistGraph<NodeTy, EdgeTy> {
       edgeCutLoad(base_DistGraph::graph, bufGraph);
       bufGraph.resetAndFree();
     }
-
-    // Finalization
-
-    // TODO this is a hack; fix it somehow
-    if (graphPartitioner->isVertexCut() && !graphPartitioner->isCartCut()) {
-      base_DistGraph::numNodesWithEdges = numNodes;
-    }
-
-    if (transpose && (numNodes > 0)) {
-      // consider all nodes to have outgoing edges (TODO better way to do this?)
-      // for now it's fine I guess
-      base_DistGraph::numNodesWithEdges = numNodes;
-      base_DistGraph::graph.transpose(GRNAME);
-      base_DistGraph::transposed = true;
-    }
-
-    galois::CondStatTimer<MORE_DIST_STATS> Tthread_ranges("ThreadRangesTime",
-                                                          GRNAME);
-
-    Tthread_ranges.start();
-    base_DistGraph::determineThreadRanges();
-    Tthread_ranges.stop();
-
-    base_DistGraph::determineThreadRangesMaster();
-    base_DistGraph::determineThreadRangesWithEdges();
-    base_DistGraph::initializeSpecificRanges();
-
-    Tgraph_construct.stop();
-    galois::gPrint("[", base_DistGraph::id, "] Graph construction complete.\n");
-
-    galois::CondStatTimer<MORE_DIST_STATS> Tgraph_construct_comm(
-        "GraphCommSetupTime", GRNAME);
-
-    Tgraph_construct_comm.start();
-    base_DistGraph::setup_communication();
-    Tgraph_construct_comm.stop();
   }
 
-  /**
-   * Free the graph partitioner
-   */
-  ~DistGraphGeneric() {
-    delete graphPartitioner;
-  }
-
- private:
   void edgeCutInspection(galois::graphs::BufferedGraph<EdgeTy>& bufGraph,
                          galois::StatTimer& inspectionTimer,
                          uint64_t edgeOffset,
@@ -453,6 +494,7 @@ class DistGraphGeneric : public DistGraph<NodeTy, EdgeTy> {
       globalToLocalMap[localToGlobalVector[i]] = i;
     }
     assert(globalToLocalMap.size() == numNodes);
+    finalizeGlobalToLocal();
 
     base_DistGraph::numNodesWithEdges = base_DistGraph::numOwned;
   }
@@ -1170,6 +1212,7 @@ class DistGraphGeneric : public DistGraph<NodeTy, EdgeTy> {
       // global to local map construction
       globalToLocalMap[localToGlobalVector[i]] = i;
     }
+    finalizeGlobalToLocal();
     if (prefixSumOfEdges.size() != 0) {
       numEdges = prefixSumOfEdges.back();
     } else {
@@ -1179,6 +1222,62 @@ class DistGraphGeneric : public DistGraph<NodeTy, EdgeTy> {
 
 ////////////////////////////////////////////////////////////////////////////////
 
+  /**
+   * Once every local node is known, move the global to local map into the
+   * structure chosen by -g2lMap, then report its memory use and the mean
+   * latency of a sample of mirror lookups.
+   */
+  void finalizeGlobalToLocal() {
+    if (g2lKind == hashG2L) {
+      // a compacted map is saved empty; rebuild it from the L2G vector
+      if (globalToLocalMap.size() != localToGlobalVector.size()) {
+        globalToLocalMap.clear();
+        globalToLocalMap.reserve(localToGlobalVector.size());
+        for (uint32_t i = 0; i < localToGlobalVector.size(); i++) {
+          globalToLocalMap[localToGlobalVector[i]] = i;
+        }
+      }
+    } else {
+      compactG2L.build(g2lKind, localToGlobalVector,
+                       base_DistGraph::numOwned,
+                       base_DistGraph::numGlobalNodes);
+      std::unordered_map<uint64_t, uint32_t>().swap(globalToLocalMap);
+    }
+
+    size_t mapBytes;
+    if (g2lKind == hashG2L) {
+      // buckets plus one node (next pointer and entry) per element
+      mapBytes = globalToLocalMap.bucket_count() * sizeof(void*) +
+                 globalToLocalMap.size() *
+                     (sizeof(void*) +
+                      sizeof(std::pair<const uint64_t, uint32_t>));
+    } else {
+      mapBytes = compactG2L.memoryBytes();
+    }
+    galois::runtime::reportStat_Tsum(GRNAME, "G2LMapBytes", mapBytes);
+
+    const uint32_t numMirrors =
+        localToGlobalVector.size() - base_DistGraph::numOwned;
+    if (numMirrors == 0) {
+      return;
+    }
+    const uint32_t samples = std::min(numMirrors, 1u << 16);
+    const uint32_t stride  = numMirrors / samples;
+    uint64_t check         = 0;
+    auto start             = std::chrono::steady_clock::now();
+    for (uint32_t s = 0; s < samples; s++) {
+      check += G2L(localToGlobalVector[base_DistGraph::numOwned + s * stride]);
+    }
+    auto end = std::chrono::steady_clock::now();
+    // keeps the lookups from being optimized away
+    volatile uint64_t sink = check;
+    (void)sink;
+    uint64_t ns =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(end - start)
+            .count();
+    galois::runtime::reportStat_Tmax(GRNAME, "G2LLookupNs", ns / samples);
+  }
+
   /**
    * Fill up mirror arrays.
    * TODO make parallel?
@@ -1594,6 +1693,411 @@ class DistGraphGeneric : public DistGraph<NodeTy, EdgeTy> {
     }
   }
 
+////////////////////////////////////////////////////////////////////////////////
+// Streaming partitioning
+////////////////////////////////////////////////////////////////////////////////
+
+  //! Number of edges each thread reads from disk at a time when streaming
+  static constexpr uint64_t streamBlockEdges = 1 << 16;
+
+  /**
+   * Per-thread state of the streaming partitioner. Edge data is kept as raw
+   * bytes (as laid out in the graph file) so that void and non-void edge data
+   * share one code path until edges are constructed.
+   */
+  struct StreamBuffers {
+    //! edges kept on this host in coordinate form
+    std::vector<uint32_t> keptSrc;
+    std::vector<uint32_t> keptDst;
+    std::vector<char> keptData;
+    //! destinations/data of the block currently read from disk
+    std::vector<uint32_t> blockDst;
+    std::vector<char> blockData;
+    //! edges of the current source bound for each host
+    std::vector<std::vector<uint32_t>> hostDst;
+    std::vector<std::vector<char>> hostData;
+    //! outgoing edge messages being batched, one per host
+    std::vector<galois::runtime::SendBuffer> sendBuffers;
+    //! scratch space for deserializing received edges
+    std::vector<uint32_t> recvDst;
+    std::vector<char> recvData;
+
+    explicit StreamBuffers(uint32_t numHosts)
+        : hostDst(numHosts), hostData(numHosts), sendBuffers(numHosts) {}
+
+    void keep(uint32_t src, uint32_t dst, const char* data, size_t dataSize) {
+      keptSrc.push_back(src);
+      keptDst.push_back(dst);
+      keptData.insert(keptData.end(), data, data + dataSize);
+    }
+  };
+
+  //! Read exactly size bytes at offset from an open graph file
+  static void streamRead(int fd, void* buf, size_t size, uint64_t offset) {
+    char* out = (char*)buf;
+    while (size > 0) {
+      ssize_t numRead = pread(fd, out, size, offset);
+      if (numRead < 0) {
+        GALOIS_SYS_DIE("failed reading graph file");
+      } else if (numRead == 0) {
+        GALOIS_DIE("unexpected end of graph file");
+      }
+      out += numRead;
+      size -= numRead;
+      offset += numRead;
+    }
+  }
+
+  /**
+   * Partition in a single pass over this host's slice of the graph file.
+   *
+   * All threads read blocks of edges with pread, keep the edges this host
+   * owns, and batch the rest into messages that are sent as soon as they
+   * fill up; received edges are drained between blocks so exchange overlaps
+   * reading. Once every host has signaled the end of its stream, the node
+   * mapping (masters, mirrors with edges, mirrors without edges) and the CSR
+   * are built from the kept edges.
+   *
+   * @param filename graph file to read; must be a version 1 Galois graph
+   */
+  void streamingPartition(const std::string& filename) {
+    auto& net               = galois::runtime::getSystemNetworkInterface();
+    const uint32_t myID     = base_DistGraph::id;
+    const uint32_t numHosts = base_DistGraph::numHosts;
+    const size_t dataSize   = internal::EdgeDataBytes<EdgeTy>::value;
+    const uint64_t nodeBegin = base_DistGraph::gid2host[myID].first;
+    const uint64_t nodeEnd   = base_DistGraph::gid2host[myID].second;
+    base_DistGraph::numOwned = nodeEnd - nodeBegin;
+
+    galois::StatTimer streamTimer("EdgeStreaming", GRNAME);
+    streamTimer.start();
+
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+      GALOIS_SYS_DIE("failed opening ", filename);
+    }
+    uint64_t header[4];
+    streamRead(fd, header, sizeof(header), 0);
+    if (header[0] != 1) {
+      GALOIS_DIE("streaming partitioning only supports version 1 graphs");
+    }
+    const uint64_t numGlobalEdges = base_DistGraph::numGlobalEdges;
+    const uint64_t destBase =
+        (4 + base_DistGraph::numGlobalNodes) * sizeof(uint64_t);
+    const uint64_t dataBase = destBase + numGlobalEdges * sizeof(uint32_t) +
+                              ((numGlobalEdges % 2) ? sizeof(uint32_t) : 0);
+
+    // outIndex[i] is the first edge of read node i; outIndex[numOwned] is the
+    // end of the last one
+    const uint64_t numRead = base_DistGraph::numOwned;
+    std::vector<uint64_t> outIndex(numRead + 1, 0);
+    if (nodeBegin > 0) {
+      streamRead(fd, outIndex.data(), (numRead + 1) * sizeof(uint64_t),
+                 (4 + nodeBegin - 1) * sizeof(uint64_t));
+    } else if (numRead > 0) {
+      streamRead(fd, outIndex.data() + 1, numRead * sizeof(uint64_t),
+                 4 * sizeof(uint64_t));
+    }
+
+    // cut read nodes into blocks of roughly streamBlockEdges edges
+    std::vector<uint64_t> blockStarts;
+    for (uint64_t b = 0; b < numRead;) {
+      uint64_t e = b + 1;
+      while (e < numRead && outIndex[e + 1] - outIndex[b] <= streamBlockEdges) {
+        ++e;
+      }
+      blockStarts.push_back(b);
+      b = e;
+    }
+    blockStarts.push_back(numRead);
+
+    galois::substrate::PerThreadStorage<StreamBuffers> buffers(numHosts);
+    std::atomic<uint32_t> hostsDone(0);
+    galois::GAccumulator<uint64_t> bytesRead;
+    galois::GAccumulator<uint64_t> messagesSent;
+    galois::GAccumulator<uint64_t> bytesSent;
+    bytesRead.reset();
+    messagesSent.reset();
+    bytesSent.reset();
+
+    auto sendBuffer = [&](uint32_t h, galois::runtime::SendBuffer& b) {
+      messagesSent += 1;
+      bytesSent.update(b.size());
+      net.sendTagged(h, galois::runtime::evilPhase, b);
+      b.getVec().clear();
+    };
+
+    auto drainReceives = [&](StreamBuffers& tb) {
+      while (auto p = net.recieveTagged(galois::runtime::evilPhase, nullptr)) {
+        processStreamedEdges(p->second, tb, hostsDone);
+      }
+    };
+
+    galois::do_all(
+        galois::iterate((size_t)0, blockStarts.size() - 1),
+        [&](size_t blk) {
+          auto& tb           = *buffers.getLocal();
+          uint64_t first     = blockStarts[blk];
+          uint64_t last      = blockStarts[blk + 1];
+          uint64_t edgeStart = outIndex[first];
+          uint64_t blockSize = outIndex[last] - edgeStart;
+
+          tb.blockDst.resize(blockSize);
+          streamRead(fd, tb.blockDst.data(), blockSize * sizeof(uint32_t),
+                     destBase + edgeStart * sizeof(uint32_t));
+          tb.blockData.resize(blockSize * dataSize);
+          if (dataSize) {
+            streamRead(fd, tb.blockData.data(), blockSize * dataSize,
+                       dataBase + edgeStart * dataSize);
+          }
+          bytesRead += blockSize * (sizeof(uint32_t) + dataSize);
+
+          for (uint64_t n = first; n < last; ++n) {
+            uint32_t src       = nodeBegin + n;
+            uint64_t numEdgesL = outIndex[n + 1] - outIndex[n];
+            for (uint64_t i = outIndex[n] - edgeStart;
+                 i < outIndex[n + 1] - edgeStart; ++i) {
+              uint32_t dst   = tb.blockDst[i];
+              const char* d  = tb.blockData.data() + i * dataSize;
+              uint32_t owner = graphPartitioner->getEdgeOwner(src, dst,
+                                                              numEdgesL);
+              if (owner == myID) {
+                tb.keep(src, dst, d, dataSize);
+              } else {
+                tb.hostDst[owner].push_back(dst);
+                tb.hostData[owner].insert(tb.hostData[owner].end(), d,
+                                          d + dataSize);
+              }
+            }
+
+            for (uint32_t h = 0; h < numHosts; ++h) {
+              if (tb.hostDst[h].empty()) continue;
+              auto& b = tb.sendBuffers[h];
+              galois::runtime::gSerialize(b, src, tb.hostDst[h],
+                                          tb.hostData[h]);
+              tb.hostDst[h].clear();
+              tb.hostData[h].clear();
+              if (b.size() > edgePartitionSendBufSize) {
+                sendBuffer(h, b);
+              }
+            }
+          }
+
+          // overlap receives with reading
+          drainReceives(tb);
+        },
+#if MORE_DIST_STATS
+        galois::loopname("EdgeStreamingLoop"),
+#endif
+        galois::steal(), galois::no_stats());
+
+    close(fd);
+
+    // flush batched edges, then mark the end of this host's stream; messages
+    // from one host arrive in order, so the marker comes after all its edges
+    for (unsigned t = 0; t < buffers.size(); ++t) {
+      auto& tb = *buffers.getRemote(t);
+      for (uint32_t h = 0; h < numHosts; ++h) {
+        if (tb.sendBuffers[h].size() > 0) {
+          sendBuffer(h, tb.sendBuffers[h]);
+        }
+      }
+    }
+    for (uint32_t h = 0; h < numHosts; ++h) {
+      if (h == myID) continue;
+      galois::runtime::SendBuffer b;
+      galois::runtime::gSerialize(b, ~uint32_t(0));
+      net.sendTagged(h, galois::runtime::evilPhase, b);
+    }
+    net.flush();
+
+    galois::on_each([&](unsigned, unsigned) {
+      auto& tb = *buffers.getLocal();
+      while (hostsDone < numHosts - 1) {
+        drainReceives(tb);
+      }
+    });
+    base_DistGraph::increment_evilPhase();
+
+    streamTimer.stop();
+    galois::gPrint("[", myID, "] Edge streaming time: ",
+                   streamTimer.get_usec() / 1000000.0f, " seconds to read ",
+                   bytesRead.reduce(), " bytes (",
+                   bytesRead.reduce() / (float)streamTimer.get_usec(),
+                   " MBPS)\n");
+    galois::runtime::reportStat_Tsum(
+        GRNAME, std::string("EdgeStreamingMessagesSent"),
+        messagesSent.reduce());
+    galois::runtime::reportStat_Tsum(
+        GRNAME, std::string("EdgeStreamingBytesSent"), bytesSent.reduce());
+
+    galois::StatTimer buildTimer("StreamedGraphBuilding", GRNAME);
+    buildTimer.start();
+    buildStreamedGraph(buffers, nodeBegin, nodeEnd);
+    buildTimer.stop();
+
+    fillMirrors();
+    base_DistGraph::printStatistics();
+  }
+
+  /**
+   * Deserialize a streamed edge message into a thread's kept edges. A record
+   * with source ~0 marks the end of the sending host's stream.
+   */
+  void processStreamedEdges(galois::runtime::RecvBuffer& rb,
+                            StreamBuffers& tb,
+                            std::atomic<uint32_t>& hostsDone) {
+    const size_t dataSize = internal::EdgeDataBytes<EdgeTy>::value;
+    while (rb.r_size() > 0) {
+      uint32_t src;
+      galois::runtime::gDeserialize(rb, src);
+      if (src == ~uint32_t(0)) {
+        ++hostsDone;
+        continue;
+      }
+      galois::runtime::gDeserialize(rb, tb.recvDst, tb.recvData);
+      assert(tb.recvData.size() == tb.recvDst.size() * dataSize);
+      for (size_t i = 0; i < tb.recvDst.size(); ++i) {
+        tb.keep(src, tb.recvDst[i], tb.recvData.data() + i * dataSize,
+                dataSize);
+      }
+    }
+  }
+
+  /**
+   * Build the node mapping and CSR from the edges every thread kept.
+   * Local layout matches the multi-pass partitioner: masters, then mirrors
+   * with outgoing edges, then mirrors that are only edge destinations.
+   */
+  void buildStreamedGraph(
+      galois::substrate::PerThreadStorage<StreamBuffers>& buffers,
+      uint64_t nodeBegin, uint64_t nodeEnd) {
+    const size_t dataSize = internal::EdgeDataBytes<EdgeTy>::value;
+    auto isOwnedGID = [&](uint32_t gid) {
+      return gid >= nodeBegin && gid < nodeEnd;
+    };
+
+    galois::DynamicBitSet outgoingMirrors;
+    galois::DynamicBitSet incomingMirrors;
+    outgoingMirrors.resize(base_DistGraph::numGlobalNodes);
+    incomingMirrors.resize(base_DistGraph::numGlobalNodes);
+    outgoingMirrors.reset();
+    incomingMirrors.reset();
+
+    galois::on_each([&](unsigned, unsigned) {
+      auto& tb = *buffers.getLocal();
+      for (size_t i = 0; i < tb.keptSrc.size(); ++i) {
+        if (!isOwnedGID(tb.keptSrc[i])) outgoingMirrors.set(tb.keptSrc[i]);
+        if (!isOwnedGID(tb.keptDst[i])) incomingMirrors.set(tb.keptDst[i]);
+      }
+    });
+
+    // a node with outgoing edges is placed with those only
+    auto& inWords  = incomingMirrors.get_vec();
+    auto& outWords = outgoingMirrors.get_vec();
+    galois::do_all(galois::iterate((size_t)0, inWords.size()),
+                   [&](size_t i) { inWords[i] = inWords[i] & ~outWords[i]; },
+                   galois::no_stats());
+
+    std::vector<uint32_t> outgoing = outgoingMirrors.getOffsets();
+    std::vector<uint32_t> incoming = incomingMirrors.getOffsets();
+
+    uint32_t numOwned = base_DistGraph::numOwned;
+    base_DistGraph::numNodesWithEdges = numOwned + outgoing.size();
+    numNodes = base_DistGraph::numNodesWithEdges + incoming.size();
+
+    localToGlobalVector.resize(numNodes);
+    galois::do_all(
+        galois::iterate((uint32_t)0, numNodes),
+        [&](uint32_t lid) {
+          if (lid < numOwned) {
+            localToGlobalVector[lid] = nodeBegin + lid;
+          } else if (lid < base_DistGraph::numNodesWithEdges) {
+            localToGlobalVector[lid] = outgoing[lid - numOwned];
+          } else {
+            localToGlobalVector[lid] =
+                incoming[lid - base_DistGraph::numNodesWithEdges];
+          }
+        },
+        galois::no_stats());
+
+    globalToLocalMap.reserve(numNodes);
+    for (uint32_t i = 0; i < numNodes; i++) {
+      globalToLocalMap[localToGlobalVector[i]] = i;
+    }
+    finalizeGlobalToLocal();
+
+    // count edges per local node, then prefix sum
+    galois::gstl::Vector<uint64_t> prefixSumOfEdges(numNodes, 0);
+    galois::on_each([&](unsigned, unsigned) {
+      auto& tb = *buffers.getLocal();
+      for (uint32_t src : tb.keptSrc) {
+        __sync_fetch_and_add(&prefixSumOfEdges[G2LEdgeCut(src, nodeBegin)], 1);
+      }
+    });
+    for (uint32_t i = 1; i < numNodes; i++) {
+      prefixSumOfEdges[i] += prefixSumOfEdges[i - 1];
+    }
+    numEdges = (numNodes > 0) ? prefixSumOfEdges.back() : 0;
+
+    base_DistGraph::beginMaster = 0;
+    base_DistGraph::graph.allocateFrom(numNodes, numEdges);
+    base_DistGraph::graph.constructNodes();
+
+    auto& base_graph = base_DistGraph::graph;
+    galois::do_all(
+      galois::iterate((uint32_t)0, numNodes),
+      [&](auto n) { base_graph.fixEndEdge(n, prefixSumOfEdges[n]); },
+#if MORE_DIST_STATS
+      galois::loopname("FixEndEdgeLoop"),
+#endif
+      galois::no_stats()
+    );
+
+    // insert edges; prefixSumOfEdges becomes the next free slot of each node
+    galois::do_all(
+      galois::iterate((uint32_t)0, numNodes),
+      [&](auto n) {
+        prefixSumOfEdges[n] = *base_graph.edge_begin(
+            n, galois::MethodFlag::UNPROTECTED);
+      },
+      galois::no_stats()
+    );
+    galois::on_each([&](unsigned, unsigned) {
+      auto& tb = *buffers.getLocal();
+      for (size_t i = 0; i < tb.keptSrc.size(); ++i) {
+        uint32_t lsrc = G2LEdgeCut(tb.keptSrc[i], nodeBegin);
+        uint32_t ldst = G2LEdgeCut(tb.keptDst[i], nodeBegin);
+        uint64_t edge = __sync_fetch_and_add(&prefixSumOfEdges[lsrc], 1);
+        constructStreamedEdge(base_graph, edge, ldst,
+                              tb.keptData.data() + i * dataSize);
+      }
+      freeVector(tb.keptSrc);
+      freeVector(tb.keptDst);
+      freeVector(tb.keptData);
+    });
+  }
+
+  //! Construct an edge whose data is given as raw file bytes
+  template <typename GraphTy,
+            typename std::enable_if<!std::is_void<
+                typename GraphTy::edge_data_type>::value>::type* = nullptr>
+  void constructStreamedEdge(GraphTy& graph, uint64_t edge, uint32_t ldst,
+                             const char* data) {
+    typename GraphTy::edge_data_type gdata;
+    std::memcpy(&gdata, data, sizeof(gdata));
+    graph.constructEdge(edge, ldst, gdata);
+  }
+
+  //! Construct an edge of a graph without edge data
+  template <typename GraphTy,
+            typename std::enable_if<std::is_void<
+                typename GraphTy::edge_data_type>::value>::type* = nullptr>
+  void constructStreamedEdge(GraphTy& graph, uint64_t edge, uint32_t ldst,
+                             const char*) {
+    graph.constructEdge(edge, ldst);
+  }
+
  public:
   /**
    * Reset bitset
@@ -1666,6 +2170,7 @@ class DistGraphGeneric : public DistGraph<NodeTy, EdgeTy> {
     // maps and vectors
     ar >> localToGlobalVector;
     ar >> globalToLocalMap;
+    finalizeGlobalToLocal();
   }
 };
 
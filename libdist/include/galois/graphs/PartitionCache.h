@@ -0,0 +1,254 @@
+/*
+ * This file belongs to the Galois project, a C++ library for exploiting parallelism.
+ * The code is being released under the terms of the 3-Clause BSD License (a
+ * copy is located in LICENSE.txt at the top-level directory).
+ *
+ * Copyright (C) 2018, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ */
+
+
+/**
+ * @file PartitionCache.h
+ *
+ * On-disk cache of a host's partition of a distributed graph. A cache file
+ * holds the local CSR topology in page-aligned raw sections that can be
+ * mapped without copying, followed by the master/mirror lists, the
+ * global/local id maps, and partitioner state. Files are keyed on a
+ * fingerprint of the input graph, the partitioning policy, and the host
+ * count, so a later run with the same configuration can skip partitioning.
+ */
+
+#ifndef GALOIS_GRAPHS_PARTITION_CACHE_H
+#define GALOIS_GRAPHS_PARTITION_CACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace galois {
+namespace graphs {
+
+namespace internal {
+//! Size in bytes of one edge's data in a graph file; 0 for void edge data
+template <typename EdgeTy>
+struct EdgeDataBytes : std::integral_constant<size_t, sizeof(EdgeTy)> {};
+//! Void edge data takes no space in a graph file
+template <>
+struct EdgeDataBytes<void> : std::integral_constant<size_t, 0> {};
+} // namespace internal
+
+//! Version of the partition cache layout; bump on any format change
+constexpr uint32_t PARTITION_CACHE_VERSION = 1;
+//! Alignment of every section in a partition cache file
+constexpr uint64_t PARTITION_CACHE_ALIGN = 4096;
+
+/**
+ * Identifies the partition stored in a cache file. Two runs may share a
+ * cache file only if every field matches.
+ */
+struct PartitionCacheKey {
+  //! size in bytes of the input graph file
+  uint64_t inputSize;
+  //! modification time of the input graph file in nanoseconds
+  uint64_t inputMtime;
+  //! hash of the input file's header and sampled blocks
+  uint64_t inputHash;
+  //! hash of the partitioning policy string
+  uint64_t policyHash;
+  //! number of hosts the graph was partitioned for
+  uint32_t numHosts;
+  //! host whose partition is stored
+  uint32_t hostID;
+  //! size of the edge data of one edge
+  uint32_t edgeDataSize;
+  //! always 0; keeps the struct free of padding
+  uint32_t reserved;
+};
+
+/**
+ * Header at the start of a partition cache file. All offsets are from the
+ * start of the file and are multiples of PARTITION_CACHE_ALIGN.
+ */
+struct PartitionCacheHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t headerSize;
+  PartitionCacheKey key;
+  uint64_t numNodes;
+  uint64_t numEdges;
+  //! numNodes uint64_t edge end offsets
+  uint64_t edgeIndOffset;
+  //! numEdges uint32_t edge destinations
+  uint64_t edgeDstOffset;
+  //! numEdges * edgeDataSize bytes of edge data
+  uint64_t edgeDataOffset;
+  //! boost binary archive of everything besides the topology
+  uint64_t metaOffset;
+  uint64_t metaSize;
+  //! total size of the file; a truncated file fails validation
+  uint64_t fileSize;
+  //! policy string, kept for diagnostics
+  char policy[128];
+};
+
+namespace internal {
+//! Appends nothing; ends the recursion over policy parameters
+inline void partitionPolicyAppend(std::ostringstream&) {}
+
+template <typename T, typename... Args>
+void partitionPolicyAppend(std::ostringstream& out, const std::vector<T>& v,
+                           const Args&... rest);
+
+//! Appends one policy parameter and recurses on the rest
+template <typename T, typename... Args>
+void partitionPolicyAppend(std::ostringstream& out, const T& v,
+                           const Args&... rest) {
+  out << ':' << v;
+  partitionPolicyAppend(out, rest...);
+}
+
+//! Appends a vector parameter (e.g. a scale factor) as [a,b,...]
+template <typename T, typename... Args>
+void partitionPolicyAppend(std::ostringstream& out, const std::vector<T>& v,
+                           const Args&... rest) {
+  out << ":[";
+  for (size_t i = 0; i < v.size(); ++i) {
+    out << (i ? "," : "") << v[i];
+  }
+  out << ']';
+  partitionPolicyAppend(out, rest...);
+}
+} // namespace internal
+
+/**
+ * Describes a partitioning policy for use in a PartitionCacheKey.
+ *
+ * @param name name of the partitioner
+ * @param params parameters that change the partition the policy produces
+ * @returns name and parameters joined with ':'
+ */
+template <typename... Args>
+std::string partitionPolicyString(const std::string& name,
+                                  const Args&... params) {
+  std::ostringstream out;
+  out << name;
+  internal::partitionPolicyAppend(out, params...);
+  return out.str();
+}
+
+/**
+ * Computes the cache key of a partition. The input graph is fingerprinted
+ * by its size, modification time, and a hash of its first block plus blocks
+ * sampled across the file, which avoids reading the whole graph.
+ *
+ * @param inputFile graph file being partitioned
+ * @param policy policy string from partitionPolicyString
+ * @param hostID host whose partition is keyed
+ * @param numHosts total number of hosts
+ * @param edgeDataSize size of one edge's data
+ */
+PartitionCacheKey makePartitionCacheKey(const std::string& inputFile,
+                                        const std::string& policy,
+                                        uint32_t hostID, uint32_t numHosts,
+                                        uint32_t edgeDataSize);
+
+/**
+ * @returns path of the cache file for a key inside a cache directory
+ */
+std::string partitionCachePath(const std::string& dir,
+                               const PartitionCacheKey& key);
+
+/**
+ * Checks only the header of a cache file: magic, version, key, and file
+ * size. Does not touch the sections.
+ *
+ * @returns true if the file exists and holds the partition for the key
+ */
+bool validatePartitionCache(const std::string& path,
+                            const PartitionCacheKey& key);
+
+/**
+ * Private mapping of a partition cache file. Sections are mapped
+ * copy-on-write, so a graph built on them may update edge data without
+ * touching the file.
+ */
+class PartitionCacheMapping {
+  char* base;
+  size_t length;
+
+public:
+  PartitionCacheMapping() : base(nullptr), length(0) {}
+  PartitionCacheMapping(const PartitionCacheMapping&) = delete;
+  PartitionCacheMapping& operator=(const PartitionCacheMapping&) = delete;
+  ~PartitionCacheMapping() { unmap(); }
+
+  /**
+   * Maps a cache file that passed validatePartitionCache. Dies on failure.
+   */
+  void map(const std::string& path);
+
+  //! Unmaps the file if mapped
+  void unmap();
+
+  //! @returns header of the mapped file
+  const PartitionCacheHeader& header() const {
+    return *reinterpret_cast<const PartitionCacheHeader*>(base);
+  }
+
+  //! @returns pointer to the section at an offset of the mapped file
+  char* section(uint64_t offset) const { return base + offset; }
+};
+
+/**
+ * Writes a partition cache file section by section. The file is written
+ * under a temporary name and renamed into place by finish, so readers never
+ * see a partial file.
+ */
+class PartitionCacheWriter {
+  std::string path;
+  std::string tmpPath;
+  int fd;
+  uint64_t offset;
+
+public:
+  /**
+   * Creates the temporary file and reserves room for the header. Dies on
+   * failure.
+   */
+  explicit PartitionCacheWriter(const std::string& path);
+  PartitionCacheWriter(const PartitionCacheWriter&) = delete;
+  PartitionCacheWriter& operator=(const PartitionCacheWriter&) = delete;
+  ~PartitionCacheWriter();
+
+  /**
+   * Appends a section at the next aligned offset.
+   *
+   * @returns offset of the section
+   */
+  uint64_t append(const void* data, size_t bytes);
+
+  /**
+   * Writes the header, fills in its magic, version, and file size, and
+   * publishes the file.
+   */
+  void finish(PartitionCacheHeader& header);
+};
+
+} // namespace graphs
+} // namespace galois
+
+#endif
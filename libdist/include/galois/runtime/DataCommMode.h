@@ -28,6 +28,10 @@
  */
 #pragma once
 
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
 //! Enumeration of data communication modes that can be used in sychronization
 //! @todo document the enums in doxygen
 enum DataCommMode {
@@ -38,61 +42,106 @@ enum DataCommMode {
   onlyData,
   dataSplitFirst,
   dataSplit,
-  neverOnlyData
+  neverOnlyData,
+  runLengthData, //!< offsets as runs of consecutive nodes (SyncCompression.h)
+  compressedData //!< marks a block-compressed message; wraps another mode
 };
 
 //! If this is set, then always used the data mode it is set to
 extern DataCommMode enforce_data_mode;
 
+/**
+ * Estimates the size of the payload of a message in a given data mode.
+ *
+ * @tparam DataType type of the data to be synchronized
+ *
+ * @param data_mode mode to estimate the size for
+ * @param num_selected number of elements to send out (subset of num_total)
+ * @param num_total total number of elements that exist
+ * @param runs_size measured size of the run-length encoded offsets of the
+ * selected elements
+ *
+ * @returns estimated number of bytes the message takes in that mode
+ */
+template <typename DataType>
+size_t get_data_mode_size(DataCommMode data_mode, size_t num_selected,
+                          size_t num_total, size_t runs_size = 0) {
+  switch (data_mode) {
+  case bitsetData:
+    return (num_selected * sizeof(DataType)) +
+           ((num_total + 63) / 64) * sizeof(uint64_t) + (2 * sizeof(size_t)) +
+           sizeof(num_selected);
+  case offsetsData:
+    return (num_selected * sizeof(DataType)) +
+           (num_selected * sizeof(unsigned int)) + sizeof(size_t) +
+           sizeof(num_selected);
+  case runLengthData:
+    return (num_selected * sizeof(DataType)) + runs_size + sizeof(size_t) +
+           sizeof(num_selected);
+  case onlyData:
+    return num_total * sizeof(DataType);
+  default:
+    return 0;
+  }
+}
+
 /**
  * Given a size of a subset of elements to send and the total number of
  * elements, determine an appropriate data mode to use for sending out the data
  * during synchronization.
  *
+ * runLengthData is only considered if the caller measured the encoded size
+ * of the offsets (runs_size > 0); otherwise offsetsData is used in its place.
+ *
  * @tparam DataType type of the data to be synchronized
  *
  * @param num_selected number of elements to send out (subset of num_total)
  * @param num_total total number of elements that exist
+ * @param runs_size measured size of the run-length encoded offsets of the
+ * selected elements, or 0 if not measured
  *
  * @returns an appropriate DataCommMode to use for synchronization
  */
 template <typename DataType>
-DataCommMode get_data_mode(size_t num_selected, size_t num_total) {
+DataCommMode get_data_mode(size_t num_selected, size_t num_total,
+                           size_t runs_size = 0) {
   DataCommMode data_mode = noData;
   // TODO clean up neverOnlyData path (integrate with main path in some way)
   if (enforce_data_mode == neverOnlyData) {
     if (num_selected == 0) {
       data_mode = noData;
     } else {
-      size_t bitset_alloc_size =
-          ((num_total + 63) / 64) * sizeof(uint64_t) + (2 * sizeof(size_t));
-
-      size_t bitsetDataSize = (num_selected * sizeof(DataType)) +
-                              bitset_alloc_size + sizeof(num_selected);
-      size_t offsetsDataSize = (num_selected * sizeof(DataType)) +
-                               (num_selected * sizeof(unsigned int)) +
-                               sizeof(size_t) + sizeof(num_selected);
+      size_t bitsetDataSize = get_data_mode_size<DataType>(
+          bitsetData, num_selected, num_total);
+      size_t offsetsDataSize = get_data_mode_size<DataType>(
+          offsetsData, num_selected, num_total);
       if (bitsetDataSize < offsetsDataSize) {
         data_mode = bitsetData;
       } else {
         data_mode = offsetsData;
       }
+      if (runs_size > 0 &&
+          get_data_mode_size<DataType>(runLengthData, num_selected, num_total,
+                                       runs_size) <
+              std::min(bitsetDataSize, offsetsDataSize)) {
+        data_mode = runLengthData;
+      }
     }
   } else if (enforce_data_mode != noData) {
     data_mode = enforce_data_mode;
+    if (data_mode == runLengthData && runs_size == 0) {
+      data_mode = offsetsData;
+    }
   } else { // no enforced mode, so find an appropriate mode
     if (num_selected == 0) {
       data_mode = noData;
     } else {
-      size_t bitset_alloc_size =
-          ((num_total + 63) / 64) * sizeof(uint64_t) + (2 * sizeof(size_t));
-
-      size_t onlyDataSize   = (num_total * sizeof(DataType));
-      size_t bitsetDataSize = (num_selected * sizeof(DataType)) +
-                              bitset_alloc_size + sizeof(num_selected);
-      size_t offsetsDataSize = (num_selected * sizeof(DataType)) +
-                               (num_selected * sizeof(unsigned int)) +
-                               sizeof(size_t) + sizeof(num_selected);
+      size_t onlyDataSize =
+          get_data_mode_size<DataType>(onlyData, num_selected, num_total);
+      size_t bitsetDataSize = get_data_mode_size<DataType>(
+          bitsetData, num_selected, num_total);
+      size_t offsetsDataSize = get_data_mode_size<DataType>(
+          offsetsData, num_selected, num_total);
       // find the minimum size one
       if (bitsetDataSize < offsetsDataSize) {
         if (bitsetDataSize < onlyDataSize) {
@@ -107,6 +156,13 @@ DataCommMode get_data_mode(size_t num_selected, size_t num_total) {
           data_mode = onlyData;
         }
       }
+      if (runs_size > 0 &&
+          get_data_mode_size<DataType>(runLengthData, num_selected, num_total,
+                                       runs_size) <
+              std::min(onlyDataSize,
+                       std::min(bitsetDataSize, offsetsDataSize))) {
+        data_mode = runLengthData;
+      }
     }
   }
   return data_mode;
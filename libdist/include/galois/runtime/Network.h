@@ -94,6 +94,11 @@ protected:
   std::atomic<size_t> inflightSends;
   std::atomic<size_t> inflightRecvs;
 
+  //! Number of landing pad (tag 0) messages sent and dispatched by this host;
+  //! the host fence compares global totals to detect in-flight messages
+  std::atomic<uint64_t> landingPadSends;
+  std::atomic<uint64_t> landingPadRecvs;
+
 #ifdef __GALOIS_BARE_MPI_COMMUNICATION__
 public:
   //! Wrapper that calls into increment mem usage on the memory usage tracker
@@ -155,12 +160,22 @@ public:
   //! Receive and dispatch messages
   void handleReceives();
 
+  //! @returns number of landing pad messages sent and dispatched by this
+  //! host so far
+  std::pair<uint64_t, uint64_t> landingPadCounts() const {
+    return std::make_pair(landingPadSends.load(), landingPadRecvs.load());
+  }
+
   //! Wrapper to reset the mem usage tracker's stats
   inline void resetMemUsage() { memUsageTracker.resetMemUsage(); }
 
   //! Reports the memory usage tracker's statistics to the stat manager
   void reportMemUsage() const;
 
+  //! Reports the implementation specific statistics of reportExtraNamed to
+  //! the stat manager
+  void reportExtraStats() const;
+
   //! Receive a tagged message
   virtual optional_t<std::pair<uint32_t, RecvBuffer>>
   recieveTagged(uint32_t tag, std::unique_lock<substrate::SimpleLock>* rlg) = 0;
@@ -221,7 +236,10 @@ NetworkInterface& makeNetworkBuffered();
 //! thread is calling it
 substrate::Barrier& getHostBarrier();
 //! Returns a fence that ensures all pending messages are delivered, acting
-//! like a memory-barrier
+//! like a memory-barrier. The implementation is chosen with the
+//! GALOIS_HOST_FENCE environment variable: "dissemination" (default, log N
+//! rounds), "hybrid" (MPI_Iallreduce, falls back to dissemination without
+//! MPI), or "linear" (all-to-all, N^2 messages).
 substrate::Barrier& getHostFence();
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -252,6 +270,7 @@ void NetworkInterface::sendSimple(uint32_t dest,
   SendBuffer buf;
   gSerialize(buf, (uintptr_t)recv, param...,
              (uintptr_t)genericLandingPad<Args...>);
+  ++landingPadSends;
   sendTagged(dest, 0, buf);
 }
 
@@ -21,8 +21,8 @@
  * @file NetworkIO.h
  *
  * Contains NetworkIO, a base class that is inherited by classes that want to
- * implement the communication layer of Galois. (e.g. NetworkIOMPI and
- * NetworkIOLWCI)
+ * implement the communication layer of Galois. (e.g. NetworkIOMPI,
+ * NetworkIOSHM and NetworkIOLWCI)
  */
 
 #ifndef GALOIS_RUNTIME_NETWORKTHREAD_H
@@ -81,6 +81,9 @@ public:
     uint32_t host; //!< destination of this message
     uint32_t tag;  //!< tag on message indicating distinct communication phases
     vTy data; //!< data portion of message
+    //! bytes sent in front of data without copying data behind them; only
+    //! used for outgoing messages, which are received as one buffer
+    vTy header;
 
     //! Default constructor initializes host and tag to large numbers.
     message() : host(~0), tag(~0) {}
@@ -93,6 +96,16 @@ public:
     //! A message is valid if there is data to be sent
     //! @returns true if data is non-empty
     bool valid() const { return !data.empty(); }
+
+    //! Moves the header in front of the data, for IO layers that cannot
+    //! send from two memory regions
+    void flatten() {
+      if (header.empty())
+        return;
+      header.insert(header.end(), data.begin(), data.end());
+      data = std::move(header);
+      header.clear();
+    }
   };
 
   //! The default constructor takes a memory usage tracker and saves it
@@ -115,11 +128,23 @@ public:
 /**
  * Creates/returns a network IO layer that uses MPI to do communication.
  *
+ * @param sources hosts to receive messages from; all hosts if empty. Several
+ * MPI IO layers with disjoint sources can be progressed by different threads.
  * @returns tuple with pointer to the MPI IO layer, this host's ID, and the
  * total number of hosts in the system
  */
 std::tuple<std::unique_ptr<NetworkIO>, uint32_t, uint32_t>
-makeNetworkIOMPI(galois::runtime::MemUsageTracker& tracker, std::atomic<size_t>& sends, std::atomic<size_t>& recvs);
+makeNetworkIOMPI(galois::runtime::MemUsageTracker& tracker, std::atomic<size_t>& sends, std::atomic<size_t>& recvs,
+                 const std::vector<uint32_t>& sources = {});
+/**
+ * Creates/returns a network IO layer that uses POSIX shared memory between
+ * hosts on the same machine. MPI is used only to set it up.
+ *
+ * @returns tuple with pointer to the shared memory IO layer, this host's ID,
+ * and the total number of hosts in the system
+ */
+std::tuple<std::unique_ptr<NetworkIO>, uint32_t, uint32_t>
+makeNetworkIOSHM(galois::runtime::MemUsageTracker& tracker, std::atomic<size_t>& sends, std::atomic<size_t>& recvs);
 #ifdef GALOIS_USE_LWCI
 /**
  * Creates/returns a network IO layer that uses LWCI to do communication.
@@ -0,0 +1,107 @@
+/*
+ * This file belongs to the Galois project, a C++ library for exploiting parallelism.
+ * The code is being released under the terms of the 3-Clause BSD License (a
+ * copy is located in LICENSE.txt at the top-level directory).
+ *
+ * Copyright (C) 2018, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ */
+
+
+/**
+ * @file SyncCompression.h
+ *
+ * Encodings used to shrink synchronization messages: run-length encoded
+ * offsets for the runLengthData comm mode, and a small LZ77 block compressor
+ * (in the style of LZ4) for large payloads.
+ */
+
+#ifndef GALOIS_RUNTIME_SYNC_COMPRESSION_H
+#define GALOIS_RUNTIME_SYNC_COMPRESSION_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace galois {
+namespace runtime {
+
+/**
+ * Size of the run-length encoding of a list of offsets.
+ *
+ * A strictly increasing list of offsets is written as runs of consecutive
+ * values. Each run is two varints: the gap between the start of the run and
+ * the end of the previous run, and the length of the run minus one. A
+ * clustered list costs a few bytes per run instead of 4 bytes per offset,
+ * and a dense list costs less than a bitset.
+ *
+ * @param offsets strictly increasing offsets to encode
+ * @param count number of offsets
+ * @returns number of bytes encodeOffsetRuns writes for the offsets
+ */
+size_t offsetRunsSize(const uint32_t* offsets, size_t count);
+
+/**
+ * Encodes offsets as runs.
+ *
+ * @param offsets strictly increasing offsets to encode
+ * @param count number of offsets
+ * @param out OUTPUT: at least offsetRunsSize(offsets, count) bytes
+ * @returns number of bytes written
+ */
+size_t encodeOffsetRuns(const uint32_t* offsets, size_t count, uint8_t* out);
+
+/**
+ * Decodes offsets written by encodeOffsetRuns.
+ *
+ * @param in encoded runs
+ * @param size number of encoded bytes
+ * @param offsets OUTPUT: room for count offsets
+ * @param count number of offsets that were encoded
+ * @returns true if the input decoded to exactly count offsets
+ */
+bool decodeOffsetRuns(const uint8_t* in, size_t size, uint32_t* offsets,
+                      size_t count);
+
+/**
+ * Compresses a block with LZ77 matching over a 64KB window.
+ *
+ * The output is a series of sequences, each a token byte (literal length in
+ * the high nibble, match length - 4 in the low nibble, 15 meaning more
+ * length bytes follow), the literals, and a 2-byte match offset. The last
+ * sequence has literals only.
+ *
+ * @param src data to compress
+ * @param srcSize number of bytes to compress
+ * @param dst OUTPUT: compressed data
+ * @param dstCapacity room in dst
+ * @returns compressed size, or 0 if the result does not fit in dstCapacity
+ */
+size_t blockCompress(const uint8_t* src, size_t srcSize, uint8_t* dst,
+                     size_t dstCapacity);
+
+/**
+ * Decompresses a block written by blockCompress.
+ *
+ * @param src compressed data
+ * @param srcSize number of compressed bytes
+ * @param dst OUTPUT: decompressed data
+ * @param dstSize size of the original data
+ * @returns true if src decompressed to exactly dstSize bytes
+ */
+bool blockDecompress(const uint8_t* src, size_t srcSize, uint8_t* dst,
+                     size_t dstSize);
+
+} // namespace runtime
+} // namespace galois
+
+#endif
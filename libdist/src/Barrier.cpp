@@ -25,6 +25,12 @@
  *
  * A fence flushes out and receives all messages in the network while a barrier
  * simply acts as a barrier in the code for all hosts.
+ *
+ * The default fence is a dissemination fence: hosts exchange their landing pad
+ * message counts in ceil(log2 N) rounds (host i talks to i + 2^k in round k)
+ * and repeat until two consecutive exchanges agree that every message sent
+ * has been handled. This replaces the O(N^2) all-to-all exchange of the
+ * original (linear) fence with O(N log N) messages per exchange.
  */
 
 #include "galois/substrate/PerThreadStorage.h"
@@ -32,18 +38,33 @@
 #include "galois/substrate/CompilerSpecific.h"
 #include "galois/runtime/Network.h"
 #include "galois/runtime/LWCI.h"
+#include "galois/substrate/EnvCheck.h"
+#include "galois/gIO.h"
 
 #include <cstdlib>
 #include <cstdio>
 #include <limits>
+#include <array>
+#include <deque>
+#include <string>
 
 #include <iostream>
 #include "galois/runtime/BareMPI.h"
 
 namespace {
-class HostFence : public galois::substrate::Barrier {
+
+//! Advances evilPhase so that the next fence/sync uses a fresh tag
+void nextPhase() {
+  ++galois::runtime::evilPhase;
+  if (galois::runtime::evilPhase >=
+      std::numeric_limits<int16_t>::max()) { // limit defined by MPI or LCI
+    galois::runtime::evilPhase = 1;
+  }
+}
+
+class LinearHostFence : public galois::substrate::Barrier {
 public:
-  virtual const char* name() const { return "HostFence"; }
+  virtual const char* name() const { return "LinearHostFence"; }
 
   virtual void reinit(unsigned val) {}
 
@@ -73,13 +94,163 @@ public:
       // ignore received data
       ++received;
     }
-    ++galois::runtime::evilPhase;
-    if (galois::runtime::evilPhase >=
-        std::numeric_limits<int16_t>::max()) { // limit defined by MPI or LCI
-      galois::runtime::evilPhase = 1;
+    nextPhase();
+  }
+};
+
+/**
+ * Fence that decides quiescence by summing every host's landing pad
+ * send/dispatch counters. Counts are exchanged repeatedly (handling incoming
+ * messages in between) until two consecutive exchanges return the same totals
+ * with sends == dispatches; requiring two agreeing waves rules out messages
+ * sent by handlers that ran after a host took its snapshot.
+ *
+ * Subclasses only provide the global sum.
+ */
+class CountingHostFence : public galois::substrate::Barrier {
+protected:
+  using Counts = std::array<uint64_t, 2>;
+
+  //! Sum counts over all hosts; every host gets the result. Must keep calling
+  //! handleReceives() while waiting.
+  virtual Counts allReduce(const Counts& local) = 0;
+
+public:
+  virtual void reinit(unsigned val) {}
+
+  virtual void wait() {
+    auto& net = galois::runtime::getSystemNetworkInterface();
+    if (net.Num == 1) {
+      net.handleReceives();
+      nextPhase();
+      return;
+    }
+
+    Counts previous = {{~uint64_t(0), ~uint64_t(0)}};
+    while (true) {
+      net.flush(); // flush all sends, including ones made by handlers
+      net.handleReceives();
+      auto local   = net.landingPadCounts();
+      Counts total = allReduce({{local.first, local.second}});
+      if (total[0] == total[1] && total == previous)
+        break;
+      previous = total;
+    }
+    nextPhase();
+  }
+};
+
+class DisseminationHostFence : public CountingHostFence {
+  //! one host's contribution, as gathered by the dissemination rounds
+  struct Entry {
+    uint32_t host;
+    uint64_t sent;
+    uint64_t handled;
+  };
+
+  //! message received for a later round or wave than the one in progress
+  struct Early {
+    uint32_t wave;
+    uint32_t round;
+    std::vector<Entry> entries;
+  };
+
+  uint32_t wave = 0;
+  std::deque<Early> early;
+
+  //! Wait for the message of (wave, round) from the round's source host
+  std::vector<Entry> receive(uint32_t round) {
+    auto& net = galois::runtime::getSystemNetworkInterface();
+    while (true) {
+      for (auto ii = early.begin(); ii != early.end(); ++ii) {
+        if (ii->wave == wave && ii->round == round) {
+          std::vector<Entry> entries = std::move(ii->entries);
+          early.erase(ii);
+          return entries;
+        }
+      }
+
+      decltype(net.recieveTagged(galois::runtime::evilPhase, nullptr)) p;
+      do {
+        net.handleReceives();
+        p = net.recieveTagged(galois::runtime::evilPhase, nullptr);
+      } while (!p);
+
+      Early e;
+      galois::runtime::gDeserialize(p->second, e.wave, e.round, e.entries);
+      if (e.wave == wave && e.round == round)
+        return std::move(e.entries);
+      early.push_back(std::move(e));
+    }
+  }
+
+protected:
+  virtual Counts allReduce(const Counts& local) {
+    auto& net = galois::runtime::getSystemNetworkInterface();
+
+    // after round k this host knows hosts ID, ID - 1, ..., ID - 2^(k+1) + 1
+    std::vector<bool> known(net.Num, false);
+    std::vector<Entry> entries{Entry{net.ID, local[0], local[1]}};
+    known[net.ID] = true;
+
+    uint32_t round = 0;
+    for (uint32_t dist = 1; dist < net.Num; dist <<= 1, ++round) {
+      galois::runtime::SendBuffer b;
+      galois::runtime::gSerialize(b, wave, round, entries);
+      net.sendTagged((net.ID + dist) % net.Num, galois::runtime::evilPhase, b);
+      net.flush();
+
+      for (auto& e : receive(round)) {
+        if (!known[e.host]) {
+          known[e.host] = true;
+          entries.push_back(e);
+        }
+      }
+    }
+    assert(entries.size() == net.Num);
+    ++wave;
+
+    Counts total = {{0, 0}};
+    for (auto& e : entries) {
+      total[0] += e.sent;
+      total[1] += e.handled;
+    }
+    return total;
+  }
+
+public:
+  virtual const char* name() const { return "DisseminationHostFence"; }
+
+  virtual void wait() {
+    wave = 0;
+    CountingHostFence::wait();
+    assert(early.empty());
+  }
+};
+
+#ifndef GALOIS_USE_LWCI
+//! Counting fence that sums with a non-blocking MPI collective so that the
+//! MPI library picks the reduction algorithm
+class HybridHostFence : public CountingHostFence {
+protected:
+  virtual Counts allReduce(const Counts& local) {
+    auto& net    = galois::runtime::getSystemNetworkInterface();
+    Counts total = {{0, 0}};
+    MPI_Request req;
+    MPI_Iallreduce(local.data(), total.data(), 2, MPI_UINT64_T, MPI_SUM,
+                   MPI_COMM_WORLD, &req);
+    int done = 0;
+    while (!done) {
+      net.handleReceives();
+      MPI_Test(&req, &done, MPI_STATUS_IGNORE);
     }
+    return total;
   }
+
+public:
+  virtual const char* name() const { return "HybridHostFence"; }
 };
+#endif
 
 class HostBarrier : public galois::substrate::Barrier {
 public:
@@ -105,6 +276,26 @@ galois::substrate::Barrier& galois::runtime::getHostBarrier() {
 }
 
 galois::substrate::Barrier& galois::runtime::getHostFence() {
-  static HostFence b;
-  return b;
+  static galois::substrate::Barrier* b = []() -> galois::substrate::Barrier* {
+    static LinearHostFence linear;
+    static DisseminationHostFence dissemination;
+    std::string kind;
+    if (!galois::substrate::EnvCheck("GALOIS_HOST_FENCE", kind) ||
+        kind == "dissemination") {
+      return &dissemination;
+    } else if (kind == "linear") {
+      return &linear;
+    } else if (kind == "hybrid") {
+#ifndef GALOIS_USE_LWCI
+      static HybridHostFence hybrid;
+      return &hybrid;
+#else
+      return &dissemination;
+#endif
+    }
+    GALOIS_DIE("unknown GALOIS_HOST_FENCE ", kind,
+               "; use dissemination, hybrid, or linear");
+    return nullptr;
+  }();
+  return *b;
 }
@@ -0,0 +1,126 @@
+/*
+ * This file belongs to the Galois project, a C++ library for exploiting parallelism.
+ * The code is being released under the terms of the 3-Clause BSD License (a
+ * copy is located in LICENSE.txt at the top-level directory).
+ *
+ * Copyright (C) 2018, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ */
+
+
+/**
+ * @file CompactG2LMap.cpp
+ *
+ * Construction of the sorted-array global to local id maps.
+ */
+
+#include "galois/graphs/CompactG2LMap.h"
+#include "galois/Galois.h"
+#include "galois/Reduction.h"
+
+#include <algorithm>
+#include <utility>
+
+void galois::graphs::CompactG2LMap::build(G2LMapKind kind,
+                                          const std::vector<uint64_t>& l2g,
+                                          uint32_t masters,
+                                          uint64_t numGlobalNodes) {
+  clear();
+
+  // masters are mapped arithmetically only if their ids are consecutive
+  masters = std::min<size_t>(masters, l2g.size());
+  galois::GReduceLogicalAND consecutive;
+  galois::do_all(galois::iterate((uint32_t)0, masters),
+                 [&](uint32_t i) { consecutive.update(l2g[i] == l2g[0] + i); },
+                 galois::no_stats());
+  if (masters > 0 && consecutive.reduce()) {
+    masterGIDBegin = l2g[0];
+    numMasters     = masters;
+  }
+
+  size_t numKeys = l2g.size() - numMasters;
+  if (numKeys == 0) {
+    return;
+  }
+
+  // buckets by the high bits of the id with about 4 keys each: small enough
+  // to search in a cache line or two, large enough that the bucket offsets
+  // cost about a byte per mirror
+  unsigned idBits = 1;
+  while (idBits < 64 && (numGlobalNodes - 1) >> idBits) {
+    ++idBits;
+  }
+  unsigned keyBits = 1;
+  while (keyBits < 32 && (numKeys >> keyBits)) {
+    ++keyBits;
+  }
+  unsigned radixBits = std::min(keyBits > 3 ? keyBits - 2 : 1u, idBits);
+  bucketShift        = idBits - radixBits;
+
+  // counting sort into buckets, then sort each bucket
+  std::vector<uint32_t> offsets(((numGlobalNodes - 1) >> bucketShift) + 2, 0);
+  for (size_t i = numMasters; i < l2g.size(); ++i) {
+    ++offsets[(l2g[i] >> bucketShift) + 1];
+  }
+  for (size_t b = 1; b < offsets.size(); ++b) {
+    offsets[b] += offsets[b - 1];
+  }
+  std::vector<std::pair<uint64_t, uint32_t>> sorted(numKeys);
+  {
+    std::vector<uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+    for (size_t i = numMasters; i < l2g.size(); ++i) {
+      sorted[cursor[l2g[i] >> bucketShift]++] =
+          std::make_pair(l2g[i], (uint32_t)i);
+    }
+  }
+  galois::do_all(galois::iterate((size_t)0, offsets.size() - 1),
+                 [&](size_t b) {
+                   std::sort(sorted.begin() + offsets[b],
+                             sorted.begin() + offsets[b + 1]);
+                 },
+                 galois::steal(), galois::no_stats());
+
+  const bool wide = numGlobalNodes > (uint64_t(1) << 32);
+  lids.resize(numKeys);
+  if (wide) {
+    keys64.resize(numKeys);
+  } else {
+    keys32.resize(numKeys);
+  }
+  galois::do_all(galois::iterate((size_t)0, numKeys),
+                 [&](size_t i) {
+                   if (wide) {
+                     keys64[i] = sorted[i].first;
+                   } else {
+                     keys32[i] = sorted[i].first;
+                   }
+                   lids[i] = sorted[i].second;
+                 },
+                 galois::no_stats());
+
+  if (kind == radixG2L) {
+    buckets.swap(offsets);
+  } else {
+    bucketShift = 0;
+  }
+}
+
+void galois::graphs::CompactG2LMap::clear() {
+  masterGIDBegin = 0;
+  numMasters     = 0;
+  bucketShift    = 0;
+  std::vector<uint32_t>().swap(keys32);
+  std::vector<uint64_t>().swap(keys64);
+  std::vector<uint32_t>().swap(lids);
+  std::vector<uint32_t>().swap(buckets);
+}
@@ -31,10 +31,12 @@
 galois::DistMemSys::DistMemSys(void)
     : galois::runtime::SharedMemRuntime<galois::runtime::DistStatManager>() {}
 
-//! DistMemSys destructor which reports memory usage from the network
+//! DistMemSys destructor which reports memory usage and message aggregation
+//! statistics from the network
 galois::DistMemSys::~DistMemSys(void) {
   if (MORE_DIST_STATS) {
     auto& net = galois::runtime::getSystemNetworkInterface();
     net.reportMemUsage();
+    net.reportExtraStats();
   }
 }
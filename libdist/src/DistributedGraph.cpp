@@ -54,6 +54,8 @@ cll::opt<DataCommMode> enforce_metadata(
                 clEnumValN(onlyData, "none",
                            "Do not use any metadata (sends "
                            "non-updated values)"),
+                clEnumValN(runLengthData, "runlength",
+                           "Use run-length encoded offsets metadata always"),
                 //clEnumValN(neverOnlyData, "neverOnlyData",
                 //           "Never send onlyData"),
                 clEnumValEnd),
@@ -63,6 +65,35 @@ cll::opt<DataCommMode> enforce_metadata(
 //! the GPU.
 DataCommMode enforce_data_mode;
 
+//! Command line definition for syncPipelineChunk
+cll::opt<unsigned>
+    syncPipelineChunk("syncPipelineChunk",
+                      cll::desc("Number of shared nodes per message when "
+                                "pipelining sync (0 disables pipelining)"),
+                      cll::init(0), cll::Hidden);
+
+//! Command line definition for syncCompressMin
+cll::opt<unsigned>
+    syncCompressMin("syncCompressMin",
+                    cll::desc("Block-compress sync messages of at least this "
+                              "many bytes (0 disables compression)"),
+                    cll::init(0), cll::Hidden);
+
+//! Command line definition for syncMemoRounds
+cll::opt<unsigned>
+    syncMemoRounds("syncMemoRounds",
+                   cll::desc("Number of rounds an all-data sync of a loop is "
+                             "sent as raw values before its data mode is "
+                             "checked again (0 disables memoization)"),
+                   cll::init(0), cll::Hidden);
+
+//! Command line definition for syncNumaApply
+cll::opt<bool>
+    syncNumaApply("syncNumaApply",
+                  cll::desc("Apply received sync data with the threads of the "
+                            "socket that holds the data of the nodes"),
+                  cll::init(false), cll::Hidden);
+
 //! Command line definition for masters_distribution
 cll::opt<MASTERS_DISTRIBUTION> masters_distribution(
     "balanceMasters", cll::desc("Type of masters distribution."),
@@ -120,3 +151,34 @@ cll::opt<unsigned>
                              cll::desc("Buffer size for batching edges to "
                                        "send during partitioning."),
                              cll::init(32000), cll::Hidden);
+
+//! Command line definition for streamPartition
+cll::opt<bool>
+    streamPartition("streamPartition",
+                    cll::desc("Partition with the generic partitioners "
+                              "(gcvc, ghivc, goec) in a single streaming "
+                              "pass over the input"),
+                    cll::init(false));
+
+//! Command line definition for partitionCacheDir
+cll::opt<std::string>
+    partitionCacheDir("partitionCache",
+                      cll::desc("Directory of the on-disk partition cache: "
+                                "load the local partition from it if it "
+                                "matches the input, policy, and host count, "
+                                "else partition and save it there"),
+                      cll::init(""));
+
+//! Command line definition for g2lMap
+cll::opt<galois::graphs::G2LMapKind> g2lMap(
+    "g2lMap",
+    cll::desc("Global to local id map used by the generic partitioners "
+              "(gcvc, ghivc, goec):"),
+    cll::values(clEnumValN(galois::graphs::hashG2L, "hash",
+                           "Hash map of every node (default)"),
+                clEnumValN(galois::graphs::sortedG2L, "sorted",
+                           "Sorted mirror ids with interpolation search"),
+                clEnumValN(galois::graphs::radixG2L, "radix",
+                           "Sorted mirror ids in buckets by high id bits"),
+                clEnumValEnd),
+    cll::init(galois::graphs::hashG2L));
@@ -55,7 +55,8 @@ void NetworkInterface::initializeMPI() {
   }
 }
 
-NetworkInterface::NetworkInterface() {}
+NetworkInterface::NetworkInterface()
+    : landingPadSends(0), landingPadRecvs(0) {}
 
 NetworkInterface::~NetworkInterface() {}
 
@@ -67,6 +68,13 @@ void NetworkInterface::reportMemUsage() const {
                                    memUsageTracker.getMaxMemUsage());
 }
 
+void NetworkInterface::reportExtraStats() const {
+  for (auto& stat : reportExtraNamed()) {
+    galois::runtime::reportStat_Tsum("dGraph", "Comm" + stat.first,
+                                     stat.second);
+  }
+}
+
 // forward decl
 //! Receive broadcasted messages over the network
 static void bcastLandingPad(uint32_t src, ::RecvBuffer& buf);
@@ -83,6 +91,7 @@ void NetworkInterface::sendMsg(uint32_t dest,
                                void (*recv)(uint32_t, RecvBuffer&),
                                SendBuffer& buf) {
   gSerialize(buf, recv);
+  ++landingPadSends;
   sendTagged(dest, 0, buf);
 }
 
@@ -94,6 +103,7 @@ void NetworkInterface::broadcast(void (*recv)(uint32_t, RecvBuffer&),
     if (x != ID) {
       SendBuffer b;
       gSerialize(b, fp, buf, (uintptr_t)&bcastLandingPad);
+      ++landingPadSends;
       sendTagged(x, 0, b);
     } else if (self) {
       RecvBuffer rb(buf.begin(), buf.end());
@@ -114,6 +124,7 @@ void NetworkInterface::handleReceives() {
     assert(fp);
     auto f = (void (*)(uint32_t, RecvBuffer&))fp;
     f(src, buf);
+    ++landingPadRecvs;
     opt = recieveTagged(0, &lg);
   }
 }
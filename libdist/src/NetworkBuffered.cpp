@@ -29,6 +29,7 @@
 #include "galois/runtime/Network.h"
 #include "galois/runtime/NetworkIO.h"
 #include "galois/runtime/Tracer.h"
+#include "galois/substrate/EnvCheck.h"
 
 #ifdef GALOIS_USE_LWCI
 #define NO_AGG
@@ -38,6 +39,8 @@
 #include <mutex>
 #include <iostream>
 #include <limits>
+#include <array>
+#include <algorithm>
 
 using namespace galois::runtime;
 using namespace galois::substrate;
@@ -48,35 +51,105 @@ namespace {
  * @class NetworkInterfaceBuffered
  *
  * Buffered network interface: messages are buffered before they are sent out.
- * A single worker thread is initialized to send/receive messages from/to
- * buffers.
+ * Worker threads send/receive messages from/to buffers; each owns the
+ * buffers of a subset of the hosts. The number of worker threads is taken
+ * from the GALOIS_NETWORK_THREADS environment variable (default 1); more
+ * than one requires the MPI IO layer.
  */
 class NetworkInterfaceBuffered : public NetworkInterface {
   static const int COMM_MIN =
       1400; //! bytes (sligtly smaller than an ethernet packet)
-  static const int COMM_DELAY = 100; //! microseconds delay
+  static const int COMM_MAX = 1 << 16; //! bytes; larger batches are sent out
+  static const int COMM_DELAY = 100; //! default microseconds delay
+  static const int HIST_BUCKETS = 32; //! log2 buckets of the histograms
+
+  //! microseconds a message may wait to be aggregated (GALOIS_NETWORK_DELAY)
+  int commDelay;
 
   unsigned long statSendNum;
   unsigned long statSendBytes;
-  unsigned long statSendEnqueued;
+  std::atomic<unsigned long> statSendEnqueued;
   unsigned long statRecvNum;
   unsigned long statRecvBytes;
-  unsigned long statRecvDequeued;
+  std::atomic<unsigned long> statRecvDequeued;
   bool anyReceivedMessages;
 
   //using vTy = std::vector<uint8_t>;
   using vTy = galois::PODResizeableArray<uint8_t>;
 
+  /**
+   * Lock-free queue of received messages with a single producer (the worker
+   * thread owning the host) and a single consumer (the holder of the
+   * host's receive lock).
+   */
+  class incomingQueue {
+    struct node {
+      std::atomic<node*> next;
+      NetworkIO::message m;
+      node() : next(nullptr) {}
+    };
+
+    //! consumer side: already consumed node whose successor is next
+    node* head;
+    //! producer side: last node
+    node* tail;
+
+  public:
+    incomingQueue() : head(new node), tail(head) {}
+
+    ~incomingQueue() {
+      while (head) {
+        node* next = head->next.load(std::memory_order_relaxed);
+        delete head;
+        head = next;
+      }
+    }
+
+    void push(NetworkIO::message m) {
+      node* n = new node;
+      n->m    = std::move(m);
+      tail->next.store(n, std::memory_order_release);
+      tail = n;
+    }
+
+    bool pop(NetworkIO::message& m) {
+      node* next = head->next.load(std::memory_order_acquire);
+      if (!next)
+        return false;
+      m = std::move(next->m);
+      delete head;
+      head = next;
+      return true;
+    }
+  };
+
   /**
    * Receive buffers for the buffered network interface
    */
   class recvBuffer {
+    //! messages moved out of incoming by the consumer
     std::deque<NetworkIO::message> data;
     size_t frontOffset;
-    SimpleLock qlock;
+    incomingQueue incoming;
+    //! number of messages in incoming
+    std::atomic<size_t> incomingCount;
     // tag of head of queue
     std::atomic<uint32_t> dataPresent;
 
+    //! Moves the messages added by the worker thread to data
+    void drainIncoming() {
+      NetworkIO::message m;
+      size_t moved = 0;
+      while (incoming.pop(m)) {
+        data.push_back(std::move(m));
+        ++moved;
+      }
+      if (moved) {
+        incomingCount -= moved;
+        dataPresent = data.front().tag;
+      }
+    }
+
     bool sizeAtLeast(size_t n, uint32_t tag) {
       size_t tot = -frontOffset;
       for (auto& v : data) {
@@ -91,22 +164,16 @@ class NetworkInterfaceBuffered : public NetworkInterface {
       return false;
     }
 
-    template <typename IterTy>
-    void copyOut(IterTy it, size_t n) {
+    void copyOut(uint8_t* out, size_t n) {
       // assert(sizeAtLeast(n));
-      // fast path is first buffer
-      { // limit scope
-        auto& f0data = data[0].data;
-        for (int k = frontOffset, ke = f0data.size(); k < ke && n; ++k, --n)
-          *it++ = f0data[k];
-      }
-      if (n) { // more data (slow path)
-        for (int j = 1, je = data.size(); j < je && n; ++j) {
-          auto& vdata = data[j].data;
-          for (int k = 0, ke = vdata.size(); k < ke && n; ++k, --n) {
-            *it++ = vdata[k];
-          }
-        }
+      size_t offset = frontOffset;
+      for (size_t j = 0, je = data.size(); j < je && n; ++j) {
+        auto& vdata  = data[j].data;
+        size_t chunk = std::min(n, vdata.size() - offset);
+        std::memcpy(out, vdata.data() + offset, chunk);
+        out += chunk;
+        n -= chunk;
+        offset = 0;
       }
     }
 
@@ -159,8 +226,10 @@ class NetworkInterfaceBuffered : public NetworkInterface {
     }
 
   public:
+    recvBuffer() : frontOffset(0), incomingCount(0), dataPresent(~0) {}
+
     optional_t<RecvBuffer> popMsg(uint32_t tag, std::atomic<size_t>& inflightRecvs) {
-      std::lock_guard<SimpleLock> lg(qlock);
+      drainIncoming();
 #ifndef NO_AGG
       uint32_t len = getLenFromFront(tag);
       //      assert(len);
@@ -179,8 +248,7 @@ class NetworkInterfaceBuffered : public NetworkInterface {
       }
 
       RecvBuffer buf(len);
-      // FIXME: This is slows things down 25%
-      copyOut((char*)buf.linearData(), len);
+      copyOut((uint8_t*)buf.linearData(), len);
       erase(len, inflightRecvs);
       // std::cerr << "p " << tag << " " << len << "\n";
       return optional_t<RecvBuffer>(std::move(buf));
@@ -204,31 +272,19 @@ class NetworkInterfaceBuffered : public NetworkInterface {
 
     // Worker thread interface
     void add(NetworkIO::message m) {
-      std::lock_guard<SimpleLock> lg(qlock);
-      if (data.empty()) {
-        galois::runtime::trace("ADD LATEST ", m.tag);
-        dataPresent = m.tag;
-      }
-
-      // std::cerr << m.data.size() << " " <<
-      //              std::count(m.data.begin(), m.data.end(), 0) << "\n";
-      // for (auto x : m.data) {
-      //   std::cerr << (int) x << " ";
-      // }
-      // std::cerr << "\n";
-      // std::cerr << "A " << m.host << " " << m.tag << " " << m.data.size() <<
-      // "\n";
-
-      data.push_back(std::move(m));
-
-      assert(data.back().data.size() !=
-             (unsigned int)std::count(data.back().data.begin(),
-                                      data.back().data.end(), 0));
+      assert(m.data.size() !=
+             (unsigned int)std::count(m.data.begin(), m.data.end(), 0));
+      galois::runtime::trace("ADD LATEST ", m.tag);
+      incoming.push(std::move(m));
+      ++incomingCount;
     }
 
-    bool hasData(uint32_t tag) { return dataPresent == tag; }
-
-    size_t size() { return data.size(); }
+    //! True if a message with the tag may be at the head of the queue: the
+    //! head of data has the tag, or data is empty and messages came in
+    bool hasData(uint32_t tag) {
+      uint32_t present = dataPresent;
+      return present == tag || (present == ~0U && incomingCount > 0);
+    }
 
     uint32_t getPresentTag() { return dataPresent; }
   }; // end recv buffer class
@@ -253,11 +309,54 @@ class NetworkInterfaceBuffered : public NetworkInterface {
     //! @todo FIXME track time since some epoch in an atomic.
     std::chrono::high_resolution_clock::time_point time;
     SimpleLock lock, timelock;
+    //! moving average of the bytes per microsecond added to this buffer
+    double injectionRate;
+    //! bytes from which the buffer is sent out without waiting
+    size_t batchSize;
+
+    //! Index of the log2 bucket of a value
+    static unsigned bucket(uint64_t v) {
+      unsigned b = 0;
+      while (v > 1 && b + 1 < HIST_BUCKETS) {
+        v >>= 1;
+        ++b;
+      }
+      return b;
+    }
+
+    /**
+     * Updates the injection rate with a batch of len bytes that took
+     * elapsed microseconds to collect, and sizes the next batch to what is
+     * expected to arrive within the aggregation delay.
+     */
+    void adapt(size_t len, uint64_t elapsed, int commDelay) {
+      double rate  = (double)len / std::max<uint64_t>(elapsed, 1);
+      injectionRate = injectionRate ? 0.75 * injectionRate + 0.25 * rate : rate;
+      batchSize = std::min<size_t>(
+          std::max<size_t>(injectionRate * commDelay, COMM_MIN), COMM_MAX);
+    }
+
+    //! a bulk message is sent without being copied into an aggregate
+    static bool isBulk(size_t size) {
+      return size >= COMM_MAX &&
+             size < (size_t)std::numeric_limits<int>::max() - sizeof(uint32_t);
+    }
 
   public:
     unsigned long statSendTimeout;
     unsigned long statSendOverflow;
     unsigned long statSendUrgent;
+    unsigned long statSendBulk;
+    unsigned long statSendZeroCopy;
+    //! histogram of the sizes of the messages sent out (log2 bytes)
+    std::array<unsigned long, HIST_BUCKETS> sizeHist;
+    //! histogram of how long messages were queued (log2 microseconds)
+    std::array<unsigned long, HIST_BUCKETS> delayHist;
+
+    sendBuffer()
+        : numBytes(0), urgent(0), injectionRate(0), batchSize(COMM_MIN),
+          statSendTimeout(0), statSendOverflow(0), statSendUrgent(0),
+          statSendBulk(0), statSendZeroCopy(0), sizeHist(), delayHist() {}
 
     size_t size() { return messages.size(); }
 
@@ -268,7 +367,7 @@ class NetworkInterfaceBuffered : public NetworkInterface {
       }
     }
 
-    bool ready() {
+    bool ready(int commDelay) {
 #ifndef NO_AGG
       if (numBytes == 0)
         return false;
@@ -276,7 +375,7 @@ class NetworkInterfaceBuffered : public NetworkInterface {
         ++statSendUrgent;
         return true;
       }
-      if (numBytes > COMM_MIN) {
+      if (numBytes > batchSize) {
         ++statSendOverflow;
         return true;
       }
@@ -288,7 +387,7 @@ class NetworkInterfaceBuffered : public NetworkInterface {
       }
       auto elapsed =
           std::chrono::duration_cast<std::chrono::microseconds>(n - mytime);
-      if (elapsed.count() > COMM_DELAY) {
+      if (elapsed.count() > commDelay) {
         ++statSendTimeout;
         return true;
       }
@@ -298,17 +397,54 @@ class NetworkInterfaceBuffered : public NetworkInterface {
 #endif
     }
 
-    std::pair<uint32_t, vTy> assemble(std::atomic<size_t>& inflightSends) {
+    /**
+     * Moves the messages at the front of the buffer into one message to
+     * send out. Every message is prefixed with its length. A bulk message
+     * (see add) is sent by itself with the length as the header of the
+     * outgoing message, so that it is not copied; aggregation stops in
+     * front of one.
+     */
+    NetworkIO::message assemble(std::atomic<size_t>& inflightSends,
+                                int commDelay) {
+      NetworkIO::message out;
       std::unique_lock<SimpleLock> lg(lock);
       if (messages.empty())
-        return std::make_pair(~0, vTy());
+        return out;
+      uint64_t elapsed;
+      {
+        std::lock_guard<SimpleLock> lgt(timelock);
+        elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+                      std::chrono::high_resolution_clock::now() - time)
+                      .count();
+      }
 #ifndef NO_AGG
+      uint32_t tag = messages.front().tag;
+      out.tag      = tag;
+      if (isBulk(messages.front().data.size())) {
+        uint32_t len = messages.front().data.size();
+        out.header.insert(out.header.end(), (uint8_t*)&len,
+                          (uint8_t*)&len + sizeof(uint32_t));
+        out.data = std::move(messages.front().data);
+        messages.pop_front();
+        if (urgent)
+          --urgent;
+        numBytes -= len;
+        if (!messages.empty()) {
+          std::lock_guard<SimpleLock> lgt(timelock);
+          time = std::chrono::high_resolution_clock::now();
+        }
+        ++statSendZeroCopy;
+        ++sizeHist[bucket(len + sizeof(uint32_t))];
+        ++delayHist[bucket(elapsed)];
+        return out;
+      }
+
       // compute message size
       uint32_t len = 0;
       int num      = 0;
-      uint32_t tag = messages.front().tag;
       for (auto& m : messages) {
-        if (m.tag != tag) {
+        // a bulk message goes out by itself next time
+        if (m.tag != tag || isBulk(m.data.size())) {
           break;
         } else {
           // do not let it go over the integer limit because MPI_Isend cannot
@@ -345,12 +481,21 @@ class NetworkInterfaceBuffered : public NetworkInterface {
       } while (vec.size() < len + num);
       ++inflightSends;
       numBytes -= len;
+      // restart the delay for the messages left behind
+      if (!messages.empty()) {
+        std::lock_guard<SimpleLock> lgt(timelock);
+        time = std::chrono::high_resolution_clock::now();
+      }
+      adapt(len, elapsed, commDelay);
+      out.data = std::move(vec);
 #else
-      uint32_t tag = messages.front().tag;
-      vTy vec(std::move(messages.front().data));
+      out.tag  = messages.front().tag;
+      out.data = std::move(messages.front().data);
       messages.pop_front();
 #endif
-      return std::make_pair(tag, std::move(vec));
+      ++sizeHist[bucket(out.data.size())];
+      ++delayHist[bucket(elapsed)];
+      return out;
     }
 
     void add(uint32_t tag, vTy& b) {
@@ -363,19 +508,66 @@ class NetworkInterfaceBuffered : public NetworkInterface {
       numBytes += b.size();
       galois::runtime::trace("BufferedAdd", oldNumBytes, numBytes, tag,
                              galois::runtime::printVec(b));
+      // bulk payloads gain nothing from waiting to be aggregated
+      if (isBulk(b.size())) {
+        ++statSendBulk;
+        urgent = messages.size() + 1;
+      }
       messages.emplace_back(tag, b);
     }
   }; // end send buffer class
 
   std::vector<sendBuffer> sendData;
 
+  //! IO layer of each worker thread
+  std::vector<std::unique_ptr<galois::runtime::NetworkIO>> netios;
+  //! number of worker threads; worker t owns the hosts h with h % num == t
+  unsigned numCommThreads;
+
+  /**
+   * Sends out the ready send buffers of the hosts owned by a worker thread
+   * and moves the messages it received to the receive buffers.
+   *
+   * @param t worker thread id
+   */
+  void commLoop(unsigned t) {
+    auto& io = *netios[t];
+    while (ready < 2) { /*fprintf(stderr, "[WaitOnReady-2]");*/
+    };
+    while (ready != 3) {
+      for (unsigned i = t; i < sendData.size(); i += numCommThreads) {
+        io.progress();
+        // handle send queue i
+        auto& sd = sendData[i];
+        if (sd.ready(commDelay)) {
+          NetworkIO::message msg = sd.assemble(inflightSends, commDelay);
+          msg.host               = i;
+          galois::runtime::trace("BufferedSending", msg.host, msg.tag,
+                                 galois::runtime::printVec(msg.data));
+          ++statSendEnqueued;
+          io.enqueue(std::move(msg));
+        }
+        // handle receive
+        NetworkIO::message rdata = io.dequeue();
+        if (rdata.data.size()) {
+          ++statRecvDequeued;
+          galois::runtime::trace("BufferedRecieving", rdata.host, rdata.tag,
+                                 galois::runtime::printVec(rdata.data));
+          recvData[rdata.host].add(std::move(rdata));
+        }
+      }
+    }
+  }
+
   void workerThread() {
+    std::unique_ptr<NetworkIO> netio;
 // Initialize LWCI or MPI depending on what was defined in CMake
 #ifdef GALOIS_USE_LWCI
     // Initialize LWCI
     std::tie(netio, ID, Num) = makeNetworkIOLWCI(memUsageTracker, inflightSends, inflightRecvs);
     if (ID == 0)
       fprintf(stderr, "**Using LWCI Communication layer**\n");
+    numCommThreads = 1;
 #else
     initializeMPI();
     int rank;
@@ -392,45 +584,50 @@ class NetworkInterfaceBuffered : public NetworkInterface {
     }
 
     galois::gDebug("[", NetworkInterface::ID, "] MPI initialized");
-    std::tie(netio, ID, Num) = makeNetworkIOMPI(memUsageTracker, inflightSends, inflightRecvs);
+    int requestedThreads = 1;
+    EnvCheck("GALOIS_NETWORK_THREADS", requestedThreads);
+
+    numCommThreads = std::min<unsigned>(std::max(requestedThreads, 1),
+                                        hostSize);
+
+    if (EnvCheck("GALOIS_NETWORK_SHM")) {
+      std::tie(netio, ID, Num) = makeNetworkIOSHM(memUsageTracker, inflightSends, inflightRecvs);
+      if (ID == 0)
+        fprintf(stderr, "**Using shared memory communication layer**\n");
+      numCommThreads = 1;
+    } else if (numCommThreads == 1) {
+      std::tie(netio, ID, Num) = makeNetworkIOMPI(memUsageTracker, inflightSends, inflightRecvs);
+    } else {
+      // one IO layer per worker thread, each receiving from its own hosts
+      for (unsigned t = 0; t < numCommThreads; ++t) {
+        std::vector<uint32_t> sources;
+        for (unsigned h = t; h < (unsigned)hostSize; h += numCommThreads) {
+          sources.push_back(h);
+        }
+        std::unique_ptr<NetworkIO> io;
+        std::tie(io, ID, Num) = makeNetworkIOMPI(
+            memUsageTracker, inflightSends, inflightRecvs, sources);
+        netios.push_back(std::move(io));
+      }
+      if (ID == 0)
+        fprintf(stderr, "**Using %u communication threads**\n",
+                numCommThreads);
+    }
 #endif
+    if (netio) {
+      netios.push_back(std::move(netio));
+    }
 
     assert(ID == (unsigned)rank);
     assert(Num == (unsigned)hostSize);
 
     ready = 1;
-    while (ready < 2) { /*fprintf(stderr, "[WaitOnReady-2]");*/
-    };
-    while (ready != 3) {
-      for (unsigned i = 0; i < sendData.size(); ++i) {
-        netio->progress();
-        // handle send queue i
-        auto& sd = sendData[i];
-        if (sd.ready()) {
-          NetworkIO::message msg;
-          msg.host                    = i;
-          std::tie(msg.tag, msg.data) = sd.assemble(inflightSends);
-          galois::runtime::trace("BufferedSending", msg.host, msg.tag,
-                                 galois::runtime::printVec(msg.data));
-          ++statSendEnqueued;
-          netio->enqueue(std::move(msg));
-        }
-        // handle receive
-        NetworkIO::message rdata = netio->dequeue();
-        if (rdata.data.size()) {
-          ++statRecvDequeued;
-          assert(rdata.data.size() !=
-                 (unsigned int)std::count(rdata.data.begin(), rdata.data.end(),
-                                          0));
-          galois::runtime::trace("BufferedRecieving", rdata.host, rdata.tag,
-                                 galois::runtime::printVec(rdata.data));
-          recvData[rdata.host].add(std::move(rdata));
-        }
-      }
-    }
+    commLoop(0);
   }
 
   std::thread worker;
+  //! worker threads other than the first one
+  std::vector<std::thread> extraWorkers;
   std::atomic<int> ready;
 
 public:
@@ -440,6 +637,10 @@ public:
   NetworkInterfaceBuffered() {
     inflightSends = 0;
     inflightRecvs = 0;
+    statSendEnqueued = 0;
+    statRecvDequeued = 0;
+    commDelay        = COMM_DELAY;
+    EnvCheck("GALOIS_NETWORK_DELAY", commDelay);
     ready  = 0;
     anyReceivedMessages = false;
     worker = std::thread(&NetworkInterfaceBuffered::workerThread, this);
@@ -448,12 +649,18 @@ public:
     recvData = decltype(recvData)(Num);
     recvLock.resize(Num);
     sendData = decltype(sendData)(Num);
+    for (unsigned t = 1; t < numCommThreads; ++t) {
+      extraWorkers.emplace_back(&NetworkInterfaceBuffered::commLoop, this, t);
+    }
     ready    = 2;
   }
 
   virtual ~NetworkInterfaceBuffered() {
     ready = 3;
     worker.join();
+    for (auto& w : extraWorkers) {
+      w.join();
+    }
 
 // disable MPI if LWCI wasn't used
 #ifndef GALOIS_USE_LWCI
@@ -467,8 +674,6 @@ public:
 #endif
   }
 
-  std::unique_ptr<galois::runtime::NetworkIO> netio;
-
   virtual void sendTagged(uint32_t dest, uint32_t tag, SendBuffer& buf) {
     ++inflightSends;
     statSendNum += 1;
@@ -553,32 +758,55 @@ public:
   virtual unsigned long reportRecvMsgs() const { return statRecvNum; }
 
   virtual std::vector<unsigned long> reportExtra() const {
-    std::vector<unsigned long> retval(5);
+    std::vector<unsigned long> retval(7);
     for (auto& sd : sendData) {
       retval[0] += sd.statSendTimeout;
       retval[1] += sd.statSendOverflow;
       retval[2] += sd.statSendUrgent;
+      retval[5] += sd.statSendBulk;
+      retval[6] += sd.statSendZeroCopy;
     }
     retval[3] = statSendEnqueued;
     retval[4] = statRecvDequeued;
     return retval;
   }
 
+  /**
+   * Besides the counters of reportExtra, reports the non-empty buckets of
+   * the per-host histograms of sent message sizes (SendSizeHist_<host>_<at
+   * least bytes>) and queueing delays (SendDelayHist_<host>_<at least us>).
+   */
   virtual std::vector<std::pair<std::string, unsigned long>>
   reportExtraNamed() const {
-    std::vector<std::pair<std::string, unsigned long>> retval(5);
+    std::vector<std::pair<std::string, unsigned long>> retval(7);
     retval[0].first = "SendTimeout";
     retval[1].first = "SendOverflow";
     retval[2].first = "SendUrgent";
     retval[3].first = "SendEnqueued";
     retval[4].first = "RecvDequeued";
+    retval[5].first = "SendBulk";
+    retval[6].first = "SendZeroCopy";
     for (auto& sd : sendData) {
       retval[0].second += sd.statSendTimeout;
       retval[1].second += sd.statSendOverflow;
       retval[2].second += sd.statSendUrgent;
+      retval[5].second += sd.statSendBulk;
+      retval[6].second += sd.statSendZeroCopy;
     }
     retval[3].second = statSendEnqueued;
     retval[4].second = statRecvDequeued;
+
+    for (unsigned h = 0; h < sendData.size(); ++h) {
+      auto& sd = sendData[h];
+      for (unsigned b = 0; b < HIST_BUCKETS; ++b) {
+        std::string suffix =
+            std::to_string(h) + "_" + std::to_string(b ? 1UL << b : 0UL);
+        if (sd.sizeHist[b])
+          retval.emplace_back("SendSizeHist_" + suffix, sd.sizeHist[b]);
+        if (sd.delayHist[b])
+          retval.emplace_back("SendDelayHist_" + suffix, sd.delayHist[b]);
+      }
+    }
     return retval;
   }
 };
@@ -116,6 +116,7 @@ public:
   ~NetworkIOLWCI() { lc_close(mv); }
 
   virtual void enqueue(message m) {
+    m.flatten();
     memUsageTracker.incrementMemUsage(m.data.size());
     mpiMessage* f = new mpiMessage(m.host, m.tag, m.data);
     lc_info info  = {LC_SYNC_WAKE, LC_SYNC_NULL, {0, (int16_t)m.tag}};
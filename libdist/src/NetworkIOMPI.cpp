@@ -69,6 +69,7 @@ private:
     uint32_t host;
     uint32_t tag;
     vTy data;
+    vTy header;
     MPI_Request req;
     // mpiMessage(message&& _m, MPI_Request _req) : m(std::move(_m)), req(_req)
     // {}
@@ -100,7 +101,7 @@ private:
         int rv  = MPI_Test(&f.req, &flag, &status);
         handleError(rv);
         if (flag) {
-          memUsageTracker.decrementMemUsage(f.data.size());
+          memUsageTracker.decrementMemUsage(f.data.size() + f.header.size());
           inflight.pop_front();
           --inflightSends;
         } else
@@ -110,17 +111,39 @@ private:
 
     void send(message m) {
       inflight.emplace_back(m.host, m.tag, std::move(m.data));
-      auto& f = inflight.back();
+      auto& f  = inflight.back();
+      f.header = std::move(m.header);
       galois::runtime::trace("MPI SEND", f.host, f.tag, f.data.size(),
                              galois::runtime::printVec(f.data));
+
+      void* buf         = f.data.data();
+      int count         = f.data.size();
+      MPI_Datatype type = MPI_BYTE;
+      if (!f.header.empty()) {
+        // gather the header and the data into one message without staging
+        // them in one buffer
+        int lengths[2] = {(int)f.header.size(), (int)f.data.size()};
+        MPI_Aint displacements[2];
+        handleError(MPI_Get_address(f.header.data(), &displacements[0]));
+        handleError(MPI_Get_address(f.data.data(), &displacements[1]));
+        handleError(MPI_Type_create_hindexed(2, lengths, displacements,
+                                             MPI_BYTE, &type));
+        handleError(MPI_Type_commit(&type));
+        buf   = MPI_BOTTOM;
+        count = 1;
+      }
 #ifdef __GALOIS_HET_ASYNC__
-      int rv = MPI_Issend(f.data.data(), f.data.size(), MPI_BYTE, f.host, f.tag,
-                         MPI_COMM_WORLD, &f.req);
+      int rv = MPI_Issend(buf, count, type, f.host, f.tag, MPI_COMM_WORLD,
+                          &f.req);
 #else
-      int rv = MPI_Isend(f.data.data(), f.data.size(), MPI_BYTE, f.host, f.tag,
-                         MPI_COMM_WORLD, &f.req);
+      int rv = MPI_Isend(buf, count, type, f.host, f.tag, MPI_COMM_WORLD,
+                         &f.req);
 #endif
       handleError(rv);
+      if (type != MPI_BYTE) {
+        // freed once the send completes
+        handleError(MPI_Type_free(&type));
+      }
     }
   };
 
@@ -135,16 +158,28 @@ private:
 
     std::atomic<size_t>& inflightRecvs;
 
+    //! hosts to receive from (any host if empty)
+    std::vector<uint32_t> sources;
+    //! index of the source probed next
+    size_t nextSource;
+
     recvQueueTy(galois::runtime::MemUsageTracker& tracker,
-        std::atomic<size_t>& recvs)
-        : memUsageTracker(tracker), inflightRecvs(recvs) {}
+        std::atomic<size_t>& recvs, const std::vector<uint32_t>& _sources)
+        : memUsageTracker(tracker), inflightRecvs(recvs), sources(_sources),
+          nextSource(0) {}
 
     // FIXME: Does synchronous recieves overly halt forward progress?
     void probe() {
       int flag = 0;
       MPI_Status status;
-      // check for new messages
-      int rv = MPI_Iprobe(MPI_ANY_SOURCE, MPI_ANY_TAG, MPI_COMM_WORLD, &flag,
+      // check for new messages; a restricted set of sources is probed one
+      // source per call so that other IO layers keep theirs
+      int source = MPI_ANY_SOURCE;
+      if (!sources.empty()) {
+        source     = sources[nextSource];
+        nextSource = (nextSource + 1) % sources.size();
+      }
+      int rv = MPI_Iprobe(source, MPI_ANY_TAG, MPI_COMM_WORLD, &flag,
                           &status);
       handleError(rv);
       if (flag) {
@@ -191,14 +226,16 @@ public:
    * Constructor.
    *
    * @param tracker memory usage tracker
+   * @param sources hosts to receive from (any host if empty)
    * @param [out] ID this machine's host id
    * @param [out] NUM total number of hosts in the system
    */
   NetworkIOMPI(galois::runtime::MemUsageTracker& tracker, 
       std::atomic<size_t>& sends, std::atomic<size_t>& recvs, 
-      uint32_t& ID, uint32_t& NUM)
+      const std::vector<uint32_t>& sources, uint32_t& ID, uint32_t& NUM)
       : NetworkIO(tracker, sends, recvs),
-        sendQueue(tracker, inflightSends), recvQueue(tracker, inflightRecvs) {
+        sendQueue(tracker, inflightSends),
+        recvQueue(tracker, inflightRecvs, sources) {
     auto p = getIDAndHostNum();
     ID     = p.first;
     NUM    = p.second;
@@ -208,7 +245,7 @@ public:
    * Adds a message to the send queue
    */
   virtual void enqueue(message m) {
-    memUsageTracker.incrementMemUsage(m.data.size());
+    memUsageTracker.incrementMemUsage(m.data.size() + m.header.size());
     sendQueue.send(std::move(m));
   }
 
@@ -234,9 +271,10 @@ public:
 }; // end NetworkIOMPI class
 
 std::tuple<std::unique_ptr<galois::runtime::NetworkIO>, uint32_t, uint32_t>
-galois::runtime::makeNetworkIOMPI(galois::runtime::MemUsageTracker& tracker, std::atomic<size_t>& sends, std::atomic<size_t>& recvs) {
+galois::runtime::makeNetworkIOMPI(galois::runtime::MemUsageTracker& tracker, std::atomic<size_t>& sends, std::atomic<size_t>& recvs,
+                                  const std::vector<uint32_t>& sources) {
   uint32_t ID, NUM;
   std::unique_ptr<galois::runtime::NetworkIO> n{
-      new NetworkIOMPI(tracker, sends, recvs, ID, NUM)};
+      new NetworkIOMPI(tracker, sends, recvs, sources, ID, NUM)};
   return std::make_tuple(std::move(n), ID, NUM);
 }
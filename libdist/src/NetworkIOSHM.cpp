@@ -0,0 +1,326 @@
+/*
+ * This file belongs to the Galois project, a C++ library for exploiting parallelism.
+ * The code is being released under the terms of the 3-Clause BSD License (a
+ * copy is located in LICENSE.txt at the top-level directory).
+ *
+ * Copyright (C) 2018, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ */
+
+
+/**
+ * @file NetworkIOSHM.cpp
+ *
+ * Contains an implementation of network IO that uses POSIX shared memory
+ * between hosts running on the same machine.
+ */
+
+#include "galois/runtime/NetworkIO.h"
+#include "galois/runtime/Tracer.h"
+#include "galois/substrate/EnvCheck.h"
+#include "galois/gIO.h"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+
+#include <algorithm>
+#include <atomic>
+
+/**
+ * Shared memory implementation of network IO. Every host owns a segment
+ * holding one single-producer/single-consumer byte ring per sending host.
+ * A message is a (tag, length) header followed by its payload; since the
+ * rings are byte streams, messages larger than a ring are streamed through
+ * it while the receiver drains it.
+ *
+ * MPI is only used to bootstrap (host ids and segment names). ASSUMES THAT
+ * MPI IS INITIALIZED UPON CREATION OF THIS OBJECT.
+ */
+class NetworkIOSHM : public galois::runtime::NetworkIO {
+  //! Default size of each ring in MB; GALOIS_NETWORK_SHM_RING_MB overrides it
+  static constexpr int DEFAULT_RING_MB = 16;
+
+  struct Ring {
+    //! bytes consumed; written only by the receiver
+    alignas(64) std::atomic<uint64_t> head;
+    //! bytes produced; written only by the sender
+    alignas(64) std::atomic<uint64_t> tail;
+  };
+
+  struct Header {
+    uint32_t tag;
+    uint32_t pad;
+    uint64_t len;
+  };
+
+  struct Segment {
+    void* base = nullptr;
+    size_t len = 0;
+
+    Ring* ring(uint32_t i) { return static_cast<Ring*>(base) + i; }
+  };
+
+  //! Partially written outgoing messages to one host
+  struct sendQueueTy {
+    std::deque<message> pending;
+    Header header;
+    uint64_t written = 0; //!< bytes of header + payload already in the ring
+  };
+
+  //! Partially read incoming message from one host
+  struct recvStateTy {
+    Header header;
+    vTy data;
+    uint64_t read = 0; //!< bytes of header + payload already read
+  };
+
+  uint32_t ID;
+  uint32_t Num;
+  uint64_t capacity;
+  std::vector<Segment> segments;
+  std::vector<sendQueueTy> sendQueues;
+  std::vector<recvStateTy> recvStates;
+  std::deque<message> done;
+
+  static std::string segmentName(uint64_t job, uint32_t host) {
+    return "/galois-netio-" + std::to_string(job) + "-" +
+           std::to_string(host);
+  }
+
+  uint8_t* ringData(uint32_t owner, uint32_t sender) {
+    return static_cast<uint8_t*>(segments[owner].base) +
+           sizeof(Ring) * Num + capacity * sender;
+  }
+
+  //! Copies len bytes into ring position pos (mod capacity)
+  void copyIn(uint8_t* ring, uint64_t pos, const uint8_t* src, uint64_t len) {
+    uint64_t off   = pos % capacity;
+    uint64_t first = std::min(len, capacity - off);
+    std::memcpy(ring + off, src, first);
+    std::memcpy(ring, src + first, len - first);
+  }
+
+  //! Copies len bytes out of ring position pos (mod capacity)
+  void copyOut(uint8_t* dst, const uint8_t* ring, uint64_t pos, uint64_t len) {
+    uint64_t off   = pos % capacity;
+    uint64_t first = std::min(len, capacity - off);
+    std::memcpy(dst, ring + off, first);
+    std::memcpy(dst + first, ring, len - first);
+  }
+
+  void mapSegment(const std::string& name, bool create, Segment& seg) {
+    seg.len = (sizeof(Ring) + capacity) * Num;
+    int fd  = shm_open(name.c_str(), create ? O_CREAT | O_EXCL | O_RDWR : O_RDWR,
+                      S_IRUSR | S_IWUSR);
+    if (fd == -1)
+      GALOIS_SYS_DIE("failed opening shared memory segment ", name);
+    if (create && ftruncate(fd, seg.len) == -1)
+      GALOIS_SYS_DIE("failed sizing shared memory segment ", name);
+    seg.base = mmap(nullptr, seg.len, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (seg.base == MAP_FAILED)
+      GALOIS_SYS_DIE("failed mapping shared memory segment ", name);
+    close(fd);
+  }
+
+  /**
+   * Writes as much of the pending messages to host as fits in its ring.
+   */
+  void pushSends(uint32_t host) {
+    sendQueueTy& q = sendQueues[host];
+    Ring* r        = segments[host].ring(ID);
+    uint8_t* data  = ringData(host, ID);
+    uint64_t tail  = r->tail.load(std::memory_order_relaxed);
+
+    while (!q.pending.empty()) {
+      message& m     = q.pending.front();
+      uint64_t total = sizeof(Header) + m.data.size();
+      uint64_t space = capacity - (tail - r->head.load(std::memory_order_acquire));
+      if (!space)
+        break;
+
+      if (q.written < sizeof(Header)) {
+        q.header = Header{m.tag, 0, m.data.size()};
+        uint64_t n = std::min(space, sizeof(Header) - q.written);
+        copyIn(data, tail,
+               reinterpret_cast<const uint8_t*>(&q.header) + q.written, n);
+        q.written += n;
+        tail += n;
+        space -= n;
+      }
+      if (q.written >= sizeof(Header)) {
+        uint64_t off = q.written - sizeof(Header);
+        uint64_t n   = std::min(space, m.data.size() - off);
+        copyIn(data, tail, m.data.data() + off, n);
+        q.written += n;
+        tail += n;
+      }
+      r->tail.store(tail, std::memory_order_release);
+
+      if (q.written != total)
+        break;
+      memUsageTracker.decrementMemUsage(m.data.size());
+      --inflightSends;
+      q.pending.pop_front();
+      q.written = 0;
+    }
+  }
+
+  /**
+   * Reads whatever has arrived from host; completed messages go to done.
+   */
+  void pullRecvs(uint32_t host) {
+    recvStateTy& s = recvStates[host];
+    Ring* r        = segments[ID].ring(host);
+    uint8_t* data  = ringData(ID, host);
+    uint64_t head  = r->head.load(std::memory_order_relaxed);
+    uint64_t avail = r->tail.load(std::memory_order_acquire) - head;
+
+    while (avail) {
+      if (s.read < sizeof(Header)) {
+        uint64_t n = std::min(avail, sizeof(Header) - s.read);
+        copyOut(reinterpret_cast<uint8_t*>(&s.header) + s.read, data, head, n);
+        s.read += n;
+        head += n;
+        avail -= n;
+        if (s.read < sizeof(Header))
+          break;
+        ++inflightRecvs;
+        s.data = vTy(s.header.len);
+        memUsageTracker.incrementMemUsage(s.header.len);
+      }
+      uint64_t off = s.read - sizeof(Header);
+      uint64_t n   = std::min(avail, s.header.len - off);
+      copyOut(s.data.data() + off, data, head, n);
+      s.read += n;
+      head += n;
+      avail -= n;
+      if (s.read == sizeof(Header) + s.header.len) {
+        galois::runtime::trace("SHM RECV", host, s.header.tag, s.data.size());
+        done.emplace_back(host, s.header.tag, std::move(s.data));
+        s.read = 0;
+      }
+    }
+    r->head.store(head, std::memory_order_release);
+  }
+
+public:
+  /**
+   * Constructor. Creates this host's segment and maps every other host's.
+   *
+   * @param tracker memory usage tracker
+   * @param [out] _ID this machine's host id
+   * @param [out] _NUM total number of hosts in the system
+   */
+  NetworkIOSHM(galois::runtime::MemUsageTracker& tracker,
+               std::atomic<size_t>& sends, std::atomic<size_t>& recvs,
+               uint32_t& _ID, uint32_t& _NUM)
+      : NetworkIO(tracker, sends, recvs) {
+    int rank, size;
+    handleError(MPI_Comm_rank(MPI_COMM_WORLD, &rank));
+    handleError(MPI_Comm_size(MPI_COMM_WORLD, &size));
+    ID = _ID = rank;
+    Num = _NUM = size;
+
+    MPI_Comm local;
+    int localSize;
+    handleError(MPI_Comm_split_type(MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, 0,
+                                    MPI_INFO_NULL, &local));
+    handleError(MPI_Comm_size(local, &localSize));
+    handleError(MPI_Comm_free(&local));
+    if (localSize != size)
+      GALOIS_DIE("shared memory network IO needs all hosts on one machine");
+
+    int ringMB = DEFAULT_RING_MB;
+    galois::substrate::EnvCheck("GALOIS_NETWORK_SHM_RING_MB", ringMB);
+    capacity = static_cast<uint64_t>(std::max(ringMB, 1)) << 20;
+
+    // host 0's pid names the segments of this run
+    uint64_t job = getpid();
+    handleError(MPI_Bcast(&job, 1, MPI_UINT64_T, 0, MPI_COMM_WORLD));
+
+    segments.resize(Num);
+    mapSegment(segmentName(job, ID), true, segments[ID]);
+    handleError(MPI_Barrier(MPI_COMM_WORLD));
+    for (uint32_t h = 0; h < Num; ++h)
+      if (h != ID)
+        mapSegment(segmentName(job, h), false, segments[h]);
+    handleError(MPI_Barrier(MPI_COMM_WORLD));
+    // mappings stay valid; unlinking now means nothing is left behind
+    shm_unlink(segmentName(job, ID).c_str());
+
+    sendQueues = decltype(sendQueues)(Num);
+    recvStates = decltype(recvStates)(Num);
+  }
+
+  ~NetworkIOSHM() {
+    for (auto& seg : segments)
+      munmap(seg.base, seg.len);
+  }
+
+  /**
+   * Adds a message to the send queue of its destination. Messages to this
+   * host are handed over without copying.
+   */
+  virtual void enqueue(message m) {
+    m.flatten();
+    galois::runtime::trace("SHM SEND", m.host, m.tag, m.data.size());
+    if (m.host == ID) {
+      --inflightSends;
+      ++inflightRecvs;
+      // released by the receiver like the messages of pullRecvs
+      memUsageTracker.incrementMemUsage(m.data.size());
+      done.push_back(std::move(m));
+      return;
+    }
+    memUsageTracker.incrementMemUsage(m.data.size());
+    uint32_t host = m.host;
+    sendQueues[host].pending.push_back(std::move(m));
+    pushSends(host);
+  }
+
+  /**
+   * Attempts to get a received message.
+   */
+  virtual message dequeue() {
+    if (!done.empty()) {
+      auto msg = std::move(done.front());
+      done.pop_front();
+      return msg;
+    }
+    return message{~0U, 0, vTy()};
+  }
+
+  /**
+   * Push progress forward in the system.
+   */
+  virtual void progress() {
+    for (uint32_t h = 0; h < Num; ++h) {
+      if (h == ID)
+        continue;
+      if (!sendQueues[h].pending.empty())
+        pushSends(h);
+      pullRecvs(h);
+    }
+  }
+}; // end NetworkIOSHM class
+
+std::tuple<std::unique_ptr<galois::runtime::NetworkIO>, uint32_t, uint32_t>
+galois::runtime::makeNetworkIOSHM(galois::runtime::MemUsageTracker& tracker,
+                                  std::atomic<size_t>& sends,
+                                  std::atomic<size_t>& recvs) {
+  uint32_t ID, NUM;
+  std::unique_ptr<galois::runtime::NetworkIO> n{
+      new NetworkIOSHM(tracker, sends, recvs, ID, NUM)};
+  return std::make_tuple(std::move(n), ID, NUM);
+}
@@ -0,0 +1,226 @@
+/*
+ * This file belongs to the Galois project, a C++ library for exploiting parallelism.
+ * The code is being released under the terms of the 3-Clause BSD License (a
+ * copy is located in LICENSE.txt at the top-level directory).
+ *
+ * Copyright (C) 2018, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ */
+
+
+/**
+ * @file PartitionCache.cpp
+ *
+ * Fingerprinting, validation, mapping, and writing of partition cache files.
+ */
+
+#include "galois/graphs/PartitionCache.h"
+#include "galois/gIO.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+const char PARTITION_CACHE_MAGIC[8] = {'G', 'A', 'L', 'P', 'C', 'A', 'C', 'H'};
+//! size of the blocks of the input graph that are hashed
+const size_t FINGERPRINT_BLOCK = 4096;
+//! number of blocks sampled across the input graph besides the first
+const size_t FINGERPRINT_SAMPLES = 64;
+
+//! FNV-1a over a buffer, continuing from a previous hash
+uint64_t fnv1a(const void* data, size_t bytes,
+               uint64_t hash = 0xcbf29ce484222325ull) {
+  const unsigned char* p = static_cast<const unsigned char*>(data);
+  for (size_t i = 0; i < bytes; ++i) {
+    hash ^= p[i];
+    hash *= 0x100000001b3ull;
+  }
+  return hash;
+}
+
+uint64_t alignUp(uint64_t x) {
+  return (x + galois::graphs::PARTITION_CACHE_ALIGN - 1) &
+         ~(galois::graphs::PARTITION_CACHE_ALIGN - 1);
+}
+
+//! pwrite that retries until every byte is written
+void writeFully(int fd, const void* data, size_t bytes, uint64_t offset,
+                const std::string& path) {
+  const char* p = static_cast<const char*>(data);
+  while (bytes > 0) {
+    ssize_t n = pwrite(fd, p, bytes, offset);
+    if (n < 0) {
+      GALOIS_SYS_DIE("failed writing partition cache ", path);
+    }
+    p += n;
+    bytes -= n;
+    offset += n;
+  }
+}
+
+} // namespace
+
+galois::graphs::PartitionCacheKey galois::graphs::makePartitionCacheKey(
+    const std::string& inputFile, const std::string& policy, uint32_t hostID,
+    uint32_t numHosts, uint32_t edgeDataSize) {
+  PartitionCacheKey key;
+  memset(&key, 0, sizeof(key));
+  key.policyHash   = fnv1a(policy.data(), policy.size());
+  key.numHosts     = numHosts;
+  key.hostID       = hostID;
+  key.edgeDataSize = edgeDataSize;
+
+  int fd = open(inputFile.c_str(), O_RDONLY);
+  if (fd < 0) {
+    GALOIS_SYS_DIE("failed opening ", inputFile);
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    GALOIS_SYS_DIE("failed reading attributes of ", inputFile);
+  }
+  key.inputSize  = st.st_size;
+  key.inputMtime = uint64_t(st.st_mtim.tv_sec) * 1000000000ull +
+                   uint64_t(st.st_mtim.tv_nsec);
+
+  // the first block holds the graph header; the samples catch changes to
+  // the body of a file rewritten with the same size and time
+  std::vector<char> block(FINGERPRINT_BLOCK);
+  uint64_t hash = fnv1a(&key.inputSize, sizeof(key.inputSize));
+  uint64_t span =
+      key.inputSize > FINGERPRINT_BLOCK ? key.inputSize - FINGERPRINT_BLOCK : 0;
+  for (size_t i = 0; i <= FINGERPRINT_SAMPLES; ++i) {
+    uint64_t offset = span * i / FINGERPRINT_SAMPLES;
+    ssize_t n       = pread(fd, block.data(), block.size(), offset);
+    if (n < 0) {
+      GALOIS_SYS_DIE("failed reading ", inputFile);
+    }
+    hash = fnv1a(block.data(), n, hash);
+  }
+  close(fd);
+  key.inputHash = hash;
+  return key;
+}
+
+std::string
+galois::graphs::partitionCachePath(const std::string& dir,
+                                   const PartitionCacheKey& key) {
+  char name[96];
+  snprintf(name, sizeof(name), "/partition_%016lx_%016lx_%u_%u.gpc",
+           (unsigned long)key.inputHash, (unsigned long)key.policyHash,
+           key.numHosts, key.hostID);
+  return dir + name;
+}
+
+bool galois::graphs::validatePartitionCache(const std::string& path,
+                                            const PartitionCacheKey& key) {
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+  PartitionCacheHeader header;
+  struct stat st;
+  bool valid = pread(fd, &header, sizeof(header), 0) == sizeof(header) &&
+               fstat(fd, &st) == 0;
+  close(fd);
+
+  return valid &&
+         memcmp(header.magic, PARTITION_CACHE_MAGIC, sizeof(header.magic)) ==
+             0 &&
+         header.version == PARTITION_CACHE_VERSION &&
+         header.headerSize == sizeof(PartitionCacheHeader) &&
+         memcmp(&header.key, &key, sizeof(key)) == 0 &&
+         header.fileSize == uint64_t(st.st_size) &&
+         header.metaOffset + header.metaSize <= header.fileSize;
+}
+
+void galois::graphs::PartitionCacheMapping::map(const std::string& path) {
+  unmap();
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    GALOIS_SYS_DIE("failed opening partition cache ", path);
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    GALOIS_SYS_DIE("failed reading attributes of partition cache ", path);
+  }
+  // private + writable: pages are shared with the page cache until written
+  void* m = mmap(nullptr, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE,
+                 fd, 0);
+  if (m == MAP_FAILED) {
+    GALOIS_SYS_DIE("failed mapping partition cache ", path);
+  }
+  close(fd);
+  base   = static_cast<char*>(m);
+  length = st.st_size;
+}
+
+void galois::graphs::PartitionCacheMapping::unmap() {
+  if (base) {
+    munmap(base, length);
+    base   = nullptr;
+    length = 0;
+  }
+}
+
+galois::graphs::PartitionCacheWriter::PartitionCacheWriter(
+    const std::string& _path)
+    : path(_path), tmpPath(_path + ".tmp." + std::to_string(getpid())),
+      offset(alignUp(sizeof(PartitionCacheHeader))) {
+  fd = open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) {
+    GALOIS_SYS_DIE("failed creating partition cache ", tmpPath);
+  }
+}
+
+galois::graphs::PartitionCacheWriter::~PartitionCacheWriter() {
+  // only still open if finish was never reached
+  if (fd >= 0) {
+    close(fd);
+    unlink(tmpPath.c_str());
+  }
+}
+
+uint64_t galois::graphs::PartitionCacheWriter::append(const void* data,
+                                                      size_t bytes) {
+  uint64_t start = offset;
+  writeFully(fd, data, bytes, start, tmpPath);
+  offset = alignUp(start + bytes);
+  return start;
+}
+
+void galois::graphs::PartitionCacheWriter::finish(
+    PartitionCacheHeader& header) {
+  std::copy(PARTITION_CACHE_MAGIC, PARTITION_CACHE_MAGIC + 8, header.magic);
+  header.version    = PARTITION_CACHE_VERSION;
+  header.headerSize = sizeof(PartitionCacheHeader);
+  header.fileSize   = offset;
+
+  // extend the file to cover the padding after the last section
+  if (ftruncate(fd, offset) != 0) {
+    GALOIS_SYS_DIE("failed sizing partition cache ", tmpPath);
+  }
+  writeFully(fd, &header, sizeof(header), 0, tmpPath);
+  if (fsync(fd) != 0 || close(fd) != 0) {
+    GALOIS_SYS_DIE("failed flushing partition cache ", tmpPath);
+  }
+  fd = -1;
+  if (rename(tmpPath.c_str(), path.c_str()) != 0) {
+    GALOIS_SYS_DIE("failed publishing partition cache ", path);
+  }
+}
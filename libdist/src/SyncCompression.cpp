@@ -0,0 +1,252 @@
+/*
+ * This file belongs to the Galois project, a C++ library for exploiting parallelism.
+ * The code is being released under the terms of the 3-Clause BSD License (a
+ * copy is located in LICENSE.txt at the top-level directory).
+ *
+ * Copyright (C) 2018, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ */
+
+
+/**
+ * @file SyncCompression.cpp
+ *
+ * Implementation of the run-length offset encoding and the block compressor
+ * used by synchronization.
+ */
+
+#include "galois/runtime/SyncCompression.h"
+#include "galois/graphs/CompressedAdjacency.h"
+
+#include <cstring>
+#include <vector>
+
+namespace varint = galois::graphs::varint;
+
+namespace {
+
+//! Calls fn(gap, runLength) for every run of consecutive offsets
+template <typename Fn>
+void forEachRun(const uint32_t* offsets, size_t count, Fn fn) {
+  uint64_t prevEnd = 0;
+  size_t i         = 0;
+  while (i < count) {
+    size_t j = i + 1;
+    while (j < count && offsets[j] == offsets[j - 1] + 1)
+      ++j;
+    fn(offsets[i] - prevEnd, j - i);
+    prevEnd = uint64_t(offsets[j - 1]) + 1;
+    i       = j;
+  }
+}
+
+constexpr size_t MIN_MATCH   = 4;
+//! the last bytes of a block are always literals
+constexpr size_t LAST_LITERALS = 5;
+//! no match may start this close to the end of a block
+constexpr size_t MATCH_LIMIT = 12;
+constexpr size_t MAX_OFFSET  = 65535;
+constexpr unsigned HASH_BITS = 14;
+
+inline uint32_t read32(const uint8_t* p) {
+  uint32_t v;
+  std::memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+inline uint32_t hash4(uint32_t v) {
+  return (v * 2654435761U) >> (32 - HASH_BITS);
+}
+
+//! Writes the 255-continued remainder of a length field
+inline bool writeLength(size_t len, uint8_t*& op, const uint8_t* oend) {
+  while (len >= 255) {
+    if (op >= oend)
+      return false;
+    *op++ = 255;
+    len -= 255;
+  }
+  if (op >= oend)
+    return false;
+  *op++ = static_cast<uint8_t>(len);
+  return true;
+}
+
+//! Reads the 255-continued remainder of a length field
+inline bool readLength(size_t& len, const uint8_t*& ip, const uint8_t* iend) {
+  uint8_t b;
+  do {
+    if (ip >= iend)
+      return false;
+    b = *ip++;
+    len += b;
+  } while (b == 255);
+  return true;
+}
+
+//! Emits one sequence; matchLen of 0 marks the final literal-only sequence
+bool emitSequence(const uint8_t* literals, size_t litLen, size_t offset,
+                  size_t matchLen, uint8_t*& op, const uint8_t* oend) {
+  if (op >= oend)
+    return false;
+  uint8_t* token = op++;
+  size_t litCode = litLen < 15 ? litLen : 15;
+  size_t mCode   = 0;
+  if (matchLen) {
+    mCode = matchLen - MIN_MATCH;
+    mCode = mCode < 15 ? mCode : 15;
+  }
+  *token = static_cast<uint8_t>((litCode << 4) | mCode);
+
+  if (litCode == 15 && !writeLength(litLen - 15, op, oend))
+    return false;
+  if (size_t(oend - op) < litLen)
+    return false;
+  std::memcpy(op, literals, litLen);
+  op += litLen;
+
+  if (matchLen) {
+    if (size_t(oend - op) < 2)
+      return false;
+    *op++ = static_cast<uint8_t>(offset & 0xFF);
+    *op++ = static_cast<uint8_t>(offset >> 8);
+    if (mCode == 15 && !writeLength(matchLen - MIN_MATCH - 15, op, oend))
+      return false;
+  }
+  return true;
+}
+
+} // namespace
+
+size_t galois::runtime::offsetRunsSize(const uint32_t* offsets, size_t count) {
+  size_t size = 0;
+  forEachRun(offsets, count, [&](uint64_t gap, uint64_t len) {
+    size += varint::encodedSize(gap) + varint::encodedSize(len - 1);
+  });
+  return size;
+}
+
+size_t galois::runtime::encodeOffsetRuns(const uint32_t* offsets, size_t count,
+                                         uint8_t* out) {
+  uint8_t* p = out;
+  forEachRun(offsets, count, [&](uint64_t gap, uint64_t len) {
+    p = varint::encode(gap, p);
+    p = varint::encode(len - 1, p);
+  });
+  return p - out;
+}
+
+bool galois::runtime::decodeOffsetRuns(const uint8_t* in, size_t size,
+                                       uint32_t* offsets, size_t count) {
+  const uint8_t* end = in + size;
+  uint64_t next      = 0;
+  size_t n           = 0;
+  while (in < end) {
+    next += varint::decode(in);
+    if (in >= end)
+      return false;
+    uint64_t len = varint::decode(in) + 1;
+    if (in > end || len > count - n)
+      return false;
+    for (uint64_t i = 0; i < len; ++i) {
+      offsets[n++] = static_cast<uint32_t>(next++);
+    }
+  }
+  return n == count && in == end;
+}
+
+size_t galois::runtime::blockCompress(const uint8_t* src, size_t srcSize,
+                                      uint8_t* dst, size_t dstCapacity) {
+  uint8_t* op             = dst;
+  const uint8_t* oend     = dst + dstCapacity;
+  size_t anchor           = 0;
+  size_t ip               = 0;
+  const size_t matchLimit = srcSize > MATCH_LIMIT ? srcSize - MATCH_LIMIT : 0;
+
+  // positions + 1 of the last occurrence of each hashed 4-byte sequence
+  std::vector<uint32_t> table(size_t(1) << HASH_BITS, 0);
+
+  while (ip < matchLimit) {
+    uint32_t seq = read32(src + ip);
+    uint32_t h   = hash4(seq);
+    size_t ref   = table[h];
+    table[h]     = static_cast<uint32_t>(ip + 1);
+
+    if (ref == 0 || ip - (ref - 1) > MAX_OFFSET ||
+        read32(src + ref - 1) != seq) {
+      ++ip;
+      continue;
+    }
+
+    size_t match = ref - 1;
+    size_t len   = MIN_MATCH;
+    while (ip + len < srcSize - LAST_LITERALS &&
+           src[match + len] == src[ip + len]) {
+      ++len;
+    }
+
+    if (!emitSequence(src + anchor, ip - anchor, ip - match, len, op, oend))
+      return 0;
+    ip += len;
+    anchor = ip;
+  }
+
+  if (!emitSequence(src + anchor, srcSize - anchor, 0, 0, op, oend))
+    return 0;
+  return op - dst;
+}
+
+bool galois::runtime::blockDecompress(const uint8_t* src, size_t srcSize,
+                                      uint8_t* dst, size_t dstSize) {
+  const uint8_t* ip   = src;
+  const uint8_t* iend = src + srcSize;
+  uint8_t* op         = dst;
+  uint8_t* oend       = dst + dstSize;
+
+  while (ip < iend) {
+    uint8_t token = *ip++;
+
+    size_t litLen = token >> 4;
+    if (litLen == 15 && !readLength(litLen, ip, iend))
+      return false;
+    if (size_t(iend - ip) < litLen || size_t(oend - op) < litLen)
+      return false;
+    std::memcpy(op, ip, litLen);
+    ip += litLen;
+    op += litLen;
+
+    if (ip == iend) // last sequence has no match
+      break;
+
+    if (size_t(iend - ip) < 2)
+      return false;
+    size_t offset = ip[0] | (size_t(ip[1]) << 8);
+    ip += 2;
+    size_t matchLen = token & 15;
+    if (matchLen == 15 && !readLength(matchLen, ip, iend))
+      return false;
+    matchLen += MIN_MATCH;
+
+    if (offset == 0 || offset > size_t(op - dst) ||
+        size_t(oend - op) < matchLen)
+      return false;
+    // byte by byte: the match may overlap the bytes it produces
+    const uint8_t* match = op - offset;
+    for (size_t i = 0; i < matchLen; ++i) {
+      op[i] = match[i];
+    }
+    op += matchLen;
+  }
+
+  return op == oend;
+}
@@ -22,11 +22,20 @@
 
 #include "galois/Reduction.h"
 #include "galois/GaloisForwardDecl.h"
+#include "galois/Threads.h"
 #include "galois/NoDerefIterator.h"
 #include "galois/Traits.h"
 #include "galois/UserContext.h"
 #include "galois/worklists/Chunk.h"
 #include "galois/runtime/Range.h"
+#include "galois/substrate/NumaMem.h"
+#include "galois/substrate/PerThreadStorage.h"
+
+#include <algorithm>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 namespace galois {
 //! Parallel versions of STL library algorithms.
@@ -234,6 +243,141 @@ RandomAccessIterator partition(RandomAccessIterator first,
   return std::partition(s.rfirst, s.rlast, pred);
 }
 
+//! unsigned integer that orders like the (possibly signed) integer x
+template <typename T>
+typename std::make_unsigned<T>::type radixKey(T x) {
+  typedef typename std::make_unsigned<T>::type U;
+  const U signBit = std::is_signed<T>::value ? U(1) << (8 * sizeof(T) - 1) : 0;
+  return static_cast<U>(x) ^ signBit;
+}
+
+template <typename T>
+struct is_radix_sortable
+    : std::integral_constant<bool, std::is_integral<T>::value &&
+                                       !std::is_same<T, bool>::value> {};
+
+//! per thread digit counts, then the offsets of their elements in a pass
+struct RadixHistogram {
+  static const unsigned BITS    = 8;
+  static const unsigned BUCKETS = 1 << BITS;
+  size_t count[BUCKETS];
+};
+
+/**
+ * One stable pass of radix_sort: thread t moves its block of src to dst in
+ * the order of the digit at shift, after the elements of smaller digits and
+ * after the elements of the same digit in the blocks of threads before it.
+ */
+template <class SrcIterator, class DstIterator, class KeyFn>
+void radix_pass(SrcIterator src, DstIterator dst, size_t n, unsigned shift,
+                const KeyFn& key,
+                substrate::PerThreadStorage<RadixHistogram>& hists) {
+  const unsigned mask = RadixHistogram::BUCKETS - 1;
+  unsigned numT       = getActiveThreads();
+
+  on_each([&](unsigned tid, unsigned total) {
+    RadixHistogram& h = *hists.getLocal();
+    std::fill(h.count, h.count + RadixHistogram::BUCKETS, 0);
+    auto r = galois::block_range(size_t{0}, n, tid, total);
+    for (size_t i = r.first; i < r.second; ++i)
+      ++h.count[(radixKey(key(src[i])) >> shift) & mask];
+  });
+
+  size_t offset = 0;
+  for (unsigned b = 0; b < RadixHistogram::BUCKETS; ++b) {
+    for (unsigned t = 0; t < numT; ++t) {
+      size_t& c = hists.getRemote(t)->count[b];
+      size_t x  = c;
+      c         = offset;
+      offset += x;
+    }
+  }
+
+  on_each([&](unsigned tid, unsigned total) {
+    RadixHistogram& h = *hists.getLocal();
+    auto r = galois::block_range(size_t{0}, n, tid, total);
+    typedef typename std::iterator_traits<SrcIterator>::value_type T;
+    for (size_t i = r.first; i < r.second; ++i) {
+      size_t pos = h.count[(radixKey(key(src[i])) >> shift) & mask]++;
+      // the buffer starts out uninitialized
+      new (&dst[pos]) T(src[i]);
+    }
+  });
+}
+
+/**
+ * Stable parallel LSD radix sort of [first, last) by an integral key of the
+ * elements, e.g. the first member of key-value pairs. Each pass sorts by 8
+ * bits of the keys with per thread histograms; bits that are the same in all
+ * keys are skipped. Elements are copied through a buffer interleaved across
+ * the NUMA nodes and must be trivially destructible.
+ *
+ * @param key maps an element to its integral key
+ */
+template <class RandomAccessIterator, class KeyFn>
+void radix_sort(RandomAccessIterator first, RandomAccessIterator last,
+                KeyFn key) {
+  typedef typename std::iterator_traits<RandomAccessIterator>::value_type T;
+  typedef std::decay_t<decltype(key(*first))> K;
+  static_assert(is_radix_sortable<K>::value,
+                "radix_sort needs integral keys");
+  static_assert(std::is_trivially_destructible<T>::value,
+                "radix_sort needs trivially destructible elements");
+  typedef typename std::make_unsigned<K>::type U;
+
+  size_t n = std::distance(first, last);
+  if (n <= 1024) {
+    std::stable_sort(first, last, [&](const T& a, const T& b) {
+      return radixKey(key(a)) < radixKey(key(b));
+    });
+    return;
+  }
+
+  // bits that differ between some keys
+  substrate::PerThreadStorage<std::pair<U, U>> andOr(~U(0), U(0));
+  do_all(galois::iterate(first, last), [&](const T& x) {
+    U k                  = radixKey(key(x));
+    std::pair<U, U>& acc = *andOr.getLocal();
+    acc.first &= k;
+    acc.second |= k;
+  }, galois::no_stats());
+  U allAnd = ~U(0);
+  U allOr  = 0;
+  for (unsigned t = 0; t < getActiveThreads(); ++t) {
+    allAnd &= andOr.getRemote(t)->first;
+    allOr |= andOr.getRemote(t)->second;
+  }
+  U varying = allAnd ^ allOr;
+
+  substrate::LAptr buffer =
+      substrate::largeMallocInterleaved(n * sizeof(T), getActiveThreads());
+  T* tmp = static_cast<T*>(buffer.get());
+  substrate::PerThreadStorage<RadixHistogram> hists;
+
+  bool inBuffer = false;
+  for (unsigned shift = 0; shift < 8 * sizeof(U);
+       shift += RadixHistogram::BITS) {
+    if (!((varying >> shift) & (RadixHistogram::BUCKETS - 1)))
+      continue;
+    if (inBuffer)
+      radix_pass(tmp, first, n, shift, key, hists);
+    else
+      radix_pass(first, tmp, n, shift, key, hists);
+    inBuffer = !inBuffer;
+  }
+
+  if (inBuffer)
+    do_all(galois::iterate(size_t{0}, n),
+           [&](size_t i) { first[i] = tmp[i]; }, galois::no_stats());
+}
+
+//! radix_sort of integers by their value
+template <class RandomAccessIterator>
+void radix_sort(RandomAccessIterator first, RandomAccessIterator last) {
+  typedef typename std::iterator_traits<RandomAccessIterator>::value_type T;
+  radix_sort(first, last, [](const T& x) { return x; });
+}
+
 struct pair_dist {
   template <typename RP>
   bool operator()(const RP& x, const RP& y) {
@@ -255,13 +399,29 @@ void sort(RandomAccessIterator first, RandomAccessIterator last, Compare comp) {
 }
 
 template <class RandomAccessIterator>
-void sort(RandomAccessIterator first, RandomAccessIterator last) {
+void sort_by_value(RandomAccessIterator first, RandomAccessIterator last,
+                   std::true_type) {
+  galois::ParallelSTL::radix_sort(first, last);
+}
+
+template <class RandomAccessIterator>
+void sort_by_value(RandomAccessIterator first, RandomAccessIterator last,
+                   std::false_type) {
   galois::ParallelSTL::sort(
       first, last,
       std::less<
           typename std::iterator_traits<RandomAccessIterator>::value_type>());
 }
 
+//! Sorts integers with radix_sort and other values by comparison.
+template <class RandomAccessIterator>
+void sort(RandomAccessIterator first, RandomAccessIterator last) {
+  sort_by_value(
+      first, last,
+      is_radix_sortable<typename std::iterator_traits<
+          RandomAccessIterator>::value_type>());
+}
+
 template <class InputIterator, class T, typename BinaryOperation>
 T accumulate(InputIterator first, InputIterator last, const T& identity,
              const BinaryOperation& binary_op) {
@@ -288,6 +448,179 @@ T map_reduce(InputIterator first, InputIterator last, MapFn mapFn,
   return reducer.reduce();
 }
 
+/**
+ * Scan of [first, last) into out in two passes over the blocks of the
+ * threads: each thread sums its block, the sums of the blocks are scanned
+ * serially, then each thread scans its block starting from the sum of the
+ * blocks before it. out may be first.
+ *
+ * @param inclusive whether out[i] includes first[i]
+ */
+template <class InputIterator, class OutputIterator, class T,
+          class BinaryOperation>
+OutputIterator scan(InputIterator first, InputIterator last,
+                    OutputIterator out, T init, const BinaryOperation& op,
+                    bool inclusive) {
+  size_t n      = std::distance(first, last);
+  unsigned numT = getActiveThreads();
+
+  auto scanBlock = [&](size_t begin, size_t end, T acc) {
+    for (size_t i = begin; i < end; ++i) {
+      T next = op(acc, first[i]);
+      out[i] = inclusive ? next : acc;
+      acc    = std::move(next);
+    }
+  };
+
+  if (n <= 1024 || numT == 1) {
+    scanBlock(0, n, init);
+    return out + n;
+  }
+
+  std::vector<T> sums(numT, init);
+  on_each([&](unsigned tid, unsigned total) {
+    auto r = galois::block_range(size_t{0}, n, tid, total);
+    if (r.first == r.second)
+      return;
+    T acc = first[r.first];
+    for (size_t i = r.first + 1; i < r.second; ++i)
+      acc = op(acc, first[i]);
+    sums[tid] = std::move(acc);
+  });
+
+  // blocks at the end may be empty
+  T acc = init;
+  for (unsigned t = 0; t < numT; ++t) {
+    auto r = galois::block_range(size_t{0}, n, t, numT);
+    if (r.first == r.second)
+      break;
+    T next  = op(acc, sums[t]);
+    sums[t] = std::move(acc);
+    acc     = std::move(next);
+  }
+
+  on_each([&](unsigned tid, unsigned total) {
+    auto r = galois::block_range(size_t{0}, n, tid, total);
+    scanBlock(r.first, r.second, sums[tid]);
+  });
+  return out + n;
+}
+
+//! parallel std::exclusive_scan: out[i] is init combined with the elements
+//! before first[i]
+template <class InputIterator, class OutputIterator, class T,
+          class BinaryOperation>
+OutputIterator exclusive_scan(InputIterator first, InputIterator last,
+                              OutputIterator out, T init,
+                              BinaryOperation op) {
+  return scan(first, last, out, init, op, false);
+}
+
+template <class InputIterator, class OutputIterator, class T>
+OutputIterator exclusive_scan(InputIterator first, InputIterator last,
+                              OutputIterator out, T init) {
+  return scan(first, last, out, init, std::plus<T>(), false);
+}
+
+//! parallel std::inclusive_scan: out[i] is init combined with the elements
+//! up to and including first[i]
+template <class InputIterator, class OutputIterator, class BinaryOperation,
+          class T>
+OutputIterator inclusive_scan(InputIterator first, InputIterator last,
+                              OutputIterator out, BinaryOperation op,
+                              T init) {
+  return scan(first, last, out, init, op, true);
+}
+
+template <class InputIterator, class OutputIterator, class BinaryOperation>
+OutputIterator inclusive_scan(InputIterator first, InputIterator last,
+                              OutputIterator out, BinaryOperation op) {
+  typedef typename std::iterator_traits<InputIterator>::value_type T;
+  if (first == last)
+    return out;
+  T init = *first;
+  *out   = init;
+  return scan(first + 1, last, out + 1, init, op, true);
+}
+
+template <class InputIterator, class OutputIterator>
+OutputIterator inclusive_scan(InputIterator first, InputIterator last,
+                              OutputIterator out) {
+  typedef typename std::iterator_traits<InputIterator>::value_type T;
+  return galois::ParallelSTL::inclusive_scan(first, last, out,
+                                             std::plus<T>());
+}
+
+/**
+ * The two passes of compact: each thread counts the matches in its block, the
+ * counts are scanned, then alloc(total matches) returns the output and each
+ * thread copies its matches to it from its offset.
+ *
+ * @returns the end of the output
+ */
+template <class InputIterator, class AllocFn, class Predicate>
+auto compact_pass(InputIterator first, size_t n, AllocFn alloc,
+                  Predicate pred) -> decltype(alloc(n)) {
+  unsigned numT = getActiveThreads();
+  std::vector<size_t> offsets(numT + 1, 0);
+  on_each([&](unsigned tid, unsigned total) {
+    auto r       = galois::block_range(size_t{0}, n, tid, total);
+    size_t count = 0;
+    for (size_t i = r.first; i < r.second; ++i)
+      if (pred(first[i]))
+        ++count;
+    offsets[tid + 1] = count;
+  });
+  for (unsigned t = 0; t < numT; ++t)
+    offsets[t + 1] += offsets[t];
+
+  auto out = alloc(offsets[numT]);
+  on_each([&](unsigned tid, unsigned total) {
+    auto r     = galois::block_range(size_t{0}, n, tid, total);
+    size_t pos = offsets[tid];
+    for (size_t i = r.first; i < r.second; ++i)
+      if (pred(first[i]))
+        out[pos++] = first[i];
+  });
+  return out + offsets[numT];
+}
+
+/**
+ * Stream compaction (pack): copies the elements of [first, last) that satisfy
+ * pred to out, keeping their order. pred is called twice per element. out
+ * must not overlap the input and must have room for all elements that may
+ * match.
+ *
+ * @returns the end of the output
+ */
+template <class InputIterator, class OutputIterator, class Predicate>
+OutputIterator compact(InputIterator first, InputIterator last,
+                       OutputIterator out, Predicate pred) {
+  size_t n = std::distance(first, last);
+  if (n <= 1024 || getActiveThreads() == 1)
+    return std::copy_if(first, last, out, pred);
+  return compact_pass(first, n, [&](size_t) { return out; }, pred);
+}
+
+/**
+ * Like compact, but into a resizeable container (e.g. a vector) that is
+ * resized to the number of matches once they are counted, so it only needs
+ * room for the matches and not for all of [first, last).
+ */
+template <class InputIterator, class Container, class Predicate>
+void compact_into(InputIterator first, InputIterator last, Container& out,
+                  Predicate pred) {
+  size_t n     = std::distance(first, last);
+  auto resized = [&](size_t count) {
+    out.resize(count);
+    return out.begin();
+  };
+  if (n <= 1024 || getActiveThreads() == 1)
+    std::copy_if(first, last, resized(std::count_if(first, last, pred)), pred);
+  else
+    compact_pass(first, n, resized, pred);
+}
+
 template <typename I>
 std::enable_if_t<!std::is_scalar<internal::Val_ty<I>>::value> destroy(I first,
                                                                       I last) {
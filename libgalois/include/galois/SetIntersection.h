@@ -0,0 +1,121 @@
+/*
+ * This file belongs to the Galois project, a C++ library for exploiting parallelism.
+ * The code is being released under the terms of the 3-Clause BSD License (a
+ * copy is located in LICENSE.txt at the top-level directory).
+ *
+ * Copyright (C) 2018, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ */
+
+/**
+ * @file SetIntersection.h
+ *
+ * Intersection of sorted sets of node ids, e.g. adjacency lists sorted by
+ * destination. Sets of similar sizes are intersected with SIMD kernels chosen
+ * at runtime for the instruction sets of the machine, sets of very different
+ * sizes with galloping search, and many small sets with one large set with
+ * a SortedSetBitmap of the large set.
+ *
+ * All sets are sorted in increasing order and contain no duplicates.
+ */
+
+#ifndef GALOIS_SETINTERSECTION_H
+#define GALOIS_SETINTERSECTION_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace galois {
+
+/**
+ * Instruction sets of the intersection kernels. The GALOIS_SET_INTERSECTION
+ * environment variable limits the kernels used to "scalar", "sse4.2",
+ * "avx2" or "avx512"; by default the best one the machine supports is used.
+ */
+enum class SetIntersectionISA { SCALAR, SSE4_2, AVX2, AVX512 };
+
+//! best instruction set of the intersection kernels the machine supports
+SetIntersectionISA getSupportedSetIntersectionISA();
+
+//! instruction set of the intersection kernels in use
+SetIntersectionISA getSetIntersectionISA();
+
+/**
+ * Changes the instruction set of the intersection kernels, e.g. to compare
+ * them; an instruction set the machine does not support is replaced by the
+ * best one it does. Only call while the runtime is idle: intersections
+ * running in a parallel loop may still use the previous kernels.
+ */
+void setSetIntersectionISA(SetIntersectionISA isa);
+
+//! number of common elements of a and b
+size_t intersectCount(const uint32_t* a, size_t na, const uint32_t* b,
+                      size_t nb);
+size_t intersectCount(const uint64_t* a, size_t na, const uint64_t* b,
+                      size_t nb);
+
+/**
+ * Writes the common elements of a and b to out in increasing order.
+ *
+ * @param out room for min(na, nb) elements
+ * @returns number of common elements
+ */
+size_t intersect(const uint32_t* a, size_t na, const uint32_t* b, size_t nb,
+                 uint32_t* out);
+size_t intersect(const uint64_t* a, size_t na, const uint64_t* b, size_t nb,
+                 uint64_t* out);
+
+/**
+ * Writes the positions in a and in b of the common elements of a and b in
+ * increasing order, e.g. to look at the edge data of common neighbors.
+ *
+ * @param posA room for min(na, nb) positions
+ * @param posB room for min(na, nb) positions
+ * @returns number of common elements
+ */
+size_t intersectPositions(const uint32_t* a, size_t na, const uint32_t* b,
+                          size_t nb, uint32_t* posA, uint32_t* posB);
+
+/**
+ * Bitmap of one large set, e.g. the neighbors of a hub node, for intersecting
+ * it with many other sets in time linear in the size of the other sets.
+ * Only the words holding bits of the current set are cleared when it is
+ * replaced, so replacing sets costs time linear in their sizes as well.
+ */
+class SortedSetBitmap {
+  std::vector<uint64_t> words;
+  //! indices of the non-zero words
+  std::vector<size_t> used;
+
+public:
+  /**
+   * Makes the n elements of s the current set.
+   *
+   * @param universe elements of s are less than universe
+   */
+  void assign(const uint32_t* s, size_t n, size_t universe);
+
+  //! empties the current set
+  void clear();
+
+  //! only valid after assign
+  bool test(uint32_t x) const { return (words[x >> 6] >> (x & 63)) & 1; }
+
+  //! number of common elements of the current set and b
+  size_t intersectCount(const uint32_t* b, size_t nb) const;
+};
+
+} // end namespace galois
+
+#endif
@@ -0,0 +1,217 @@
+/*
+ * This file belongs to the Galois project, a C++ library for exploiting parallelism.
+ * The code is being released under the terms of the 3-Clause BSD License (a
+ * copy is located in LICENSE.txt at the top-level directory).
+ *
+ * Copyright (C) 2018, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ */
+
+
+/**
+ * @file CompressedAdjacency.h
+ *
+ * Byte-aligned delta + varint coding of adjacency lists used by version 3
+ * (compressed) Galois graph files and by LC_CCSR_Graph.
+ */
+
+#ifndef GALOIS_GRAPHS_COMPRESSEDADJACENCY_H
+#define GALOIS_GRAPHS_COMPRESSEDADJACENCY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+
+namespace galois {
+namespace graphs {
+
+// Compressed graph file format (version 3):
+// version (3) {uint64_t LE}
+// EdgeType size {uint64_t LE}
+// numNodes {uint64_t LE}
+// numEdges {uint64_t LE}
+// outindexs[numNodes] {uint64_t LE} (same as version 1 and 2)
+// byteindexs[numNodes] {uint64_t LE} (byteindex[nodeid] is the offset one past
+// the last byte of the encoded neighbors of nodeid in outbytes)
+// outbytes[byteindex[numNodes - 1]] {uint8_t}
+// padding to re-align to 64 bits
+// EdgeType[numEdges] {EdgeType size}
+//
+// The neighbors of a node are sorted by destination. The first destination
+// is stored as a zigzag varint of (dst - src) and every later one as a
+// varint of the gap to the previous destination. Edge data is stored in the
+// same (sorted) order as the destinations.
+
+namespace varint {
+
+//! Number of bytes needed to encode v
+inline size_t encodedSize(uint64_t v) {
+  size_t n = 1;
+  while (v >= 0x80) {
+    v >>= 7;
+    ++n;
+  }
+  return n;
+}
+
+//! Encodes v 7 bits at a time, low bits first; returns one past the last byte
+inline uint8_t* encode(uint64_t v, uint8_t* out) {
+  while (v >= 0x80) {
+    *out++ = static_cast<uint8_t>(v) | 0x80;
+    v >>= 7;
+  }
+  *out++ = static_cast<uint8_t>(v);
+  return out;
+}
+
+//! Decodes a value and advances in past it
+inline uint64_t decode(const uint8_t*& in) {
+  uint64_t v = *in++;
+  if (v < 0x80)
+    return v;
+  v &= 0x7f;
+  unsigned shift = 7;
+  uint64_t b;
+  do {
+    b = *in++;
+    v |= (b & 0x7f) << shift;
+    shift += 7;
+  } while (b >= 0x80);
+  return v;
+}
+
+//! Maps small signed values to small unsigned values
+inline uint64_t zigzag(int64_t v) {
+  return (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63);
+}
+
+inline int64_t unzigzag(uint64_t v) {
+  return static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1);
+}
+
+} // namespace varint
+
+/**
+ * Encodes the sorted destinations [ii, ei) of node src.
+ *
+ * @param out buffer to write to; if null, only the size is computed
+ * @returns number of bytes the encoded list takes
+ */
+template <typename Iter>
+size_t encodeNeighbors(uint64_t src, Iter ii, Iter ei, uint8_t* out) {
+  size_t bytes  = 0;
+  uint64_t prev = src;
+  bool first    = true;
+  for (; ii != ei; ++ii) {
+    uint64_t dst = *ii;
+    uint64_t v   = first ? varint::zigzag(static_cast<int64_t>(dst - prev))
+                       : dst - prev;
+    first = false;
+    prev  = dst;
+    if (out)
+      out = varint::encode(v, out);
+    bytes += varint::encodedSize(v);
+  }
+  return bytes;
+}
+
+/**
+ * Forward iterator over an encoded adjacency list that decodes destinations
+ * as it advances. Dereferencing gives the global edge index (like the
+ * counting iterators of the uncompressed graphs) so edge data can still be
+ * found by index; the destination is available through dst().
+ */
+class CompressedEdgeIterator {
+  uint64_t idx;
+  uint64_t endIdx;
+  const uint8_t* pos;
+  uint64_t curDst;
+
+public:
+  using iterator_category = std::forward_iterator_tag;
+  using value_type        = uint64_t;
+  using difference_type   = std::ptrdiff_t;
+  using pointer           = const uint64_t*;
+  using reference         = const uint64_t&;
+
+  CompressedEdgeIterator() : idx(0), endIdx(0), pos(nullptr), curDst(0) {}
+
+  //! End iterator of a list ending at edge index e
+  explicit CompressedEdgeIterator(uint64_t e)
+      : idx(e), endIdx(e), pos(nullptr), curDst(0) {}
+
+  /**
+   * Begin iterator of the list of src, which holds edges [b, e) encoded
+   * starting at p.
+   */
+  CompressedEdgeIterator(uint64_t src, uint64_t b, uint64_t e,
+                         const uint8_t* p)
+      : idx(b), endIdx(e), pos(p), curDst(src) {
+    if (idx != endIdx)
+      curDst += varint::unzigzag(varint::decode(pos));
+  }
+
+  reference operator*() const { return idx; }
+  pointer operator->() const { return &idx; }
+
+  //! Destination of the current edge
+  uint64_t dst() const { return curDst; }
+
+  CompressedEdgeIterator& operator++() {
+    if (++idx != endIdx)
+      curDst += varint::decode(pos);
+    return *this;
+  }
+
+  CompressedEdgeIterator operator++(int) {
+    CompressedEdgeIterator tmp(*this);
+    ++*this;
+    return tmp;
+  }
+
+  //! Number of edges between two iterators of the same list; O(1)
+  difference_type operator-(const CompressedEdgeIterator& rhs) const {
+    return static_cast<difference_type>(idx) -
+           static_cast<difference_type>(rhs.idx);
+  }
+
+  bool operator==(const CompressedEdgeIterator& rhs) const {
+    return idx == rhs.idx;
+  }
+  bool operator!=(const CompressedEdgeIterator& rhs) const {
+    return idx != rhs.idx;
+  }
+};
+
+//! Byte offsets of the sections of a version 3 graph file
+struct CompressedFileLayout {
+  uint64_t outIdx;
+  uint64_t byteIdx;
+  uint64_t outBytes;
+  uint64_t edgeData;
+  uint64_t total;
+
+  CompressedFileLayout(uint64_t numNodes, uint64_t numEdges,
+                       uint64_t numBytes, uint64_t sizeofEdgeData) {
+    outIdx   = 4 * sizeof(uint64_t);
+    byteIdx  = outIdx + numNodes * sizeof(uint64_t);
+    outBytes = byteIdx + numNodes * sizeof(uint64_t);
+    edgeData = (outBytes + numBytes + 7) & ~static_cast<uint64_t>(7);
+    total    = edgeData + numEdges * sizeofEdgeData;
+  }
+};
+
+} // namespace graphs
+} // namespace galois
+
+#endif
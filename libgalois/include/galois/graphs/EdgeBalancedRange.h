@@ -0,0 +1,306 @@
+/*
+ * This file belongs to the Galois project, a C++ library for exploiting parallelism.
+ * The code is being released under the terms of the 3-Clause BSD License (a
+ * copy is located in LICENSE.txt at the top-level directory).
+ *
+ * Copyright (C) 2018, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ */
+
+/**
+ * @file EdgeBalancedRange.h
+ *
+ * Ranges over the nodes of a CSR graph that give each thread about the same
+ * number of edges instead of the same number of nodes, and the
+ * galois::iterate_edge_balanced range makers that use them in loops.
+ */
+
+#ifndef GALOIS_GRAPHS_EDGEBALANCEDRANGE_H
+#define GALOIS_GRAPHS_EDGEBALANCEDRANGE_H
+
+#include "galois/MethodFlags.h"
+#include "galois/graphs/GraphHelpers.h"
+#include "galois/runtime/Range.h"
+
+#include <boost/iterator/iterator_facade.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace galois {
+namespace graphs {
+
+/**
+ * Per thread ranges of iterate_edge_balanced_split. Thread t works on the
+ * edges [edges[t], edges[t + 1]) of the nodes [nodes[t], nodes[t + 1]] (the
+ * last node is only included if the thread has some of its edges).
+ */
+struct HubSplitRanges {
+  std::vector<uint32_t> nodes;
+  std::vector<uint64_t> edges;
+
+  void clear() {
+    nodes.clear();
+    edges.clear();
+  }
+};
+
+namespace internal {
+
+//! boundaries between threads are aligned to this many nodes so that threads
+//! do not share cache lines of 8 byte node arrays (e.g. the edge index array)
+constexpr uint32_t EDGE_BALANCED_NODE_ALIGN = 8;
+
+/**
+ * Divides the nodes of a prefix sum of edges among units so that each unit
+ * gets about the same number of edges; each node counts as one edge so that
+ * runs of nodes without edges are divided as well. Boundaries are aligned to
+ * EDGE_BALANCED_NODE_ALIGN nodes.
+ *
+ * @tparam PrefixSumTy type with size() and operator[] returning the number of
+ * edges of the nodes up to and including a node
+ */
+template <typename PrefixSumTy>
+std::vector<uint32_t> determineEdgeBalancedRanges(PrefixSumTy& prefixSum,
+                                                  uint32_t unitsToSplit) {
+  std::vector<uint32_t> ranges =
+      determineUnitRangesFromPrefixSum(unitsToSplit, prefixSum, 1);
+  for (uint32_t i = 1; i < unitsToSplit; ++i) {
+    ranges[i] -= ranges[i] % EDGE_BALANCED_NODE_ALIGN;
+  }
+  return ranges;
+}
+
+/**
+ * Divides the edges of a graph evenly among units. A boundary inside a node
+ * with fewer edges than a unit's share is moved to the beginning of that node
+ * so that only such hub nodes are split among units.
+ */
+template <typename GraphTy>
+HubSplitRanges determineHubSplitRanges(GraphTy& graph, uint32_t unitsToSplit) {
+  HubSplitRanges ranges;
+  ranges.nodes.resize(unitsToSplit + 1);
+  ranges.edges.resize(unitsToSplit + 1);
+
+  uint64_t numNodes = graph.size();
+  uint64_t numEdges = graph.sizeEdges();
+  uint64_t share    = (numEdges + unitsToSplit - 1) / unitsToSplit;
+
+  ranges.nodes[0] = 0;
+  ranges.edges[0] = 0;
+  for (uint32_t i = 1; i < unitsToSplit; ++i) {
+    uint64_t target = numEdges * i / unitsToSplit;
+    // first node with an edge past the target
+    uint64_t node = *std::upper_bound(
+        boost::counting_iterator<uint64_t>(0),
+        boost::counting_iterator<uint64_t>(numNodes), target,
+        [&](uint64_t e, uint64_t n) {
+          return e < *graph.edge_end(n, MethodFlag::UNPROTECTED);
+        });
+    if (node == numNodes) {
+      ranges.nodes[i] = numNodes;
+      ranges.edges[i] = numEdges;
+      continue;
+    }
+
+    uint64_t nodeBegin = *graph.edge_begin(node, MethodFlag::UNPROTECTED);
+    uint64_t nodeEnd   = *graph.edge_end(node, MethodFlag::UNPROTECTED);
+    ranges.nodes[i]    = node;
+    ranges.edges[i]    = (nodeEnd - nodeBegin > share) ? target : nodeBegin;
+  }
+  ranges.nodes[unitsToSplit] = numNodes;
+  ranges.edges[unitsToSplit] = numEdges;
+
+  return ranges;
+}
+
+} // namespace internal
+
+/**
+ * Work item of iterate_edge_balanced_split: a node and the part of its edges
+ * the item is responsible for. All edges of a node are in one item unless the
+ * node is a hub that was split among threads.
+ */
+template <typename GraphTy>
+struct NodeEdgeRange {
+  using GraphNode     = typename GraphTy::GraphNode;
+  using edge_iterator = typename GraphTy::edge_iterator;
+
+  GraphNode node;
+  edge_iterator edgeBegin;
+  edge_iterator edgeEnd;
+
+  edge_iterator begin() const { return edgeBegin; }
+  edge_iterator end() const { return edgeEnd; }
+};
+
+/**
+ * Iterator over the NodeEdgeRange items of a range of nodes whose edges are
+ * clipped to a range of edges.
+ */
+template <typename GraphTy>
+class NodeEdgeRangeIterator
+    : public boost::iterator_facade<
+          NodeEdgeRangeIterator<GraphTy>, NodeEdgeRange<GraphTy>,
+          std::random_access_iterator_tag, NodeEdgeRange<GraphTy>> {
+  friend class boost::iterator_core_access;
+  using edge_iterator = typename GraphTy::edge_iterator;
+
+  GraphTy* graph;
+  uint64_t node;
+  uint64_t edgeLower;
+  uint64_t edgeUpper;
+
+  void increment() { ++node; }
+  void decrement() { --node; }
+  void advance(std::ptrdiff_t n) { node += n; }
+
+  bool equal(const NodeEdgeRangeIterator& o) const { return node == o.node; }
+
+  std::ptrdiff_t distance_to(const NodeEdgeRangeIterator& o) const {
+    return (std::ptrdiff_t)o.node - (std::ptrdiff_t)node;
+  }
+
+  NodeEdgeRange<GraphTy> dereference() const {
+    uint64_t b = *graph->edge_begin(node, MethodFlag::UNPROTECTED);
+    uint64_t e = *graph->edge_end(node, MethodFlag::UNPROTECTED);
+    return NodeEdgeRange<GraphTy>{
+        static_cast<typename GraphTy::GraphNode>(node),
+        edge_iterator(std::max(b, edgeLower)),
+        edge_iterator(std::min(e, edgeUpper))};
+  }
+
+public:
+  NodeEdgeRangeIterator()
+      : graph(nullptr), node(0), edgeLower(0), edgeUpper(0) {}
+  NodeEdgeRangeIterator(GraphTy* g, uint64_t n, uint64_t lower, uint64_t upper)
+      : graph(g), node(n), edgeLower(lower), edgeUpper(upper) {}
+};
+
+/**
+ * Range of iterate_edge_balanced_split: every thread gets the same number of
+ * edges, and a hub node with more edges than that is split among threads.
+ */
+template <typename GraphTy>
+class HubSplitRange {
+  GraphTy* graph;
+  const HubSplitRanges* ranges;
+
+public:
+  typedef NodeEdgeRangeIterator<GraphTy> iterator;
+  typedef iterator local_iterator;
+  typedef iterator block_iterator;
+  typedef NodeEdgeRange<GraphTy> value_type;
+
+  HubSplitRange(GraphTy& g, const HubSplitRanges& r) : graph(&g), ranges(&r) {}
+
+  iterator begin() const { return iterator(graph, 0, 0, graph->sizeEdges()); }
+  iterator end() const {
+    return iterator(graph, graph->size(), 0, graph->sizeEdges());
+  }
+
+  std::pair<block_iterator, block_iterator> block_pair() const {
+    unsigned tid   = substrate::ThreadPool::getTID();
+    uint64_t lower = ranges->edges[tid];
+    uint64_t upper = ranges->edges[tid + 1];
+    uint64_t first = ranges->nodes[tid];
+    uint64_t last  = ranges->nodes[tid + 1];
+    uint64_t lastBegin =
+        (last == graph->size())
+            ? upper
+            : *graph->edge_begin(last, MethodFlag::UNPROTECTED);
+    // the next thread's first node is ours too if we have some of its edges
+    if (lower < upper && lastBegin < upper)
+      ++last;
+    return std::make_pair(iterator(graph, first, lower, upper),
+                          iterator(graph, last, lower, upper));
+  }
+
+  std::pair<local_iterator, local_iterator> local_pair() const {
+    return block_pair();
+  }
+
+  local_iterator local_begin() const { return block_begin(); }
+  local_iterator local_end() const { return block_end(); }
+
+  block_iterator block_begin() const { return block_pair().first; }
+  block_iterator block_end() const { return block_pair().second; }
+};
+
+} // namespace graphs
+
+namespace internal {
+
+template <typename GraphTy>
+class EdgeBalancedRangeMaker {
+  GraphTy& m_graph;
+
+public:
+  explicit EdgeBalancedRangeMaker(GraphTy& graph) : m_graph(graph) {}
+
+  template <typename Arg>
+  auto operator()(const Arg& argTuple) const {
+    return runtime::makeSpecificRange(m_graph.begin(), m_graph.end(),
+                                      m_graph.getEdgeBalancedRanges().data());
+  }
+};
+
+template <typename GraphTy>
+class HubSplitRangeMaker {
+  GraphTy& m_graph;
+
+public:
+  explicit HubSplitRangeMaker(GraphTy& graph) : m_graph(graph) {}
+
+  template <typename Arg>
+  auto operator()(const Arg& argTuple) const {
+    return graphs::HubSplitRange<GraphTy>(m_graph,
+                                          m_graph.getHubSplitRanges());
+  }
+};
+
+} // end namespace internal
+
+/**
+ * Iterates over the nodes of an LC_CSR_Graph or LC_InOut_Graph giving each
+ * thread a contiguous range of nodes with about the same number of edges
+ * (out-edges, or in- and out-edges of an asymmetric LC_InOut_Graph). The
+ * ranges are cached by the graph for the current number of threads; threads
+ * can still steal from each other with galois::steal().
+ *
+ * Call outside of parallel regions.
+ */
+template <typename GraphTy>
+auto iterate_edge_balanced(GraphTy& graph) {
+  return internal::EdgeBalancedRangeMaker<GraphTy>(graph);
+}
+
+/**
+ * Like iterate_edge_balanced, but the out-edges are divided exactly evenly
+ * among threads by splitting hub nodes that have more edges than a thread's
+ * share. The operator gets a graphs::NodeEdgeRange with the node and the part
+ * of its edges to work on, so it must combine the partial results of a hub,
+ * e.g. with atomics.
+ *
+ * Call outside of parallel regions.
+ */
+template <typename GraphTy>
+auto iterate_edge_balanced_split(GraphTy& graph) {
+  return internal::HubSplitRangeMaker<GraphTy>(graph);
+}
+
+} // end namespace galois
+
+#endif
@@ -31,6 +31,7 @@
 #include "galois/Endian.h"
 #include "galois/MethodFlags.h"
 #include "galois/LargeArray.h"
+#include "galois/ParallelSTL.h"
 #include "galois/graphs/Details.h"
 #include "galois/runtime/Context.h"
 #include "galois/substrate/CacheLineStorage.h"
@@ -139,6 +140,13 @@ private:
    */
   void fromMem(void* m, uint64_t nodeOffset, uint64_t edgeOffset, uint64_t);
 
+  /**
+   * Given an mmap'd compressed (version 3) graph of len bytes, decodes it
+   * into a version 1 (or 2 if node ids need 64 bits) block that replaces the
+   * last mapping and initializes the graph from it.
+   */
+  void fromCompressedMem(void* m, size_t len);
+
   /**
    * Loads a graph from another file graph
    *
@@ -643,6 +651,15 @@ public:
    * @todo perform host -> le on data
    */
   void toFile(const std::string& file);
+
+  /**
+   * Write the graph to a file in the compressed (version 3) format: the
+   * neighbors of each node are sorted and delta + varint encoded, and edge
+   * data is permuted to follow them.
+   *
+   * @param file File to write to
+   */
+  void toCompressedFile(const std::string& file);
 };
 
 /**
@@ -697,11 +714,8 @@ public:
       return;
 
     // Turn counts into partial sums
-    auto prev = outIdx.begin();
-    for (auto ii = outIdx.begin() + 1, ei = outIdx.end(); ii != ei;
-         ++ii, ++prev) {
-      *ii += *prev;
-    }
+    galois::ParallelSTL::inclusive_scan(outIdx.begin(), outIdx.end(),
+                                        outIdx.begin());
     assert(outIdx[numNodes - 1] == numEdges);
 
     if (numNodes <= std::numeric_limits<uint32_t>::max()) {
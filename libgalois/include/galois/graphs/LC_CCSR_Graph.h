@@ -0,0 +1,348 @@
+/*
+ * This file belongs to the Galois project, a C++ library for exploiting parallelism.
+ * The code is being released under the terms of the 3-Clause BSD License (a
+ * copy is located in LICENSE.txt at the top-level directory).
+ *
+ * Copyright (C) 2018, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ */
+
+
+/**
+ * @file LC_CCSR_Graph.h
+ *
+ * Local computation graph whose adjacency lists are delta + varint
+ * compressed.
+ */
+
+#ifndef GALOIS_GRAPHS_LC_CCSR_GRAPH_H
+#define GALOIS_GRAPHS_LC_CCSR_GRAPH_H
+
+#include "galois/Galois.h"
+#include "galois/graphs/CompressedAdjacency.h"
+#include "galois/graphs/Details.h"
+#include "galois/graphs/FileGraph.h"
+#include "galois/substrate/PerThreadStorage.h"
+
+#include <boost/iterator/counting_iterator.hpp>
+#include <boost/iterator/transform_iterator.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace galois {
+namespace graphs {
+
+struct read_compressed_graph_tag {};
+
+/**
+ * Local computation graph (i.e., graph structure does not change) whose
+ * neighbors are stored sorted, delta encoded and packed as varints (see
+ * CompressedAdjacency.h). Destinations are decoded while iterating over
+ * edges, trading a little computation for several times less memory
+ * traffic on large sparse graphs.
+ *
+ * Only forward iteration over the edges of a node is supported, so
+ * algorithms that split adjacency lists into tiles or binary search them
+ * should use LC_CSR_Graph instead. The graph never acquires abstract locks.
+ *
+ * Compressed (version 3) files are loaded directly; other files are
+ * compressed while loading.
+ *
+ * @tparam NodeTy data on nodes
+ * @tparam EdgeTy data on out edges
+ */
+template <typename NodeTy, typename EdgeTy>
+class LC_CCSR_Graph : private boost::noncopyable,
+                      private internal::LocalIteratorFeature<false> {
+public:
+  template <typename _node_data>
+  struct with_node_data {
+    typedef LC_CCSR_Graph<_node_data, EdgeTy> type;
+  };
+
+  template <typename _edge_data>
+  struct with_edge_data {
+    typedef LC_CCSR_Graph<NodeTy, _edge_data> type;
+  };
+
+  //! The graph never locks, so this is the graph itself
+  template <bool _has_no_lockable>
+  struct with_no_lockable {
+    typedef LC_CCSR_Graph type;
+  };
+
+  typedef read_compressed_graph_tag read_tag;
+
+protected:
+  typedef LargeArray<NodeTy> NodeData;
+  typedef LargeArray<EdgeTy> EdgeData;
+  typedef LargeArray<uint64_t> EdgeIndData;
+  typedef LargeArray<uint8_t> EdgeBytes;
+
+public:
+  typedef uint32_t GraphNode;
+  typedef EdgeTy edge_data_type;
+  typedef NodeTy node_data_type;
+  typedef typename EdgeData::reference edge_data_reference;
+  typedef typename NodeData::reference node_data_reference;
+  typedef CompressedEdgeIterator edge_iterator;
+  typedef boost::counting_iterator<uint32_t> iterator;
+  typedef iterator const_iterator;
+  typedef iterator local_iterator;
+  typedef iterator const_local_iterator;
+
+protected:
+  NodeData nodeData;
+  EdgeIndData edgeIndData;
+  EdgeIndData byteIndData;
+  EdgeBytes edgeBytes;
+  EdgeData edgeData;
+
+  uint64_t numNodes;
+  uint64_t numEdges;
+
+  uint64_t edgeStart(GraphNode N) const {
+    return (N == 0) ? 0 : edgeIndData[N - 1];
+  }
+
+  uint64_t byteStart(GraphNode N) const {
+    return (N == 0) ? 0 : byteIndData[N - 1];
+  }
+
+  void allocate(uint64_t nNodes, uint64_t nEdges, uint64_t nBytes) {
+    numNodes = nNodes;
+    numEdges = nEdges;
+    nodeData.allocateInterleaved(numNodes);
+    edgeIndData.allocateInterleaved(numNodes);
+    byteIndData.allocateInterleaved(numNodes);
+    // one spare byte so that edgeBytes.data() is valid on edgeless graphs
+    edgeBytes.allocateInterleaved(nBytes + 1);
+    edgeData.allocateInterleaved(numEdges);
+    for (uint64_t n = 0; n < numNodes; ++n)
+      nodeData.constructAt(n);
+  }
+
+  //! Loads a compressed (version 3) graph file of len bytes mapped at m
+  void fromCompressedMem(const char* m, size_t len) {
+    const uint64_t* fptr = reinterpret_cast<const uint64_t*>(m);
+    if (len < 4 * sizeof(uint64_t))
+      GALOIS_DIE("truncated compressed graph file");
+    uint64_t version = convert_le64toh(fptr[0]);
+    if (version != 3)
+      GALOIS_DIE("unknown file version ", version);
+    uint64_t sizeofEdge = convert_le64toh(fptr[1]);
+    uint64_t nNodes     = convert_le64toh(fptr[2]);
+    uint64_t nEdges     = convert_le64toh(fptr[3]);
+    // both indices must be mapped before the byte count is read from them
+    if (nNodes > (len - 4 * sizeof(uint64_t)) / (2 * sizeof(uint64_t)))
+      GALOIS_DIE("truncated compressed graph file");
+    const uint64_t* idx  = fptr + 4;
+    const uint64_t* bidx = idx + nNodes;
+    uint64_t nBytes      = nNodes ? convert_le64toh(bidx[nNodes - 1]) : 0;
+    CompressedFileLayout layout(nNodes, nEdges, nBytes, sizeofEdge);
+    if (nBytes > len || (sizeofEdge && nEdges > len / sizeofEdge) ||
+        layout.total > len)
+      GALOIS_DIE("truncated compressed graph file");
+
+    allocate(nNodes, nEdges, nBytes);
+    galois::do_all(galois::iterate(UINT64_C(0), numNodes),
+                   [&](uint64_t n) {
+                     edgeIndData[n] = convert_le64toh(idx[n]);
+                     byteIndData[n] = convert_le64toh(bidx[n]);
+                   },
+                   galois::no_stats(), galois::loopname("CCSR_COPY_INDEX"));
+    std::memcpy(edgeBytes.data(), m + layout.outBytes, nBytes);
+
+    if (EdgeData::has_value) {
+      GALOIS_ASSERT(sizeofEdge == EdgeData::size_of::value,
+                    "edge data size mismatch");
+      std::memcpy(edgeData.data(), m + layout.edgeData, sizeofEdge * nEdges);
+    }
+  }
+
+  //! Compresses an uncompressed graph while loading it
+  void fromFileGraph(FileGraph& graph) {
+    typedef std::vector<std::pair<uint64_t, uint64_t>> Neighbors;
+    substrate::PerThreadStorage<Neighbors> scratch;
+    uint64_t nNodes = graph.size();
+
+    auto sortedNeighbors = [&](uint64_t n) -> Neighbors& {
+      Neighbors& nbrs = *scratch.getLocal();
+      nbrs.clear();
+      for (auto ii = graph.edge_begin(n), ei = graph.edge_end(n); ii != ei;
+           ++ii)
+        nbrs.emplace_back(graph.getEdgeDst(ii), *ii);
+      std::sort(nbrs.begin(), nbrs.end());
+      return nbrs;
+    };
+    auto encode = [&](uint64_t n, const Neighbors& nbrs, uint8_t* out) {
+      auto dst = [](const std::pair<uint64_t, uint64_t>& p) {
+        return p.first;
+      };
+      return encodeNeighbors(
+          n, boost::make_transform_iterator(nbrs.begin(), dst),
+          boost::make_transform_iterator(nbrs.end(), dst), out);
+    };
+
+    // size each list, then prefix sum to find where it goes
+    LargeArray<uint64_t> sizes;
+    sizes.allocateInterleaved(nNodes);
+    galois::do_all(galois::iterate(UINT64_C(0), nNodes),
+                   [&](uint64_t n) {
+                     sizes[n] = encode(n, sortedNeighbors(n), nullptr);
+                   },
+                   galois::no_stats(), galois::steal(),
+                   galois::loopname("CCSR_SIZE"));
+    uint64_t nBytes = 0;
+    for (uint64_t n = 0; n < nNodes; ++n) {
+      nBytes += sizes[n];
+      sizes[n] = nBytes;
+    }
+
+    allocate(nNodes, graph.sizeEdges(), nBytes);
+    std::swap(byteIndData, sizes);
+    galois::do_all(
+        galois::iterate(UINT64_C(0), nNodes),
+        [&](uint64_t n) {
+          const Neighbors& nbrs = sortedNeighbors(n);
+          uint64_t e            = *graph.edge_begin(n);
+          edgeIndData[n]        = e + nbrs.size();
+          encode(n, nbrs, edgeBytes.data() + byteStart(n));
+          if (EdgeData::has_value) {
+            for (auto& p : nbrs)
+              edgeData.set(e++,
+                           graph.getEdgeData<typename EdgeData::value_type>(
+                               FileGraph::edge_iterator(p.second)));
+          }
+        },
+        galois::no_stats(), galois::steal(), galois::loopname("CCSR_ENCODE"));
+  }
+
+public:
+  LC_CCSR_Graph() : numNodes(0), numEdges(0) {}
+
+  ~LC_CCSR_Graph() {
+    nodeData.destroy();
+    nodeData.deallocate();
+  }
+
+  node_data_reference getData(GraphNode N,
+                              MethodFlag = MethodFlag::WRITE) {
+    return nodeData[N];
+  }
+
+  edge_data_reference getEdgeData(edge_iterator ni,
+                                  MethodFlag = MethodFlag::UNPROTECTED) {
+    return edgeData[*ni];
+  }
+
+  GraphNode getEdgeDst(edge_iterator ni) {
+    return static_cast<GraphNode>(ni.dst());
+  }
+
+  size_t size() const { return numNodes; }
+  size_t sizeEdges() const { return numEdges; }
+  //! Size of the encoded adjacency lists in bytes
+  size_t sizeEdgeBytes() const {
+    return numNodes ? byteIndData[numNodes - 1] : 0;
+  }
+
+  iterator begin() const { return iterator(0); }
+  iterator end() const { return iterator(numNodes); }
+
+  const_local_iterator local_begin() const {
+    return const_local_iterator(this->localBegin(numNodes));
+  }
+
+  const_local_iterator local_end() const {
+    return const_local_iterator(this->localEnd(numNodes));
+  }
+
+  edge_iterator edge_begin(GraphNode N,
+                           MethodFlag = MethodFlag::WRITE) {
+    return edge_iterator(N, edgeStart(N), edgeIndData[N],
+                         edgeBytes.data() + byteStart(N));
+  }
+
+  edge_iterator edge_end(GraphNode N,
+                         MethodFlag = MethodFlag::WRITE) {
+    return edge_iterator(edgeIndData[N]);
+  }
+
+  runtime::iterable<NoDerefIterator<edge_iterator>>
+  edges(GraphNode N, MethodFlag mflag = MethodFlag::WRITE) {
+    return internal::make_no_deref_range(edge_begin(N, mflag),
+                                         edge_end(N, mflag));
+  }
+
+  runtime::iterable<NoDerefIterator<edge_iterator>>
+  out_edges(GraphNode N, MethodFlag mflag = MethodFlag::WRITE) {
+    return edges(N, mflag);
+  }
+
+  /**
+   * Reads a graph file; compressed (version 3) files are copied as is,
+   * others are compressed on the fly.
+   *
+   * @param filename graph file to read
+   */
+  void readFromFile(const std::string& filename) {
+    uint64_t version = 0;
+    {
+      std::ifstream in(filename, std::ios::binary);
+      if (!in.read(reinterpret_cast<char*>(&version), sizeof(version)))
+        GALOIS_DIE("failed reading ", "'", filename, "'");
+      version = convert_le64toh(version);
+    }
+
+    if (version != 3) {
+      FileGraph graph;
+      graph.fromFile(filename);
+      fromFileGraph(graph);
+      return;
+    }
+
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd == -1)
+      GALOIS_SYS_DIE("failed opening ", "'", filename, "'");
+    struct stat buf;
+    if (fstat(fd, &buf) == -1)
+      GALOIS_SYS_DIE("failed reading ", "'", filename, "'");
+    void* base = mmap(nullptr, buf.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (base == MAP_FAILED)
+      GALOIS_SYS_DIE("failed reading ", "'", filename, "'");
+    madvise(base, buf.st_size, MADV_SEQUENTIAL);
+    fromCompressedMem(static_cast<const char*>(base), buf.st_size);
+    munmap(base, buf.st_size);
+    close(fd);
+  }
+};
+
+template <typename GraphTy, typename... Args>
+void readGraphDispatch(GraphTy& graph, read_compressed_graph_tag,
+                       Args&&... args) {
+  graph.readFromFile(std::forward<Args>(args)...);
+}
+
+} // namespace graphs
+} // namespace galois
+
+#endif
@@ -22,6 +22,7 @@
 
 #include "galois/Galois.h"
 #include "galois/graphs/Details.h"
+#include "galois/graphs/EdgeBalancedRange.h"
 #include "galois/graphs/FileGraph.h"
 #include "galois/graphs/GraphHelpers.h"
 
@@ -166,6 +167,17 @@ protected:
   uint64_t numNodes;
   uint64_t numEdges;
 
+  //! ranges of iterate_edge_balanced for the current number of threads
+  std::vector<uint32_t> edgeBalancedRanges;
+  //! ranges of iterate_edge_balanced_split for the current number of threads
+  HubSplitRanges hubSplitRanges;
+
+  //! forgets the cached thread ranges once the edges change
+  void resetEdgeBalancedRanges() {
+    edgeBalancedRanges.clear();
+    hubSplitRanges.clear();
+  }
+
   typedef internal::EdgeSortIterator<
       GraphNode, typename EdgeIndData::value_type, EdgeDst, EdgeData>
       edge_sort_iterator;
@@ -239,6 +251,7 @@ private:
 
   template <typename Archive>
   void load(Archive& ar, const unsigned int version) {
+    resetEdgeBalancedRanges();
     ar >> numNodes;
     ar >> numEdges;
 
@@ -313,6 +326,7 @@ public:
    * @param ar Boost archive to deserialize from.
    */
   void deSerializeGraph(boost::archive::binary_iarchive& ar) {
+    resetEdgeBalancedRanges();
     ar >> numNodes;
     ar >> numEdges;
 
@@ -389,6 +403,8 @@ public:
     swap(lhs.edgeData, rhs.edgeData);
     std::swap(lhs.numNodes, rhs.numNodes);
     std::swap(lhs.numEdges, rhs.numEdges);
+    std::swap(lhs.edgeBalancedRanges, rhs.edgeBalancedRanges);
+    std::swap(lhs.hubSplitRanges, rhs.hubSplitRanges);
   }
 
   node_data_reference getData(GraphNode N,
@@ -407,12 +423,54 @@ public:
 
   GraphNode getEdgeDst(edge_iterator ni) { return edgeDst[*ni]; }
 
+  /**
+   * Destinations of edges are stored contiguously: [getEdgeDstPtr(
+   * edge_begin(N)), getEdgeDstPtr(edge_end(N))) are the neighbors of N, e.g.
+   * for the sorted set intersections of galois/SetIntersection.h.
+   */
+  const GraphNode* getEdgeDstPtr(edge_iterator ni) const {
+    return edgeDst.data() + *ni;
+  }
+
   size_t size() const { return numNodes; }
   size_t sizeEdges() const { return numEdges; }
 
   iterator begin() const { return iterator(0); }
   iterator end() const { return iterator(numNodes); }
 
+  /**
+   * Returns node ranges for the active threads that give each thread about
+   * the same number of edges (@see galois::iterate_edge_balanced). Cached
+   * until the number of threads or the edges change.
+   *
+   * ONLY USE IF GRAPH HAS BEEN LOADED
+   *
+   * @returns vector that indirectly specifies which threads get which nodes
+   */
+  const std::vector<uint32_t>& getEdgeBalancedRanges() {
+    if (edgeBalancedRanges.size() != galois::getActiveThreads() + 1) {
+      edgeBalancedRanges = internal::determineEdgeBalancedRanges(
+          *this, galois::getActiveThreads());
+    }
+    return edgeBalancedRanges;
+  }
+
+  /**
+   * Returns edge ranges for the active threads that divide the edges evenly
+   * among threads by splitting hub nodes (@see
+   * galois::iterate_edge_balanced_split). Cached until the number of threads
+   * or the edges change.
+   *
+   * ONLY USE IF GRAPH HAS BEEN LOADED
+   */
+  const HubSplitRanges& getHubSplitRanges() {
+    if (hubSplitRanges.nodes.size() != galois::getActiveThreads() + 1) {
+      hubSplitRanges = internal::determineHubSplitRanges(
+          *this, galois::getActiveThreads());
+    }
+    return hubSplitRanges;
+  }
+
   const_local_iterator local_begin() const {
     return const_local_iterator(this->localBegin(numNodes));
   }
@@ -523,6 +581,7 @@ public:
   }
 
   void allocateFrom(FileGraph& graph) {
+    resetEdgeBalancedRanges();
     numNodes = graph.size();
     numEdges = graph.sizeEdges();
     if (UseNumaAlloc) {
@@ -541,6 +600,7 @@ public:
   }
 
   void allocateFrom(uint32_t nNodes, uint64_t nEdges) {
+    resetEdgeBalancedRanges();
     numNodes = nNodes;
     numEdges = nEdges;
 
@@ -576,6 +636,7 @@ public:
   }
 
   void deallocate() {
+    resetEdgeBalancedRanges();
     nodeData.destroy();
     nodeData.deallocate();
 
@@ -606,6 +667,7 @@ public:
   void transpose(const char* regionName = NULL) {
     galois::StatTimer timer("TIMER_GRAPH_TRANSPOSE", regionName);
     timer.start();
+    resetEdgeBalancedRanges();
 
     EdgeDst edgeDst_old;
     EdgeData edgeData_new;
@@ -645,27 +707,17 @@ public:
                    galois::no_stats(),
                    galois::loopname("TRANSPOSE_EDGEINTDATA_INC"));
 
-    // TODO is it worth doing parallel prefix sum?
-    // prefix sum calculation of the edge index array
-    for (uint32_t n = 1; n < numNodes; ++n) {
-      edgeIndData_temp[n] += edgeIndData_temp[n - 1];
-    }
-
-    // copy over the new tranposed edge index data
-    galois::do_all(galois::iterate(0ul, numNodes),
-                   [&](uint32_t n) { edgeIndData[n] = edgeIndData_temp[n]; },
-                   galois::no_stats(),
-                   galois::loopname("TRANSPOSE_EDGEINTDATA_SET"));
+    // the inclusive prefix sum of the counts is the new tranposed edge index
+    // data
+    galois::ParallelSTL::inclusive_scan(edgeIndData_temp.begin(),
+                                        edgeIndData_temp.end(),
+                                        edgeIndData.begin());
 
     // edgeIndData_temp[i] will now hold number of edges that all nodes
     // before the ith node have
-    if (numNodes >= 1) {
-      edgeIndData_temp[0] = 0;
-      galois::do_all(
-          galois::iterate(1ul, numNodes),
-          [&](uint32_t n) { edgeIndData_temp[n] = edgeIndData[n - 1]; },
-          galois::no_stats(), galois::loopname("TRANSPOSE_EDGEINTDATA_TEMP"));
-    }
+    galois::ParallelSTL::exclusive_scan(edgeIndData_temp.begin(),
+                                        edgeIndData_temp.end(),
+                                        edgeIndData_temp.begin(), uint64_t{0});
 
     galois::do_all(galois::iterate(0ul, numNodes),
                    [&](uint32_t src) {
@@ -714,6 +766,84 @@ public:
     // does nothing
   }
 
+  /**
+   * Renumbers the nodes in place: node n becomes node perm[n]. Node data and
+   * edge data move with their nodes and edges, and the edges of every node
+   * are sorted by destination afterwards.
+   *
+   * @param perm permutation of the node ids, e.g. from galois::graphs::relabel
+   */
+  template <typename PermTy>
+  void permuteNodes(const PermTy& perm, const char* regionName = NULL) {
+    galois::StatTimer timer("TIMER_GRAPH_PERMUTE", regionName);
+    timer.start();
+    resetEdgeBalancedRanges();
+
+    NodeData nodeData_new;
+    EdgeIndData edgeIndData_new;
+    EdgeDst edgeDst_new;
+    EdgeData edgeData_new;
+
+    if (UseNumaAlloc) {
+      nodeData_new.allocateBlocked(numNodes);
+      edgeIndData_new.allocateBlocked(numNodes);
+      edgeDst_new.allocateBlocked(numEdges);
+      edgeData_new.allocateBlocked(numEdges);
+    } else {
+      nodeData_new.allocateInterleaved(numNodes);
+      edgeIndData_new.allocateInterleaved(numNodes);
+      edgeDst_new.allocateInterleaved(numEdges);
+      edgeData_new.allocateInterleaved(numEdges);
+    }
+
+    // degrees in the new order
+    galois::do_all(galois::iterate(0ul, numNodes),
+                   [&](uint32_t n) {
+                     edgeIndData_new[perm[n]] = *raw_end(n) - *raw_begin(n);
+                   },
+                   galois::no_stats(), galois::loopname("PERMUTE_DEGREES"));
+
+    galois::ParallelSTL::inclusive_scan(edgeIndData_new.begin(),
+                                        edgeIndData_new.end(),
+                                        edgeIndData_new.begin());
+
+    galois::do_all(galois::iterate(0ul, numNodes),
+                   [&](uint32_t n) {
+                     uint32_t n_new = perm[n];
+                     uint64_t e_new =
+                         (n_new == 0) ? 0 : edgeIndData_new[n_new - 1];
+                     for (uint64_t e = *raw_begin(n); e < *raw_end(n); ++e) {
+                       edgeDst_new[e_new] = perm[edgeDst[e]];
+                       edgeDataCopy(edgeData_new, edgeData, e_new, e);
+                       e_new++;
+                     }
+                     nodeDataMove(nodeData_new, n_new, n);
+                   },
+                   galois::steal(), galois::no_stats(),
+                   galois::loopname("PERMUTE_EDGES"));
+
+    swap(nodeData, nodeData_new);
+    swap(edgeIndData, edgeIndData_new);
+    swap(edgeDst, edgeDst_new);
+    swap(edgeData, edgeData_new);
+
+    sortAllEdgesByDst(MethodFlag::UNPROTECTED);
+
+    timer.stop();
+  }
+
+  template <bool is_void = std::is_void<NodeTy>::value>
+  void nodeDataMove(NodeData& nodeData_new, uint32_t n_new, uint32_t n,
+                    typename std::enable_if<!is_void>::type* = 0) {
+    nodeData_new.constructAt(n_new, std::move(nodeData[n].getData()));
+  }
+
+  template <bool is_void = std::is_void<NodeTy>::value>
+  void nodeDataMove(NodeData& nodeData_new, uint32_t n_new, uint32_t n,
+                    typename std::enable_if<is_void>::type* = 0) {
+    nodeData_new.constructAt(n_new);
+  }
+
   void constructFrom(FileGraph& graph, unsigned tid, unsigned total) {
     // at this point memory should already be allocated
     auto r =
@@ -748,6 +878,54 @@ public:
    * @returns reference to LargeArray edgeIndData
    */
   const EdgeIndData& getEdgePrefixSum() const { return edgeIndData; }
+
+  /**
+   * Returns the reference to the edgeDst LargeArray
+   * (destination of every edge in CSR order)
+   *
+   * @returns reference to LargeArray edgeDst
+   */
+  const EdgeDst& getEdgeDestinations() const { return edgeDst; }
+
+  /**
+   * Returns the reference to the edgeData LargeArray
+   *
+   * @returns reference to LargeArray edgeData
+   */
+  const EdgeData& getEdgeDataArray() const { return edgeData; }
+
+  /**
+   * Points the topology at memory owned by the caller (e.g. a mapped file)
+   * instead of allocating it. Node data is allocated as usual. The memory
+   * must outlive the graph.
+   *
+   * @param nNodes number of nodes
+   * @param nEdges number of edges
+   * @param indData nNodes edge end offsets (a prefix sum of edges)
+   * @param dst nEdges edge destinations
+   * @param data nEdges edge data; ignored for void edge data
+   */
+  void wrapTopology(uint64_t nNodes, uint64_t nEdges, void* indData, void* dst,
+                    void* data) {
+    resetEdgeBalancedRanges();
+    numNodes = nNodes;
+    numEdges = nEdges;
+
+    EdgeIndData wrappedIndData(indData, numNodes);
+    EdgeDst wrappedDst(dst, numEdges);
+    EdgeData wrappedData(data, numEdges);
+    swap(edgeIndData, wrappedIndData);
+    swap(edgeDst, wrappedDst);
+    swap(edgeData, wrappedData);
+
+    if (UseNumaAlloc) {
+      nodeData.allocateBlocked(numNodes);
+      this->outOfLineAllocateBlocked(numNodes);
+    } else {
+      nodeData.allocateInterleaved(numNodes);
+      this->outOfLineAllocateInterleaved(numNodes);
+    }
+  }
 };
 } // namespace graphs
 } // namespace galois
@@ -69,6 +69,16 @@ private:
 
   void createAsymmetric() { asymmetric = true; }
 
+  //! Prefix sum of the in- and out-edges of the nodes
+  struct InOutPrefixSum {
+    LC_InOut_Graph& graph;
+
+    size_t size() const { return graph.size(); }
+    uint64_t operator[](uint64_t n) {
+      return *graph.raw_end(n) + *graph.inGraph.raw_end(graph.inGraphNode(n));
+    }
+  };
+
 public:
   typedef Super out_graph_type;
   typedef InGraph in_graph_type;
@@ -287,6 +297,24 @@ public:
                    galois::steal());
   }
 
+  /**
+   * Returns node ranges for the active threads that give each thread about
+   * the same number of in- and out-edges (@see
+   * galois::iterate_edge_balanced). Cached until the number of threads or the
+   * edges change.
+   */
+  const std::vector<uint32_t>& getEdgeBalancedRanges() {
+    if (!asymmetric) {
+      return Super::getEdgeBalancedRanges();
+    }
+    if (this->edgeBalancedRanges.size() != galois::getActiveThreads() + 1) {
+      InOutPrefixSum prefixSum{*this};
+      this->edgeBalancedRanges = internal::determineEdgeBalancedRanges(
+          prefixSum, galois::getActiveThreads());
+    }
+    return this->edgeBalancedRanges;
+  }
+
   size_t idFromNode(GraphNode N) { return this->getId(N); }
 
   GraphNode nodeFromId(size_t N) { return this->getNode(N); }
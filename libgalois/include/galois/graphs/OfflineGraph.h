@@ -20,17 +20,23 @@
 #ifndef _GALOIS_DIST_OFFLINE_GRAPH_
 #define _GALOIS_DIST_OFFLINE_GRAPH_
 
+#include "galois/substrate/PerThreadStorage.h"
 #include "galois/substrate/SimpleLock.h"
+#include "galois/substrate/EnvCheck.h"
 #include "galois/graphs/Details.h"
 #include "galois/graphs/GraphHelpers.h"
+#include "galois/Timer.h"
+#include "galois/gIO.h"
 
 #include <cstdint>
+#include <cstring>
 #include <iostream>
 #include <fstream>
 #include <mutex>
 #include <numeric>
 #include <sys/mman.h>
 #include <fcntl.h>
+#include <unistd.h>
 
 #include <boost/iterator/counting_iterator.hpp>
 
@@ -58,9 +64,89 @@ namespace graphs {
 // outedges[numEdges] {uint64_t LE}
 // EdgeType[numEdges] {EdgeType size}
 
+//! Ways OfflineGraph can access the graph file on disk
+enum OfflineGraphBackend {
+  //! seek + small read through std::ifstream for every access
+  OFFLINE_GRAPH_STREAM,
+  //! read-only mapping of the whole file with read-ahead hints
+  OFFLINE_GRAPH_MMAP,
+  //! OFFLINE_GRAPH_MMAP if GALOIS_OFFLINE_GRAPH_MMAP is set in the
+  //! environment, else OFFLINE_GRAPH_STREAM
+  OFFLINE_GRAPH_DEFAULT
+};
+
+namespace internal {
+
+/**
+ * Owns a read-only mapping of a file; moving transfers ownership so that
+ * OfflineGraph can keep its defaulted move constructor.
+ */
+class OfflineGraphMapping {
+  char* base   = nullptr;
+  size_t bytes = 0;
+
+public:
+  OfflineGraphMapping() = default;
+  OfflineGraphMapping(const OfflineGraphMapping&) = delete;
+  OfflineGraphMapping& operator=(const OfflineGraphMapping&) = delete;
+
+  OfflineGraphMapping(OfflineGraphMapping&& o) : base(o.base), bytes(o.bytes) {
+    o.base  = nullptr;
+    o.bytes = 0;
+  }
+
+  ~OfflineGraphMapping() { unmap(); }
+
+  /**
+   * Maps the file read-only and tells the kernel it will be scanned
+   * sequentially so that it reads ahead aggressively.
+   *
+   * @returns false if the file could not be mapped
+   */
+  bool map(const std::string& name, size_t length) {
+    int fd = open(name.c_str(), O_RDONLY);
+    if (fd == -1)
+      return false;
+    void* m = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (m == MAP_FAILED)
+      return false;
+    base  = static_cast<char*>(m);
+    bytes = length;
+    madvise(base, bytes, MADV_SEQUENTIAL);
+    return true;
+  }
+
+  void unmap() {
+    if (base)
+      munmap(base, bytes);
+    base  = nullptr;
+    bytes = 0;
+  }
+
+  //! Ask the kernel to start reading [begin, end) of the file now; the
+  //! range is clamped to the mapping
+  void willNeed(size_t begin, size_t end) {
+    end = std::min(end, bytes);
+    if (!base || begin >= end)
+      return;
+    // madvise needs a page aligned start address
+    size_t pageSize = sysconf(_SC_PAGESIZE);
+    begin           = begin & ~(pageSize - 1);
+    madvise(base + begin, end - begin, MADV_WILLNEED);
+  }
+
+  bool mapped() const { return base != nullptr; }
+  const char* data() const { return base; }
+};
+
+} // namespace internal
+
 class OfflineGraph {
+  //! only opened when the file is not mapped
   std::ifstream fileEdgeDst, fileIndex, fileEdgeData;
   std::streamoff locEdgeDst, locIndex, locEdgeData;
+  internal::OfflineGraphMapping mapping;
 
   uint64_t numNodes;
   uint64_t numEdges;
@@ -69,12 +155,44 @@ class OfflineGraph {
   bool v2;
   uint64_t numSeeksEdgeDst, numSeeksIndex, numSeeksEdgeData;
   uint64_t numBytesReadEdgeDst, numBytesReadIndex, numBytesReadEdgeData;
+  //! bytes copied out of the mapping; per thread since reads are not locked
+  galois::substrate::PerThreadStorage<uint64_t> numBytesReadMapped;
+  uint64_t prefetchTime;
 
   galois::substrate::SimpleLock lock;
 
+  //! Copies a value out of the mapped file; no lock or syscall involved
+  template <typename T>
+  T mappedRead(size_t pos) {
+    T retval;
+    std::memcpy(&retval, mapping.data() + pos, sizeof(T));
+    *numBytesReadMapped.getLocal() += sizeof(T);
+    return retval;
+  }
+
+  //! Opens the streams that read the file when it is not mapped
+  void openStreams(const std::string& name) {
+    for (std::ifstream* file : {&fileEdgeDst, &fileIndex, &fileEdgeData}) {
+      file->open(name, std::ios_base::binary);
+      if (!file->is_open() || !file->good())
+        throw "Bad filename";
+      file->exceptions(std::ifstream::eofbit | std::ifstream::failbit |
+                       std::ifstream::badbit);
+    }
+  }
+
+  std::streamoff edgeDataStart() const {
+    std::streamoff pos = (4 + numNodes) * sizeof(uint64_t) +
+                         numEdges * (v2 ? sizeof(uint64_t) : sizeof(uint32_t));
+    return (pos + 7) & ~7;
+  }
+
   uint64_t outIndexs(uint64_t node) {
-    std::lock_guard<decltype(lock)> lg(lock);
     std::streamoff pos = (4 + node) * sizeof(uint64_t);
+    if (mapping.mapped())
+      return mappedRead<uint64_t>(pos);
+
+    std::lock_guard<decltype(lock)> lg(lock);
 
     // move to correct position in file
     if (locEdgeDst != pos) {
@@ -104,9 +222,15 @@ class OfflineGraph {
   }
 
   uint64_t outEdges(uint64_t edge) {
-    std::lock_guard<decltype(lock)> lg(lock);
     std::streamoff pos = (4 + numNodes) * sizeof(uint64_t) +
                          edge * (v2 ? sizeof(uint64_t) : sizeof(uint32_t));
+    if (mapping.mapped()) {
+      if (v2)
+        return mappedRead<uint64_t>(pos);
+      return mappedRead<uint32_t>(pos);
+    }
+
+    std::lock_guard<decltype(lock)> lg(lock);
 
     // move to correct position
     if (locIndex != pos) {
@@ -152,14 +276,12 @@ class OfflineGraph {
   template <typename T>
   T edgeData(uint64_t edge) {
     assert(sizeof(T) <= sizeEdgeData);
-    std::lock_guard<decltype(lock)> lg(lock);
-    std::streamoff pos = (4 + numNodes) * sizeof(uint64_t) +
-                         numEdges * (v2 ? sizeof(uint64_t) : sizeof(uint32_t));
-
-    // align + move to correct position
-    pos = (pos + 7) & ~7;
-    pos += edge * sizeEdgeData;
+    // aligned start of edge data + offset of this edge
+    std::streamoff pos = edgeDataStart() + edge * sizeEdgeData;
+    if (mapping.mapped())
+      return mappedRead<T>(pos);
 
+    std::lock_guard<decltype(lock)> lg(lock);
     if (locEdgeData != pos) {
       numSeeksEdgeData++;
       fileEdgeData.seekg(pos, fileEdgeDst.beg);
@@ -192,39 +314,35 @@ public:
   typedef boost::counting_iterator<uint64_t> edge_iterator;
   typedef uint64_t GraphNode;
 
-  OfflineGraph(const std::string& name)
-      : fileEdgeDst(name, std::ios_base::binary),
-        fileIndex(name, std::ios_base::binary),
-        fileEdgeData(name, std::ios_base::binary), locEdgeDst(0), locIndex(0),
-        locEdgeData(0), numSeeksEdgeDst(0), numSeeksIndex(0),
-        numSeeksEdgeData(0), numBytesReadEdgeDst(0), numBytesReadIndex(0),
-        numBytesReadEdgeData(0) {
-    if (!fileEdgeDst.is_open() || !fileEdgeDst.good())
-      throw "Bad filename";
-    if (!fileIndex.is_open() || !fileIndex.good())
-      throw "Bad filename";
-    if (!fileEdgeData.is_open() || !fileEdgeData.good())
+  /**
+   * Opens a graph file on disk.
+   *
+   * @param name graph file to open
+   * @param backend how to access the file; OFFLINE_GRAPH_MMAP falls back to
+   * OFFLINE_GRAPH_STREAM if the file cannot be mapped
+   */
+  OfflineGraph(const std::string& name,
+               OfflineGraphBackend backend = OFFLINE_GRAPH_DEFAULT)
+      : locEdgeDst(0), locIndex(0), locEdgeData(0), numSeeksEdgeDst(0),
+        numSeeksIndex(0), numSeeksEdgeData(0), numBytesReadEdgeDst(0),
+        numBytesReadIndex(0), numBytesReadEdgeData(0), prefetchTime(0) {
+    std::ifstream header(name, std::ios_base::binary);
+    if (!header.is_open() || !header.good())
       throw "Bad filename";
-
-    fileEdgeDst.exceptions(std::ifstream::eofbit | std::ifstream::failbit |
-                           std::ifstream::badbit);
-    fileIndex.exceptions(std::ifstream::eofbit | std::ifstream::failbit |
-                         std::ifstream::badbit);
-    fileEdgeData.exceptions(std::ifstream::eofbit | std::ifstream::failbit |
-                            std::ifstream::badbit);
+    header.exceptions(std::ifstream::eofbit | std::ifstream::failbit |
+                      std::ifstream::badbit);
 
     uint64_t ver = 0;
 
     try {
-      fileEdgeDst.read(reinterpret_cast<char*>(&ver), sizeof(uint64_t));
-      fileEdgeDst.read(reinterpret_cast<char*>(&sizeEdgeData),
-                       sizeof(uint64_t));
-      fileEdgeDst.read(reinterpret_cast<char*>(&numNodes), sizeof(uint64_t));
-      fileEdgeDst.read(reinterpret_cast<char*>(&numEdges), sizeof(uint64_t));
+      header.read(reinterpret_cast<char*>(&ver), sizeof(uint64_t));
+      header.read(reinterpret_cast<char*>(&sizeEdgeData), sizeof(uint64_t));
+      header.read(reinterpret_cast<char*>(&numNodes), sizeof(uint64_t));
+      header.read(reinterpret_cast<char*>(&numEdges), sizeof(uint64_t));
     } catch (std::ifstream::failure e) {
       std::cerr << "Exception while reading graph header:" << e.what() << "\n";
-      std::cerr << "IO error flags: EOF " << fileEdgeDst.eof() << " FAIL "
-                << fileEdgeDst.fail() << " BAD " << fileEdgeDst.bad() << "\n";
+      std::cerr << "IO error flags: EOF " << header.eof() << " FAIL "
+                << header.fail() << " BAD " << header.bad() << "\n";
     }
 
     if (ver == 0 || ver > 2)
@@ -232,21 +350,69 @@ public:
 
     v2 = ver == 2;
 
-    if (!fileEdgeDst)
+    if (!header)
       throw "Out of data";
 
     // File length
-    fileEdgeDst.seekg(0, fileEdgeDst.end);
-    length = fileEdgeDst.tellg();
+    header.seekg(0, header.end);
+    length = header.tellg();
     if (length < sizeof(uint64_t) * (4 + numNodes) +
                      (v2 ? sizeof(uint64_t) : sizeof(uint32_t)) * numEdges)
       throw "File too small";
 
-    fileEdgeDst.seekg(0, std::ios_base::beg);
-    fileEdgeData.seekg(0, std::ios_base::beg);
-    fileIndex.seekg(0, std::ios_base::beg);
+    if (backend == OFFLINE_GRAPH_DEFAULT) {
+      backend = galois::substrate::EnvCheck("GALOIS_OFFLINE_GRAPH_MMAP")
+                    ? OFFLINE_GRAPH_MMAP
+                    : OFFLINE_GRAPH_STREAM;
+    }
+
+    if (backend == OFFLINE_GRAPH_MMAP) {
+      galois::Timer mapTimer;
+      mapTimer.start();
+      if (mapping.map(name, length)) {
+        // the edge prefix sum is binary searched when dividing the graph,
+        // so pull it in up front instead of faulting it in page by page
+        mapping.willNeed(0, (4 + numNodes) * sizeof(uint64_t));
+      } else {
+        galois::gWarn("Could not map ", name, "; using stream reads instead");
+      }
+      mapTimer.stop();
+      prefetchTime += mapTimer.get_usec();
+    }
+
+    if (!mapping.mapped())
+      openStreams(name);
+  }
+
+  //! True if the file is accessed through a mapping rather than streams
+  bool isMapped() const { return mapping.mapped(); }
+
+  /**
+   * Starts reading the destinations (and edge data if present) of edges
+   * [edgeBegin, edgeEnd) ahead of use. The pages land in the page cache, so
+   * other readers of the file (e.g. BufferedGraph) benefit as well. Does
+   * nothing with stream reads.
+   */
+  void prefetchEdges(uint64_t edgeBegin, uint64_t edgeEnd) {
+    if (!mapping.mapped() || edgeBegin >= edgeEnd)
+      return;
+    galois::Timer prefetchTimer;
+    prefetchTimer.start();
+    size_t dstSize   = v2 ? sizeof(uint64_t) : sizeof(uint32_t);
+    size_t dstOffset = (4 + numNodes) * sizeof(uint64_t);
+    mapping.willNeed(dstOffset + edgeBegin * dstSize,
+                     dstOffset + edgeEnd * dstSize);
+    if (sizeEdgeData) {
+      mapping.willNeed(edgeDataStart() + edgeBegin * sizeEdgeData,
+                       edgeDataStart() + edgeEnd * sizeEdgeData);
+    }
+    prefetchTimer.stop();
+    prefetchTime += prefetchTimer.get_usec();
   }
 
+  //! Microseconds spent mapping the file and issuing read-ahead hints
+  uint64_t prefetch_usec() const { return prefetchTime; }
+
   uint64_t num_seeks() {
     // std::cout << "Seeks :: " << numSeeksEdgeDst << " , " << numSeeksEdgeData
     //          << " , " << numSeeksIndex << " \n";
@@ -256,12 +422,20 @@ public:
   uint64_t num_bytes_read() {
     // std::cout << "Bytes read :: " << numBytesReadEdgeDst << " , " <<
     // numBytesReadEdgeData << " , " << numBytesReadIndex << " \n";
-    return numBytesReadEdgeDst + numBytesReadEdgeData + numBytesReadIndex;
+    uint64_t mappedBytes = 0;
+    unsigned numThreads  = galois::substrate::getThreadPool().getMaxThreads();
+    for (unsigned t = 0; t < numThreads; ++t)
+      mappedBytes += *numBytesReadMapped.getRemote(t);
+    return numBytesReadEdgeDst + numBytesReadEdgeData + numBytesReadIndex +
+           mappedBytes;
   }
 
   void reset_seek_counters() {
     numSeeksEdgeDst = numSeeksEdgeData = numSeeksIndex = 0;
     numBytesReadEdgeDst = numBytesReadEdgeData = numBytesReadIndex = 0;
+    unsigned numThreads = galois::substrate::getThreadPool().getMaxThreads();
+    for (unsigned t = 0; t < numThreads; ++t)
+      *numBytesReadMapped.getRemote(t) = 0;
   }
 
   OfflineGraph(OfflineGraph&&) = default;
@@ -0,0 +1,325 @@
+/*
+ * This file belongs to the Galois project, a C++ library for exploiting parallelism.
+ * The code is being released under the terms of the 3-Clause BSD License (a
+ * copy is located in LICENSE.txt at the top-level directory).
+ *
+ * Copyright (C) 2018, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ */
+
+/**
+ * @file Relabel.h
+ *
+ * In-memory renumbering of the nodes of a CSR graph for cache locality, the
+ * counterpart of the gr2sorteddegreegr and gr2sortedbfsgr conversions of
+ * graph-convert that does not need a converted copy of every input.
+ */
+
+#ifndef GALOIS_GRAPHS_RELABEL_H
+#define GALOIS_GRAPHS_RELABEL_H
+
+#include "galois/Galois.h"
+#include "galois/MethodFlags.h"
+#include "galois/Timer.h"
+#include "galois/gstl.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <queue>
+#include <utility>
+#include <vector>
+
+namespace galois {
+namespace graphs {
+
+/**
+ * Orders of the nodes computed by relabelPermutation.
+ */
+enum class RelabelPolicy {
+  //! increasing degree, ties by id; e.g. for triangle counting
+  DEGREE,
+  //! breadth first search order, one search per connected component
+  BFS,
+  //! reverse Cuthill-McKee: BFS from a node of least degree that visits
+  //! neighbors by increasing degree, reversed; small bandwidth on meshes
+  RCM,
+  //! greedy Gorder: each node is followed by the one sharing most neighbors
+  //! with the last few placed nodes
+  GORDER,
+  //! hub clustering: nodes with more than the average degree first, both
+  //! groups in their original order
+  HUB_CLUSTER
+};
+
+namespace internal {
+
+template <typename GraphTy>
+std::vector<uint64_t> relabelDegrees(GraphTy& graph) {
+  std::vector<uint64_t> degrees(graph.size());
+  galois::do_all(galois::iterate(graph),
+                 [&](typename GraphTy::GraphNode n) {
+                   degrees[n] = std::distance(
+                       graph.edge_begin(n, MethodFlag::UNPROTECTED),
+                       graph.edge_end(n, MethodFlag::UNPROTECTED));
+                 },
+                 galois::no_stats(), galois::loopname("RelabelDegrees"));
+  return degrees;
+}
+
+//! nodes by increasing degree, ties by id; a counting sort over the degrees
+template <typename GNode>
+std::vector<GNode> nodesByDegree(const std::vector<uint64_t>& degrees) {
+  uint64_t maxDegree = 0;
+  for (uint64_t d : degrees)
+    maxDegree = std::max(maxDegree, d);
+
+  std::vector<size_t> offsets(maxDegree + 2, 0);
+  for (uint64_t d : degrees)
+    ++offsets[d + 1];
+  for (size_t d = 1; d < offsets.size(); ++d)
+    offsets[d] += offsets[d - 1];
+
+  std::vector<GNode> order(degrees.size());
+  for (size_t n = 0; n < degrees.size(); ++n)
+    order[offsets[degrees[n]]++] = n;
+  return order;
+}
+
+/**
+ * Breadth first search order of the nodes, starting a new search at the
+ * first unvisited node of starts until all nodes are visited. The order
+ * doubles as the queue of the searches.
+ *
+ * @param byDegree visit the neighbors of a node by increasing degree
+ */
+template <typename GraphTy>
+std::vector<typename GraphTy::GraphNode>
+bfsOrder(GraphTy& graph, const std::vector<typename GraphTy::GraphNode>& starts,
+         const std::vector<uint64_t>& degrees, bool byDegree) {
+  typedef typename GraphTy::GraphNode GNode;
+  std::vector<GNode> order;
+  order.reserve(graph.size());
+  std::vector<bool> visited(graph.size(), false);
+
+  for (GNode start : starts) {
+    if (visited[start])
+      continue;
+    visited[start] = true;
+    order.push_back(start);
+    for (size_t head = order.size() - 1; head < order.size(); ++head) {
+      GNode n      = order[head];
+      size_t first = order.size();
+      for (auto e : graph.edges(n, MethodFlag::UNPROTECTED)) {
+        GNode dst = graph.getEdgeDst(e);
+        if (!visited[dst]) {
+          visited[dst] = true;
+          order.push_back(dst);
+        }
+      }
+      if (byDegree) {
+        std::sort(order.begin() + first, order.end(), [&](GNode a, GNode b) {
+          return degrees[a] < degrees[b];
+        });
+      }
+    }
+  }
+  return order;
+}
+
+/**
+ * Greedy Gorder (Wei et al., SIGMOD 2016) over the out-edges: the score of an
+ * unplaced node counts its edges to and its common neighbors with the nodes
+ * in the window of the last placed ones, and the node with the highest score
+ * is placed next. Common neighbors through nodes of more than sqrt(n) edges
+ * are not counted to bound the work on hubs.
+ */
+template <typename GraphTy>
+std::vector<typename GraphTy::GraphNode>
+gorderOrder(GraphTy& graph, const std::vector<uint64_t>& degrees,
+            size_t window) {
+  typedef typename GraphTy::GraphNode GNode;
+  typedef std::pair<uint32_t, GNode> Entry;
+
+  size_t numNodes = graph.size();
+  uint64_t huge   = std::max<uint64_t>(std::sqrt((double)numNodes), 1);
+
+  std::vector<GNode> order;
+  order.reserve(numNodes);
+  std::vector<uint32_t> score(numNodes, 0);
+  std::vector<bool> placed(numNodes, false);
+  // entries whose score is out of date are skipped when they come up
+  std::priority_queue<Entry> heap;
+
+  auto bump = [&](GNode u, int delta) {
+    if (placed[u])
+      return;
+    score[u] += delta;
+    if (score[u])
+      heap.emplace(score[u], u);
+  };
+
+  auto update = [&](GNode v, int delta) {
+    for (auto e : graph.edges(v, MethodFlag::UNPROTECTED)) {
+      GNode w = graph.getEdgeDst(e);
+      bump(w, delta);
+      if (degrees[w] > huge)
+        continue;
+      for (auto f : graph.edges(w, MethodFlag::UNPROTECTED)) {
+        GNode u = graph.getEdgeDst(f);
+        if (u != v)
+          bump(u, delta);
+      }
+    }
+  };
+
+  // nodes without neighbors in the window are taken by decreasing degree
+  std::vector<GNode> byDegree = nodesByDegree<GNode>(degrees);
+  auto next                   = byDegree.rbegin();
+
+  while (order.size() < numNodes) {
+    if (order.size() > window)
+      update(order[order.size() - window - 1], -1);
+
+    // drops stale entries once they dominate the heap
+    if (heap.size() > 4 * numNodes) {
+      std::vector<Entry> live;
+      for (size_t u = 0; u < numNodes; ++u)
+        if (!placed[u] && score[u])
+          live.emplace_back(score[u], u);
+      heap = std::priority_queue<Entry>(std::less<Entry>(), std::move(live));
+    }
+
+    GNode v = numNodes;
+    while (!heap.empty()) {
+      Entry top = heap.top();
+      heap.pop();
+      if (!placed[top.second] && score[top.second] == top.first) {
+        v = top.second;
+        break;
+      }
+    }
+    if (v == numNodes) {
+      while (placed[*next])
+        ++next;
+      v = *next;
+    }
+
+    placed[v] = true;
+    order.push_back(v);
+    update(v, 1);
+  }
+  return order;
+}
+
+//! stable partition of the nodes into hubs and the rest, in parallel blocks
+template <typename GNode>
+std::vector<GNode> hubClusterOrder(const std::vector<uint64_t>& degrees,
+                                   uint64_t numEdges) {
+  size_t numNodes  = degrees.size();
+  unsigned threads = galois::getActiveThreads();
+  auto isHub       = [&](size_t n) { return degrees[n] * numNodes > numEdges; };
+
+  // hubs and other nodes of each block, then the offsets of the blocks
+  std::vector<size_t> hubs(threads + 1, 0), others(threads + 1, 0);
+  galois::on_each([&](unsigned tid, unsigned total) {
+    auto r = galois::block_range(size_t{0}, numNodes, tid, total);
+    for (size_t n = r.first; n < r.second; ++n)
+      ++(isHub(n) ? hubs : others)[tid + 1];
+  });
+  for (unsigned t = 0; t < threads; ++t) {
+    hubs[t + 1] += hubs[t];
+    others[t + 1] += others[t];
+  }
+
+  std::vector<GNode> order(numNodes);
+  size_t numHubs = hubs[threads];
+  galois::on_each([&](unsigned tid, unsigned total) {
+    auto r = galois::block_range(size_t{0}, numNodes, tid, total);
+    size_t h = hubs[tid], o = numHubs + others[tid];
+    for (size_t n = r.first; n < r.second; ++n)
+      order[isHub(n) ? h++ : o++] = n;
+  });
+  return order;
+}
+
+} // namespace internal
+
+/**
+ * Computes a renumbering of the nodes of a graph without changing the graph.
+ *
+ * @param window number of recently placed nodes considered by GORDER
+ * @returns perm with perm[n] the new id of node n
+ */
+template <typename GraphTy>
+std::vector<typename GraphTy::GraphNode>
+relabelPermutation(GraphTy& graph, RelabelPolicy policy, size_t window = 5) {
+  typedef typename GraphTy::GraphNode GNode;
+  galois::StatTimer timer("RelabelPermutation");
+  timer.start();
+
+  std::vector<uint64_t> degrees = internal::relabelDegrees(graph);
+  std::vector<GNode> order;
+
+  switch (policy) {
+  case RelabelPolicy::DEGREE:
+    order = internal::nodesByDegree<GNode>(degrees);
+    break;
+  case RelabelPolicy::BFS: {
+    std::vector<GNode> starts(graph.begin(), graph.end());
+    order = internal::bfsOrder(graph, starts, degrees, false);
+    break;
+  }
+  case RelabelPolicy::RCM:
+    order = internal::bfsOrder(graph, internal::nodesByDegree<GNode>(degrees),
+                               degrees, true);
+    std::reverse(order.begin(), order.end());
+    break;
+  case RelabelPolicy::GORDER:
+    order = internal::gorderOrder(graph, degrees, window);
+    break;
+  case RelabelPolicy::HUB_CLUSTER:
+    order = internal::hubClusterOrder<GNode>(degrees, graph.sizeEdges());
+    break;
+  }
+
+  // the inverse of the order
+  std::vector<GNode> perm(order.size());
+  galois::do_all(galois::iterate(size_t{0}, order.size()),
+                 [&](size_t i) { perm[order[i]] = i; }, galois::no_stats());
+
+  timer.stop();
+  return perm;
+}
+
+/**
+ * Renumbers the nodes of a CSR graph in place in the given order, moving node
+ * and edge data along; the edges of every node stay sorted by destination.
+ * Results computed on the relabeled graph map back to the original ids
+ * through the returned permutation, e.g. result[n] = data[perm[n]].
+ *
+ * @param window number of recently placed nodes considered by GORDER
+ * @returns perm with perm[n] the new id of original node n
+ */
+template <typename GraphTy>
+std::vector<typename GraphTy::GraphNode>
+relabel(GraphTy& graph, RelabelPolicy policy, size_t window = 5) {
+  auto perm = relabelPermutation(graph, policy, window);
+  graph.permuteNodes(perm);
+  return perm;
+}
+
+} // namespace graphs
+} // namespace galois
+
+#endif
@@ -757,9 +757,10 @@ void reportParam(const S1& region, const S2& category, const V& value) {
 void setStatFile(const std::string& f);
 
 // TODO: switch to gstl::Str in here
-//! Reports Galois system memory stats for all threads
+//! Reports Galois system memory stats for all threads and the pages backing
+//! large allocations
 void reportPageAlloc(const char* category);
-//! Reports NUMA memory stats for all NUMA nodes
+//! Reports bytes of large allocations first touched by each socket
 void reportNumaAlloc(const char* category);
 
 } // end namespace runtime
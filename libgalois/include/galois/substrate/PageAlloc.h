@@ -21,6 +21,8 @@
 #define GALOIS_SUBSTRATE_PAGEALLOC_H
 
 #include <cstddef>
+#include <cstdint>
+#include <vector>
 
 namespace galois {
 namespace substrate {
@@ -34,6 +36,42 @@ void* allocPages(unsigned num, bool preFault);
 // free page range
 void freePages(void* ptr, unsigned num);
 
+// size of the pages backing an allocation of allocPages; touching one byte
+// per such page faults in the whole allocation
+size_t pageSizeOf(void* ptr);
+
+/**
+ * Kind of pages that allocPages maps. The GALOIS_HUGE_PAGES environment
+ * variable chooses the first kind tried: "1G", "2M" (default), "thp", or
+ * "none". A kind that cannot be mapped falls back to the next one:
+ * 1 GB hugetlbfs pages (only for allocations of at least 1 GB), 2 MB
+ * hugetlbfs pages, small pages advised for transparent huge pages, and
+ * plain small pages.
+ */
+enum class PageKind { HUGE_1G, HUGE_2M, THP, SMALL, NUM_KINDS };
+
+// Totals over all allocations of allocPages so far
+struct PageAllocStats {
+  //! bytes mapped with each PageKind
+  size_t bytes[(int)PageKind::NUM_KINDS];
+  //! number of allocations of each PageKind
+  size_t allocations[(int)PageKind::NUM_KINDS];
+  //! allocations that fell back from the first kind tried
+  size_t fallbacks;
+  //! nanoseconds spent faulting in allocations
+  uint64_t faultNanoseconds;
+  //! bytes faulted in by the threads of each socket
+  std::vector<size_t> socketBytes;
+};
+
+PageAllocStats getPageAllocStats();
+
+// records that a thread of a socket faulted in bytes of an allocation
+void recordPageFaults(unsigned socket, size_t bytes);
+
+// records time spent faulting in an allocation
+void recordFaultTime(uint64_t nanoseconds);
+
 } // namespace substrate
 } // namespace galois
 
@@ -0,0 +1,242 @@
+/*
+ * This file belongs to the Galois project, a C++ library for exploiting parallelism.
+ * The code is being released under the terms of the 3-Clause BSD License (a
+ * copy is located in LICENSE.txt at the top-level directory).
+ *
+ * Copyright (C) 2018, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ */
+
+
+#ifndef GALOIS_WORKLIST_CHASELEV_H
+#define GALOIS_WORKLIST_CHASELEV_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include "galois/Threads.h"
+#include "galois/substrate/CompilerSpecific.h"
+#include "galois/substrate/PerThreadStorage.h"
+#include "galois/substrate/ThreadPool.h"
+#include "PerThreadChunk.h"
+#include "WLCompileCheck.h"
+
+namespace galois {
+namespace worklists {
+
+/**
+ * Lock-free work-stealing deque of chunks (Chase and Lev, "Dynamic Circular
+ * Work-Stealing Deque", with the memory orderings of Le et al., "Correct and
+ * Efficient Work-Stealing for Weak Memory Models").
+ *
+ * Only the owning thread may push and pop, which it does at the bottom;
+ * any thread may steal from the top. The circular buffer grows on demand;
+ * buffers that have been replaced may still be read by concurrent thieves,
+ * so they are only freed when the deque is destroyed.
+ */
+class ChaseLevDeque : private boost::noncopyable {
+  struct Buffer {
+    int64_t mask;
+    std::unique_ptr<std::atomic<ChunkHeader*>[]> slots;
+    std::unique_ptr<Buffer> retired;
+
+    explicit Buffer(int64_t size)
+        : mask(size - 1), slots(new std::atomic<ChunkHeader*>[size]) {}
+
+    int64_t size() const { return mask + 1; }
+
+    ChunkHeader* get(int64_t i) const {
+      return slots[i & mask].load(std::memory_order_relaxed);
+    }
+
+    void put(int64_t i, ChunkHeader* c) {
+      slots[i & mask].store(c, std::memory_order_relaxed);
+    }
+  };
+
+  static const int64_t initialSize = 64;
+
+  //! index of the oldest chunk; advanced by thieves and the owner
+  std::atomic<int64_t> top;
+  char pad1[GALOIS_CACHE_LINE_SIZE - sizeof(std::atomic<int64_t>)];
+  //! one past the newest chunk; only written by the owner
+  std::atomic<int64_t> bottom;
+  std::atomic<Buffer*> buffer;
+  //! owns the current buffer and, through it, all retired ones
+  std::unique_ptr<Buffer> storage;
+
+  Buffer* grow(Buffer* old, int64_t b, int64_t t) {
+    std::unique_ptr<Buffer> bigger(new Buffer(old->size() * 2));
+    for (int64_t i = t; i < b; ++i) {
+      bigger->put(i, old->get(i));
+    }
+    bigger->retired = std::move(storage);
+    storage         = std::move(bigger);
+    buffer.store(storage.get(), std::memory_order_release);
+    return storage.get();
+  }
+
+public:
+  ChaseLevDeque() : top(0), bottom(0), storage(new Buffer(initialSize)) {
+    buffer.store(storage.get(), std::memory_order_relaxed);
+  }
+
+  //! Approximate emptiness check; exact only for the owner when no thief
+  //! is active
+  bool empty() const {
+    return bottom.load(std::memory_order_relaxed) <=
+           top.load(std::memory_order_relaxed);
+  }
+
+  //! Owner only: push a chunk at the bottom
+  void push(ChunkHeader* c) {
+    int64_t b   = bottom.load(std::memory_order_relaxed);
+    int64_t t   = top.load(std::memory_order_acquire);
+    Buffer* buf = buffer.load(std::memory_order_relaxed);
+    if (b - t > buf->mask) {
+      buf = grow(buf, b, t);
+    }
+    buf->put(b, c);
+    std::atomic_thread_fence(std::memory_order_release);
+    bottom.store(b + 1, std::memory_order_relaxed);
+  }
+
+  //! Owner only: pop the newest chunk from the bottom
+  ChunkHeader* pop() {
+    int64_t b   = bottom.load(std::memory_order_relaxed) - 1;
+    Buffer* buf = buffer.load(std::memory_order_relaxed);
+    bottom.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t t = top.load(std::memory_order_relaxed);
+
+    if (t > b) { // empty
+      bottom.store(b + 1, std::memory_order_relaxed);
+      return nullptr;
+    }
+
+    ChunkHeader* c = buf->get(b);
+    if (t == b) {
+      // last chunk: race with thieves for it
+      if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                       std::memory_order_relaxed)) {
+        c = nullptr;
+      }
+      bottom.store(b + 1, std::memory_order_relaxed);
+    }
+    return c;
+  }
+
+  //! Any thread: steal the oldest chunk from the top; returns null if the
+  //! deque is empty or another thread won the race for the chunk
+  ChunkHeader* steal() {
+    int64_t t = top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t b = bottom.load(std::memory_order_acquire);
+
+    if (t >= b) {
+      return nullptr;
+    }
+
+    Buffer* buf    = buffer.load(std::memory_order_acquire);
+    ChunkHeader* c = buf->get(t);
+    if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                     std::memory_order_relaxed)) {
+      return nullptr;
+    }
+    return c;
+  }
+};
+
+/**
+ * Chunk container for {@link PerThreadChunkMaster} made of one
+ * {@link ChaseLevDeque} per thread. A thread that runs out of chunks steals
+ * from randomly chosen threads, trying threads on its own socket before
+ * threads on other sockets.
+ */
+class ChaseLevStealingQueue : private boost::noncopyable {
+  struct Local {
+    ChaseLevDeque deque;
+    uint32_t seed = 0;
+  };
+
+  substrate::PerThreadStorage<Local> local;
+
+  //! xorshift step of the thread's victim selection state
+  static uint32_t nextRandom(Local& me, unsigned id) {
+    if (!me.seed) {
+      me.seed = 2654435761u * (id + 1);
+    }
+    me.seed ^= me.seed << 13;
+    me.seed ^= me.seed >> 17;
+    me.seed ^= me.seed << 5;
+    return me.seed;
+  }
+
+  GALOIS_ATTRIBUTE_NOINLINE
+  ChunkHeader* doSteal() {
+    Local& me    = *local.getLocal();
+    auto& tp     = substrate::getThreadPool();
+    unsigned id  = tp.getTID();
+    unsigned pkg = substrate::ThreadPool::getSocket();
+    unsigned num = galois::getActiveThreads();
+
+    if (num < 2) {
+      return nullptr;
+    }
+
+    // visit every other thread once, starting at a random one; first those
+    // on this socket, then the rest
+    unsigned start = nextRandom(me, id) % num;
+    for (unsigned sameSocket = 1; sameSocket <= 2; ++sameSocket) {
+      for (unsigned i = 0; i < num; ++i) {
+        unsigned eid = (start + i) % num;
+        if (eid == id || (tp.getSocket(eid) == pkg) != (sameSocket == 1)) {
+          continue;
+        }
+        ChaseLevDeque& victim = local.getRemote(eid)->deque;
+        // retry while the victim has chunks and we only lost races
+        while (!victim.empty()) {
+          if (ChunkHeader* c = victim.steal()) {
+            return c;
+          }
+        }
+      }
+    }
+    return nullptr;
+  }
+
+public:
+  void push(ChunkHeader* c) { local.getLocal()->deque.push(c); }
+
+  ChunkHeader* pop() {
+    if (ChunkHeader* c = local.getLocal()->deque.pop())
+      return c;
+    return doSteal();
+  }
+};
+
+/**
+ * Chunked worklist whose full chunks are kept in per-thread lock-free
+ * Chase-Lev deques. Threads work LIFO on their own chunks and steal the
+ * oldest chunks of other threads, preferring their own socket, so no
+ * locks are shared between threads.
+ */
+template <int ChunkSize = 64, typename T = int>
+using ChaseLevChunkLIFO =
+    PerThreadChunkMaster<true, ChunkSize, ChaseLevStealingQueue, T>;
+GALOIS_WLCOMPILECHECK(ChaseLevChunkLIFO)
+
+} // namespace worklists
+} // namespace galois
+#endif
@@ -0,0 +1,215 @@
+/*
+ * This file belongs to the Galois project, a C++ library for exploiting parallelism.
+ * The code is being released under the terms of the 3-Clause BSD License (a
+ * copy is located in LICENSE.txt at the top-level directory).
+ *
+ * Copyright (C) 2018, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ */
+
+
+#ifndef GALOIS_WORKLIST_MULTIQUEUE_H
+#define GALOIS_WORKLIST_MULTIQUEUE_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+#include "galois/gstl.h"
+#include "galois/optional.h"
+#include "galois/Threads.h"
+#include "galois/substrate/CompilerSpecific.h"
+#include "galois/substrate/SimpleLock.h"
+#include "galois/substrate/PerThreadStorage.h"
+#include "galois/substrate/ThreadPool.h"
+#include "WLCompileCheck.h"
+
+namespace galois {
+namespace worklists {
+
+/**
+ * Relaxed concurrent priority queue (MultiQueue): QueuesPerThread * threads
+ * locked binary heaps. A push goes to a random heap; a pop looks at the
+ * tops of two random heaps and removes the smaller one. Items come out in
+ * approximately Compare order without the bucketing (and delta tuning) of
+ * {@link OrderedByIntegerMetric}, so any comparable priority works.
+ *
+ * @tparam Compare strict weak order; the smallest item is popped first
+ * @tparam T type of items
+ * @tparam Concurrent whether the worklist is used by more than one thread
+ * @tparam QueuesPerThread number of heaps per active thread
+ */
+template <typename Compare = std::less<int>, typename T = int,
+          bool Concurrent = true, unsigned QueuesPerThread = 2>
+class MultiQueue : private boost::noncopyable {
+public:
+  template <typename _T>
+  using retype = MultiQueue<Compare, _T, Concurrent, QueuesPerThread>;
+
+  template <bool _concurrent>
+  using rethread = MultiQueue<Compare, T, _concurrent, QueuesPerThread>;
+
+  template <unsigned _queues>
+  using with_queues_per_thread = MultiQueue<Compare, T, Concurrent, _queues>;
+
+  typedef T value_type;
+
+private:
+  //! Reverses Compare so that the std heap functions keep the smallest item
+  //! on top
+  struct HeapCompare {
+    Compare comp;
+    bool operator()(const T& lhs, const T& rhs) const { return comp(rhs, lhs); }
+  };
+
+  struct Queue {
+    substrate::CondLock<Concurrent> lock;
+    //! number of items; read without the lock to skip empty heaps
+    std::atomic<size_t> size;
+    gstl::Vector<T> heap;
+    //! keeps neighboring heaps off each other's cache lines
+    char pad[GALOIS_CACHE_LINE_SIZE];
+
+    Queue() : size(0) {}
+  };
+
+  HeapCompare heapCmp;
+  unsigned numQueues;
+  std::unique_ptr<Queue[]> queues;
+  substrate::PerThreadStorage<uint32_t> seeds;
+
+  //! xorshift step of the calling thread's queue selection state
+  unsigned nextQueue() {
+    uint32_t& seed = *seeds.getLocal();
+    if (!seed) {
+      seed = 2654435761u * (substrate::ThreadPool::getTID() + 1);
+    }
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    return seed % numQueues;
+  }
+
+  //! Must hold q.lock and q must be non-empty
+  galois::optional<value_type> popFrom(Queue& q) {
+    std::pop_heap(q.heap.begin(), q.heap.end(), heapCmp);
+    galois::optional<value_type> retval(q.heap.back());
+    q.heap.pop_back();
+    q.size.store(q.heap.size(), std::memory_order_relaxed);
+    return retval;
+  }
+
+  GALOIS_ATTRIBUTE_NOINLINE
+  galois::optional<value_type> slowPop() {
+    // a pop may only fail if every heap was seen empty, otherwise the
+    // executor could terminate with work left
+    unsigned start = nextQueue();
+    for (unsigned i = 0; i < numQueues; ++i) {
+      Queue& q = queues[(start + i) % numQueues];
+      if (q.size.load(std::memory_order_relaxed) == 0)
+        continue;
+      q.lock.lock();
+      if (!q.heap.empty()) {
+        galois::optional<value_type> retval = popFrom(q);
+        q.lock.unlock();
+        return retval;
+      }
+      q.lock.unlock();
+    }
+    return galois::optional<value_type>();
+  }
+
+public:
+  MultiQueue(const Compare& comp = Compare())
+      : heapCmp{comp},
+        numQueues(std::max(1u, QueuesPerThread * galois::getActiveThreads())),
+        queues(new Queue[numQueues]) {}
+
+  void push(const value_type& val) {
+    Queue* q;
+    do {
+      q = &queues[nextQueue()];
+    } while (!q->lock.try_lock());
+    q->heap.push_back(val);
+    std::push_heap(q->heap.begin(), q->heap.end(), heapCmp);
+    q->size.store(q->heap.size(), std::memory_order_relaxed);
+    q->lock.unlock();
+  }
+
+  template <typename Iter>
+  void push(Iter b, Iter e) {
+    while (b != e)
+      push(*b++);
+  }
+
+  template <typename RangeTy>
+  void push_initial(const RangeTy& range) {
+    auto rp = range.local_pair();
+    push(rp.first, rp.second);
+  }
+
+  galois::optional<value_type> pop() {
+    // two-choice pops; give up on heaps that are empty or locked by others
+    for (unsigned attempt = 0; attempt < numQueues; ++attempt) {
+      Queue& a = queues[nextQueue()];
+      Queue& b = queues[nextQueue()];
+      bool aHasWork = a.size.load(std::memory_order_relaxed) != 0;
+      bool bHasWork = b.size.load(std::memory_order_relaxed) != 0;
+      if (!aHasWork && !bHasWork)
+        continue;
+
+      if (&a == &b || !aHasWork || !bHasWork) {
+        Queue& q = aHasWork ? a : b;
+        if (!q.lock.try_lock())
+          continue;
+        if (!q.heap.empty()) {
+          galois::optional<value_type> retval = popFrom(q);
+          q.lock.unlock();
+          return retval;
+        }
+        q.lock.unlock();
+        continue;
+      }
+
+      if (!a.lock.try_lock())
+        continue;
+      if (!b.lock.try_lock()) {
+        a.lock.unlock();
+        continue;
+      }
+      Queue* best = nullptr;
+      if (a.heap.empty()) {
+        best = b.heap.empty() ? nullptr : &b;
+      } else if (b.heap.empty()) {
+        best = &a;
+      } else {
+        best = heapCmp(a.heap.front(), b.heap.front()) ? &b : &a;
+      }
+      galois::optional<value_type> retval;
+      if (best)
+        retval = popFrom(*best);
+      b.lock.unlock();
+      a.lock.unlock();
+      if (retval)
+        return retval;
+    }
+    return slowPop();
+  }
+};
+GALOIS_WLCOMPILECHECK(MultiQueue)
+
+} // namespace worklists
+} // namespace galois
+#endif
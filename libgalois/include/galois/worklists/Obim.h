@@ -27,6 +27,7 @@
 #include "galois/worklists/Chunk.h"
 #include "galois/worklists/WorkListHelpers.h"
 
+#include <atomic>
 #include <deque>
 #include <limits>
 #include <type_traits>
@@ -106,8 +107,120 @@ struct OrderedByIntegerMetricComparator<Index, true> {
       : identity(std::numeric_limits<Index>::max()) {}
 };
 
+/**
+ * Indexers whose mapping changes at runtime (see {@link AdaptiveDelta})
+ * define notifyScan(), which is called when a thread runs out of work in its
+ * current bucket. Items of such indexers are re-indexed when popped.
+ */
+template <typename Indexer, typename = void>
+struct IsAdaptiveIndexer : std::false_type {};
+
+template <typename Indexer>
+struct IsAdaptiveIndexer<
+    Indexer, decltype(std::declval<const Indexer&>().notifyScan(), void())>
+    : std::true_type {};
+
+template <typename Indexer>
+auto notifyIndexerScan(const Indexer& indexer)
+    -> std::enable_if_t<IsAdaptiveIndexer<Indexer>::value> {
+  indexer.notifyScan();
+}
+
+template <typename Indexer>
+auto notifyIndexerScan(const Indexer&)
+    -> std::enable_if_t<!IsAdaptiveIndexer<Indexer>::value> {}
+
 } // namespace internal
 
+/**
+ * Runtime-adjusted bucket width for delta-stepping style use of
+ * {@link OrderedByIntegerMetric}. An indexer maps a priority to
+ * <code>index(priority)</code>, the priority with its low shift() bits
+ * cleared; because bucket indices stay in priority units, buckets created
+ * before and after a change of width remain correctly ordered.
+ *
+ * The operator reports the units of work it does for each item (e.g., the
+ * item itself and the updates of nodes) through noteWork(), with how many of
+ * them were wasted (a stale item, or an update that a better one will have
+ * to redo), and the
+ * worklist reports each time a thread finds its bucket empty through the
+ * indexer's notifyScan(). After every window of work a thread narrows the
+ * buckets if much of its work was wasted and widens them if little was
+ * wasted but it kept running out of bucket work.
+ */
+class AdaptiveDelta : private boost::noncopyable {
+  struct Window {
+    size_t work   = 0;
+    size_t wasted = 0;
+    size_t scans  = 0;
+  };
+
+  std::atomic<unsigned> curShift;
+  unsigned minShift;
+  unsigned maxShift;
+  std::atomic<size_t> numChanges;
+  substrate::PerThreadStorage<Window> windows;
+
+  GALOIS_ATTRIBUTE_NOINLINE
+  void adjust(Window& w) {
+    unsigned s      = curShift.load(std::memory_order_relaxed);
+    unsigned target = s;
+
+    if (w.wasted * 4 > w.work && s > minShift) {
+      // more than a quarter of the work was wasted: buckets are too wide;
+      // back off faster the more was wasted
+      unsigned step = (w.wasted * 2 > w.work) ? 2 : 1;
+      target        = (s - minShift > step) ? s - step : minShift;
+    } else if (w.wasted * 32 < w.work && w.scans * ITEMS_PER_SCAN > w.work &&
+               s < maxShift) {
+      // little waste, but buckets run dry quickly: buckets are too narrow
+      target = s + 1;
+    }
+
+    if (target != s && curShift.compare_exchange_strong(s, target)) {
+      numChanges.fetch_add(1, std::memory_order_relaxed);
+    }
+    w = Window();
+  }
+
+public:
+  //! Units of work a thread does between adjustments
+  static const size_t WINDOW = 1024;
+  //! Less work than this per empty-bucket scan means buckets are too narrow
+  static const size_t ITEMS_PER_SCAN = 64;
+
+  AdaptiveDelta(unsigned initialShift, unsigned _minShift = 0,
+                unsigned _maxShift = 30)
+      : curShift(initialShift), minShift(_minShift), maxShift(_maxShift),
+        numChanges(0) {}
+
+  //! Current bucket width is 2^shift()
+  unsigned shift() const { return curShift.load(std::memory_order_relaxed); }
+
+  //! Number of times the bucket width changed
+  size_t changes() const { return numChanges.load(std::memory_order_relaxed); }
+
+  //! Bucket index of a priority at the current width
+  template <typename P>
+  P index(P priority) const {
+    unsigned s = shift();
+    return (priority >> s) << s;
+  }
+
+  //! Called by the operator once per item with the units of work it did
+  //! for the item, of which wasted were wasted
+  void noteWork(size_t work, size_t wasted) {
+    Window& w = *windows.getLocal();
+    w.work += work;
+    w.wasted += wasted;
+    if (w.work >= WINDOW)
+      adjust(w);
+  }
+
+  //! Called (through the indexer) when a thread's bucket is empty
+  void noteScan() { ++windows.getLocal()->scans; }
+};
+
 /**
  * Approximate priority scheduling. Indexer is a default-constructable class
  * whose instances conform to <code>R r = indexer(item)</code> where R is some
@@ -279,6 +392,8 @@ private:
     bool localLeader = substrate::ThreadPool::isLeader();
     Index msS        = this->identity;
 
+    internal::notifyIndexerScan(indexer);
+
     updateLocal(p);
 
     if (BSP && !UseMonotonic) {
@@ -296,10 +411,14 @@ private:
       }
     }
 
+    // buckets created by rebucket come after ii, and inserting into the map
+    // keeps ii valid
     for (auto ii = p.local.lower_bound(msS), ei = p.local.end(); ii != ei;
          ++ii) {
       galois::optional<T> item;
-      if ((item = ii->second->pop())) {
+      while ((item = ii->second->pop())) {
+        if (rebucket(p, ii->first, *item))
+          continue;
         p.current   = ii->second;
         p.curIndex  = ii->first;
         p.scanStart = ii->first;
@@ -332,6 +451,23 @@ private:
     return C2;
   }
 
+  /**
+   * For adaptive indexers: if the index of an item popped from bucket
+   * bucketIndex now lies after that bucket (e.g., because buckets became
+   * narrower), move the item to its bucket instead of processing it early.
+   *
+   * @returns true if the item was moved
+   */
+  bool rebucket(ThreadData& p, Index bucketIndex, const value_type& val) {
+    if (!internal::IsAdaptiveIndexer<Indexer>::value)
+      return false;
+    Index index = indexer(val);
+    if (!this->compare(bucketIndex, index))
+      return false;
+    updateLocalOrCreate(p, index)->push(val);
+    return true;
+  }
+
   inline CTy* updateLocalOrCreate(ThreadData& p, Index i) {
     // Try local then try update then find again or else create and update the
     // master log
@@ -403,8 +539,11 @@ public:
       return slowPop(p);
 
     galois::optional<value_type> item;
-    if (C && (item = C->pop()))
-      return item;
+    while (C && (item = C->pop())) {
+      if (!rebucket(p, p.curIndex, *item))
+        return item;
+    }
+    item = galois::optional<value_type>();
 
     if (UseBarrier)
       return item;
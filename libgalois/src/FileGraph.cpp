@@ -26,8 +26,10 @@
 
 #include "galois/gIO.h"
 #include "galois/graphs/FileGraph.h"
+#include "galois/graphs/CompressedAdjacency.h"
 #include "galois/substrate/PageAlloc.h"
 
+#include <algorithm>
 #include <cassert>
 #include <fstream>
 
@@ -79,6 +81,10 @@ namespace graphs {
 // outedges[numEdges] {uint32_t LE or uint64_t LE for ver == 2}
 // potential padding (32bit max) to Re-Align to 64bits
 // EdgeType[numEdges] {EdgeType size}
+//
+// Version 3 files store the edge destinations delta + varint encoded; see
+// CompressedAdjacency.h for the layout. They are decoded into the version 1
+// (or 2) layout by fromFile.
 
 FileGraph::FileGraph()
     : sizeofEdge(0), numNodes(0), numEdges(0), outIdx(0), outs(0), edgeData(0),
@@ -134,7 +140,10 @@ void FileGraph::fromMem(void* m, uint64_t node_offset, uint64_t edge_offset,
   uint64_t* fptr = (uint64_t*)m;
   graphVersion   = convert_le64toh(*fptr++);
 
-  if (graphVersion != 1 && graphVersion != 2) {
+  if (graphVersion == 3) {
+    GALOIS_DIE("compressed (version 3) graphs can only be loaded whole with "
+               "fromFile");
+  } else if (graphVersion != 1 && graphVersion != 2) {
     GALOIS_DIE("unknown file version ", graphVersion);
   }
 
@@ -319,9 +328,71 @@ void FileGraph::fromFile(const std::string& filename) {
     GALOIS_SYS_DIE("failed reading ", "'", filename, "'");
   mappings.push_back({base, static_cast<size_t>(buf.st_size)});
 
+  if (convert_le64toh(*static_cast<uint64_t*>(base)) == 3) {
+    fromCompressedMem(base, buf.st_size);
+    return;
+  }
+
   fromMem(base, 0, 0, buf.st_size);
 }
 
+void FileGraph::fromCompressedMem(void* m, size_t len) {
+  uint64_t* fptr     = static_cast<uint64_t*>(m);
+  uint64_t sizeofE   = convert_le64toh(fptr[1]);
+  uint64_t num_nodes = convert_le64toh(fptr[2]);
+  uint64_t num_edges = convert_le64toh(fptr[3]);
+  uint64_t* inIdx    = fptr + 4;
+  uint64_t* inBytes  = inIdx + num_nodes;
+  uint64_t numBytes =
+      num_nodes ? convert_le64toh(inBytes[num_nodes - 1]) : 0;
+  CompressedFileLayout layout(num_nodes, num_edges, numBytes, sizeofE);
+  if (layout.total > len)
+    GALOIS_DIE("truncated compressed graph file");
+
+  // node ids need 64 bits only if they do not fit in 32
+  int version  = (num_nodes > std::numeric_limits<uint32_t>::max()) ? 2 : 1;
+  size_t bytes = rawBlockSize(num_nodes, num_edges, sizeofE, version);
+  char* base   = (char*)mmap_big(nullptr, bytes, PROT_READ | PROT_WRITE,
+                               _MAP_ANON | MAP_PRIVATE, -1, 0);
+  if (base == MAP_FAILED)
+    GALOIS_SYS_DIE("failed allocating graph");
+
+  uint64_t* optr = (uint64_t*)base;
+  *optr++        = convert_htole64(version);
+  *optr++        = convert_htole64(sizeofE);
+  *optr++        = convert_htole64(num_nodes);
+  *optr++        = convert_htole64(num_edges);
+  memcpy(optr, inIdx, sizeof(uint64_t) * num_nodes);
+
+  const uint8_t* encoded = (const uint8_t*)m + layout.outBytes;
+  uint32_t* outs32       = (uint32_t*)(optr + num_nodes);
+  uint64_t* outs64       = optr + num_nodes;
+  uint64_t edgeBegin     = 0;
+  for (uint64_t n = 0; n < num_nodes; ++n) {
+    uint64_t edgeEnd = convert_le64toh(inIdx[n]);
+    for (CompressedEdgeIterator ii(n, edgeBegin, edgeEnd, encoded),
+         ei(edgeEnd);
+         ii != ei; ++ii) {
+      if (version == 1)
+        outs32[*ii] = convert_htole32(ii.dst());
+      else
+        outs64[*ii] = convert_htole64(ii.dst());
+    }
+    edgeBegin = edgeEnd;
+    encoded   = (const uint8_t*)m + layout.outBytes +
+              convert_le64toh(inBytes[n]);
+  }
+
+  if (sizeofE)
+    memcpy(base + rawBlockSize(num_nodes, num_edges, 0, version),
+           (char*)m + layout.edgeData, sizeofE * num_edges);
+
+  // the decoded copy replaces the file mapping
+  munmap(mappings.back().ptr, mappings.back().len);
+  mappings.back() = {base, bytes};
+  fromMem(base, 0, 0, 0);
+}
+
 /**
  * Load graph data from a given offset
  *
@@ -533,6 +604,74 @@ void FileGraph::toFile(const std::string& file) {
   close(fd);
 }
 
+/**
+ * Writes all of [ptr, ptr + total) to fd.
+ */
+static void writeFully(int fd, const char* ptr, size_t total,
+                       const std::string& file) {
+  while (total) {
+    ssize_t retval = write(fd, ptr, total);
+    if (retval == -1) {
+      GALOIS_SYS_DIE("failed writing to ", "'", file, "'");
+    } else if (retval == 0) {
+      GALOIS_DIE("ran out of space writing to ", "'", file, "'");
+    }
+    total -= retval;
+    ptr += retval;
+  }
+}
+
+void FileGraph::toCompressedFile(const std::string& file) {
+  // only whole graphs can be written
+  GALOIS_ASSERT(nodeOffset == 0 && edgeOffset == 0);
+
+  std::vector<uint64_t> idx(numNodes);
+  std::vector<uint64_t> byteIdx(numNodes);
+  std::vector<uint8_t> encoded;
+  std::vector<char> data(sizeofEdge * numEdges);
+  std::vector<std::pair<uint64_t, uint64_t>> neighbors;
+  std::vector<uint64_t> dsts;
+
+  for (uint64_t n = 0; n < numNodes; ++n) {
+    neighbors.clear();
+    for (auto ii = edge_begin(n), ei = edge_end(n); ii != ei; ++ii)
+      neighbors.emplace_back(getEdgeDst(ii), *ii);
+    std::sort(neighbors.begin(), neighbors.end());
+
+    dsts.clear();
+    for (auto& p : neighbors) {
+      if (sizeofEdge)
+        memcpy(&data[sizeofEdge * (*edge_begin(n) + dsts.size())],
+               edgeData + sizeofEdge * p.second, sizeofEdge);
+      dsts.push_back(p.first);
+    }
+
+    size_t start = encoded.size();
+    encoded.resize(start + encodeNeighbors(n, dsts.begin(), dsts.end(),
+                                           nullptr));
+    encodeNeighbors(n, dsts.begin(), dsts.end(), encoded.data() + start);
+    idx[n]     = convert_htole64(*edge_end(n));
+    byteIdx[n] = convert_htole64(encoded.size());
+  }
+
+  CompressedFileLayout layout(numNodes, numEdges, encoded.size(), sizeofEdge);
+  uint64_t header[4] = {convert_htole64(3), convert_htole64(sizeofEdge),
+                        convert_htole64(numNodes), convert_htole64(numEdges)};
+  encoded.resize(layout.edgeData - layout.outBytes, 0);
+
+  mode_t mode = S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH;
+  int fd      = open(file.c_str(), O_WRONLY | O_CREAT | O_TRUNC, mode);
+  if (fd == -1)
+    GALOIS_SYS_DIE("failed opening ", "'", file, "'");
+  writeFully(fd, (const char*)header, sizeof(header), file);
+  writeFully(fd, (const char*)idx.data(), sizeof(uint64_t) * numNodes, file);
+  writeFully(fd, (const char*)byteIdx.data(), sizeof(uint64_t) * numNodes,
+             file);
+  writeFully(fd, (const char*)encoded.data(), encoded.size(), file);
+  writeFully(fd, data.data(), data.size(), file);
+  close(fd);
+}
+
 uint64_t FileGraph::getEdgeIdx(GraphNode src, GraphNode dst) {
   // loop through all neighbors of src, looking for a match with dst
   if (graphVersion == 1) {
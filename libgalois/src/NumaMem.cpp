@@ -23,6 +23,7 @@
 #include "galois/gIO.h"
 
 #include <cassert>
+#include <chrono>
 
 using namespace galois::substrate;
 
@@ -33,26 +34,33 @@ static void pageIn(void* _ptr, size_t len, size_t pageSize, unsigned numThreads,
   char* ptr = static_cast<char*>(_ptr);
 
   if (numThreads == 1) {
-    for (size_t x = 0; x < len; x += pageSize / 2)
+    for (size_t x = 0; x < len; x += pageSize)
       ptr[x] = 0;
+    recordPageFaults(ThreadPool::getSocket(), len);
   } else {
     getThreadPool().run(numThreads, [ptr, len, pageSize, numThreads,
                                      finegrained]() {
-      auto myID = ThreadPool::getTID();
+      auto myID     = ThreadPool::getTID();
+      size_t pages = 0;
 
       if (finegrained) {
         // round robin page distribution among threads (e.g. thread 0 gets
         // a page, then thread 1, then thread n, then back to thread 0 and
         // so on until the end of the region)
-        for (size_t x = pageSize * myID; x < len; x += pageSize * numThreads)
+        for (size_t x = pageSize * myID; x < len; x += pageSize * numThreads) {
           ptr[x] = 0;
+          ++pages;
+        }
       } else {
         // sectioned page distribution (e.g. thread 0 gets first chunk, thread
         // 1 gets next chunk, ... last thread gets last chunk)
         for (size_t x = myID * len / numThreads;
-             x < len && x < (myID + 1) * len / numThreads; x += pageSize)
+             x < len && x < (myID + 1) * len / numThreads; x += pageSize) {
           ptr[x] = 0;
+          ++pages;
+        }
       }
+      recordPageFaults(ThreadPool::getSocket(), pages * pageSize);
     });
   }
 }
@@ -127,15 +135,31 @@ static void pageInSpecified(void* _ptr, size_t len, size_t pageSize,
                             for (uint32_t i = beginPage; i <= endPage; i++) {
                               ptr[i * pageSize] = 0;
                             }
+                            recordPageFaults(ThreadPool::getSocket(),
+                                             (endPage - beginPage + 1) *
+                                                 pageSize);
                           }
                         });
   } else {
     // 1 thread case
-    for (size_t x = 0; x < len; x += pageSize / 2)
+    for (size_t x = 0; x < len; x += pageSize)
       ptr[x] = 0;
+    recordPageFaults(ThreadPool::getSocket(), len);
   }
 }
 
+/**
+ * Runs a page in function and records the time it took.
+ */
+template <typename F>
+static void timedPageIn(F pageInFn) {
+  auto start = std::chrono::high_resolution_clock::now();
+  pageInFn();
+  recordFaultTime(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                      std::chrono::high_resolution_clock::now() - start)
+                      .count());
+}
+
 static void largeFree(void* ptr, size_t bytes) {
   freePages(ptr, bytes / allocSize());
 }
@@ -167,10 +191,14 @@ LAptr galois::substrate::largeMallocInterleaved(size_t bytes,
   // Get a non-prefaulted allocation
   void* data = allocPages(bytes / allocSize(), false);
 
-  // Then page in based on thread number
+  // Then page in based on thread number; pages are touched at the
+  // granularity they were mapped with so that small page fallbacks are
+  // placed as well
   if (data)
-    // true = round robin paging
-    pageIn(data, bytes, allocSize(), numThreads, true);
+    timedPageIn([&]() {
+      // true = round robin paging
+      pageIn(data, bytes, pageSizeOf(data), numThreads, true);
+    });
 
   return LAptr{data, internal::largeFreer{bytes}};
 }
@@ -197,8 +225,10 @@ LAptr galois::substrate::largeMallocBlocked(size_t bytes, unsigned numThreads) {
   // Get a non-prefaulted allocation
   void* data = allocPages(bytes / allocSize(), false);
   if (data)
-    // false = blocked paging
-    pageIn(data, bytes, allocSize(), numThreads, false);
+    timedPageIn([&]() {
+      // false = blocked paging
+      pageIn(data, bytes, pageSizeOf(data), numThreads, false);
+    });
   return LAptr{data, internal::largeFreer{bytes}};
 }
 
@@ -226,8 +256,10 @@ LAptr galois::substrate::largeMallocSpecified(size_t bytes, uint32_t numThreads,
 
   // NUMA aware page in based on element distribution specified in threadRanges
   if (data)
-    pageInSpecified(data, bytes, allocSize(), numThreads, threadRanges,
-                    elementSize);
+    timedPageIn([&]() {
+      pageInSpecified(data, bytes, pageSizeOf(data), numThreads, threadRanges,
+                      elementSize);
+    });
 
   return LAptr{data, internal::largeFreer{bytes}};
 }
@@ -19,9 +19,15 @@
 
 #include "galois/substrate/PageAlloc.h"
 #include "galois/substrate/SimpleLock.h"
+#include "galois/substrate/EnvCheck.h"
+#include "galois/substrate/ThreadPool.h"
 #include "galois/gIO.h"
 
+#include <atomic>
 #include <mutex>
+#include <map>
+#include <chrono>
+#include <string>
 
 #ifdef __linux__
 #include <linux/mman.h>
@@ -30,9 +36,36 @@
 
 // figure this out dynamically
 const size_t hugePageSize = 2 * 1024 * 1024;
+const size_t gigaPageSize = 1024 * 1024 * 1024;
+const size_t smallPageSize = 4096;
 // protect mmap, munmap since linux has issues
 static galois::substrate::SimpleLock allocLock;
 
+using galois::substrate::PageKind;
+
+namespace {
+//! A mapping made by allocPages
+struct Mapping {
+  size_t length;   //!< bytes mapped (at least the bytes asked for)
+  size_t pageSize; //!< size of the pages backing the mapping
+};
+} // namespace
+
+// mappings of allocPages by address; protected by allocLock. Pages may be
+// allocated and freed during static construction and destruction, so the map
+// is constructed on first use and never destroyed
+static std::map<void*, Mapping>& getMappings() {
+  static auto* mappings = new std::map<void*, Mapping>();
+  return *mappings;
+}
+
+static galois::substrate::SimpleLock statsLock;
+// protected by statsLock; constructed on first use like the mappings
+static galois::substrate::PageAllocStats& getStats() {
+  static auto* stats = new galois::substrate::PageAllocStats();
+  return *stats;
+}
+
 static void* trymmap(size_t size, int flag) {
   std::lock_guard<galois::substrate::SimpleLock> lg(allocLock);
   const int _PROT = PROT_READ | PROT_WRITE;
@@ -51,51 +84,185 @@ static_assert(0, "No Anonymous mapping");
 #endif
 
 static const int _MAP = _MAP_ANON | MAP_PRIVATE;
-#ifdef MAP_POPULATE
-static const int _MAP_POP   = MAP_POPULATE | _MAP;
-static const bool doHandMap = false;
+
+// maps hugetlbfs pages; pageFlag selects a page size other than the default
+static void* mapHuge(size_t size, int pageFlag) {
+#ifdef MAP_HUGETLB
+  return trymmap(size, _MAP | MAP_HUGETLB | pageFlag);
 #else
-static const int _MAP_POP      = _MAP;
-static const bool doHandMap    = true;
+  return nullptr;
 #endif
-#ifdef MAP_HUGETLB
-static const int _MAP_HUGE_POP = MAP_HUGETLB | _MAP_POP;
-static const int _MAP_HUGE     = MAP_HUGETLB | _MAP;
+}
+
+// maps small pages aligned to huge pages and advises the kernel to back
+// them with transparent huge pages
+static void* mapTHP(size_t size) {
+#ifdef MADV_HUGEPAGE
+  char* ptr = static_cast<char*>(trymmap(size + hugePageSize, _MAP));
+  if (!ptr)
+    return nullptr;
+  // trim the mapping to an aligned range
+  size_t head = (hugePageSize - (uintptr_t)ptr % hugePageSize) % hugePageSize;
+  {
+    std::lock_guard<galois::substrate::SimpleLock> lg(allocLock);
+    if (head)
+      munmap(ptr, head);
+    if (hugePageSize - head)
+      munmap(ptr + head + size, hugePageSize - head);
+  }
+  ptr += head;
+  if (madvise(ptr, size, MADV_HUGEPAGE) != 0)
+    galois::gDebug("madvise(MADV_HUGEPAGE) failed");
+  return ptr;
 #else
-static const int _MAP_HUGE_POP = _MAP_POP;
-static const int _MAP_HUGE     = _MAP;
+  return nullptr;
 #endif
+}
+
+// first kind of pages to try (GALOIS_HUGE_PAGES)
+static PageKind firstPageKind() {
+  std::string policy;
+  if (!galois::substrate::EnvCheck("GALOIS_HUGE_PAGES", policy) ||
+      policy.empty())
+    return PageKind::HUGE_2M;
+  if (policy == "1G")
+    return PageKind::HUGE_1G;
+  if (policy == "2M")
+    return PageKind::HUGE_2M;
+  if (policy == "thp")
+    return PageKind::THP;
+  if (policy == "none")
+    return PageKind::SMALL;
+  galois::gWarn("Unknown GALOIS_HUGE_PAGES policy ", policy,
+                "; using 2M pages");
+  return PageKind::HUGE_2M;
+}
 
 size_t galois::substrate::allocSize() { return hugePageSize; }
 
 void* galois::substrate::allocPages(unsigned num, bool preFault) {
-  if (num > 0) {
-    void* ptr =
-        trymmap(num * hugePageSize, preFault ? _MAP_HUGE_POP : _MAP_HUGE);
-    if (!ptr) {
-      gDebug("Huge page alloc failed, falling back");
-      ptr = trymmap(num * hugePageSize, preFault ? _MAP_POP : _MAP);
+  if (num == 0)
+    return nullptr;
+
+  static const PageKind first = firstPageKind();
+  size_t size                 = num * hugePageSize;
+  void* ptr                   = nullptr;
+  Mapping mapping{size, smallPageSize};
+  bool failed = false;
+  int kind    = (int)first;
+
+  for (; kind < (int)PageKind::NUM_KINDS; ++kind) {
+    switch ((PageKind)kind) {
+    case PageKind::HUGE_1G:
+#if defined(MAP_HUGETLB) && defined(MAP_HUGE_1GB)
+      // only worth a 1 GB page if it is mostly used
+      if (size >= gigaPageSize) {
+        mapping.length =
+            (size + gigaPageSize - 1) / gigaPageSize * gigaPageSize;
+        mapping.pageSize = gigaPageSize;
+        ptr              = mapHuge(mapping.length, MAP_HUGE_1GB);
+        failed |= !ptr;
+      }
+#endif
+      break;
+    case PageKind::HUGE_2M:
+      mapping = Mapping{size, hugePageSize};
+      ptr     = mapHuge(size, 0);
+      failed |= !ptr;
+      break;
+    case PageKind::THP:
+      // touching one byte per huge page faults in a whole THP
+      mapping = Mapping{size, hugePageSize};
+      ptr     = mapTHP(size);
+      failed |= !ptr;
+      break;
+    default:
+      mapping = Mapping{size, smallPageSize};
+      ptr     = trymmap(size, _MAP);
+      break;
     }
+    if (ptr)
+      break;
+  }
 
-    if (!ptr)
-      GALOIS_SYS_DIE("Out of Memory");
+  if (!ptr)
+    GALOIS_SYS_DIE("Out of Memory");
+  if (failed) {
+    // the default 2M kind needs a hugetlbfs reservation that most machines
+    // lack, so say once which kind is used instead
+    static const char* const kindNames[] = {"1G", "2M", "THP", "small"};
+    static std::atomic<bool> warned(false);
+    if (!warned.exchange(true))
+      gWarn("Could not map ", kindNames[(int)first],
+            " pages; falling back to ", kindNames[kind],
+            " pages (see GALOIS_HUGE_PAGES)");
+  }
 
-    if (preFault && doHandMap)
-      for (size_t x = 0; x < num * hugePageSize; x += 4096)
-        static_cast<char*>(ptr)[x] = 0;
+  {
+    std::lock_guard<SimpleLock> lg(allocLock);
+    getMappings()[ptr] = mapping;
+  }
+  {
+    std::lock_guard<SimpleLock> lg(statsLock);
+    auto& stats = getStats();
+    stats.bytes[kind] += mapping.length;
+    stats.allocations[kind] += 1;
+    stats.fallbacks += failed;
+  }
 
-    return ptr;
-  } else {
-    return nullptr;
+  // fault in by hand outside of allocLock so that allocations of several
+  // threads do not serialize
+  if (preFault) {
+    auto start = std::chrono::high_resolution_clock::now();
+    for (size_t x = 0; x < size; x += mapping.pageSize)
+      static_cast<char*>(ptr)[x] = 0;
+    recordFaultTime(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        std::chrono::high_resolution_clock::now() - start)
+                        .count());
+    recordPageFaults(ThreadPool::getSocket(), size);
   }
+
+  return ptr;
 }
 
 void galois::substrate::freePages(void* ptr, unsigned num) {
   std::lock_guard<SimpleLock> lg(allocLock);
-  if (munmap(ptr, num * hugePageSize) != 0)
+  auto& mappings = getMappings();
+  size_t length  = num * hugePageSize;
+  auto mapping   = mappings.find(ptr);
+  if (mapping != mappings.end()) {
+    length = mapping->second.length;
+    mappings.erase(mapping);
+  }
+  if (munmap(ptr, length) != 0)
     GALOIS_SYS_DIE("Unmap failed");
 }
 
+size_t galois::substrate::pageSizeOf(void* ptr) {
+  std::lock_guard<SimpleLock> lg(allocLock);
+  auto& mappings = getMappings();
+  auto mapping   = mappings.find(ptr);
+  return mapping != mappings.end() ? mapping->second.pageSize : smallPageSize;
+}
+
+galois::substrate::PageAllocStats galois::substrate::getPageAllocStats() {
+  std::lock_guard<SimpleLock> lg(statsLock);
+  return getStats();
+}
+
+void galois::substrate::recordPageFaults(unsigned socket, size_t bytes) {
+  std::lock_guard<SimpleLock> lg(statsLock);
+  auto& stats = getStats();
+  if (stats.socketBytes.size() <= socket)
+    stats.socketBytes.resize(socket + 1);
+  stats.socketBytes[socket] += bytes;
+}
+
+void galois::substrate::recordFaultTime(uint64_t nanoseconds) {
+  std::lock_guard<SimpleLock> lg(statsLock);
+  getStats().faultNanoseconds += nanoseconds;
+}
+
 /*
 
 class PageSizeConf {
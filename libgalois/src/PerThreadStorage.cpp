@@ -21,6 +21,10 @@
 
 //#include "galois/runtime/Mem.h"
 #include "galois/gIO.h"
+#include "galois/substrate/CompilerSpecific.h"
+
+#include <algorithm>
+#include <cstdlib>
 #include <mutex>
 
 thread_local char* galois::substrate::ptsBase;
@@ -41,7 +45,13 @@ galois::substrate::PerBackend& galois::substrate::getPPSBackend() {
 #ifdef MORE_MEM_HACK
 const size_t allocSize =
     16 * (2 << 20); // galois::runtime::MM::hugePageSize * 16;
-inline void* alloc() { return malloc(allocSize); }
+// cache line aligned so that offsets aligned to a cache line are as well
+inline void* alloc() {
+  void* p = nullptr;
+  if (posix_memalign(&p, GALOIS_CACHE_LINE_SIZE, allocSize))
+    GALOIS_DIE("PTS out of memory error");
+  return p;
+}
 
 #else
 const size_t allocSize = galois::runtime::MM::hugePageSize;
@@ -66,8 +76,15 @@ unsigned galois::substrate::PerBackend::allocOffset(const unsigned sz) {
   unsigned size   = (1 << ll);
 
   if ((nextLoc + size) <= allocSize) {
-    // simple path, where we allocate bump ptr style
-    retval = __sync_fetch_and_add(&nextLoc, size);
+    // simple path, where we allocate bump ptr style; offsets are aligned to
+    // their size up to a cache line so that over-aligned types (e.g. ones
+    // moved with AVX-512 stores) stay aligned
+    unsigned align = std::min(size, (unsigned)GALOIS_CACHE_LINE_SIZE);
+    unsigned old;
+    do {
+      old    = nextLoc;
+      retval = (old + align - 1) & ~(align - 1);
+    } while (!__sync_bool_compare_and_swap(&nextLoc, old, retval + size));
   } else if (!invalid) {
     // find a free offset
     std::lock_guard<Lock> llock(freeOffsetsLock);
@@ -0,0 +1,417 @@
+/*
+ * This file belongs to the Galois project, a C++ library for exploiting parallelism.
+ * The code is being released under the terms of the 3-Clause BSD License (a
+ * copy is located in LICENSE.txt at the top-level directory).
+ *
+ * Copyright (C) 2018, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ */
+
+#include "galois/SetIntersection.h"
+#include "galois/substrate/EnvCheck.h"
+#include "galois/gIO.h"
+
+#include <algorithm>
+#include <atomic>
+#include <string>
+#include <utility>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define GALOIS_SET_INTERSECTION_X86
+#include <immintrin.h>
+// kernels are compiled for their instruction set regardless of the flags of
+// the build and only called if the machine supports it
+#define GALOIS_TARGET_SSE4_2 __attribute__((target("sse4.2,popcnt")))
+#define GALOIS_TARGET_AVX2 __attribute__((target("avx2,popcnt")))
+#define GALOIS_TARGET_AVX512 __attribute__((target("avx512f,popcnt")))
+#endif
+
+using galois::SetIntersectionISA;
+
+namespace {
+
+//! sets whose sizes differ by more than this factor are intersected by
+//! galloping through the larger one
+constexpr size_t GALLOP_RATIO = 32;
+
+//! where to write common elements; null members are not written
+template <typename T>
+struct Output {
+  T* values;
+  uint32_t* posA;
+  uint32_t* posB;
+
+  bool counting() const { return !values && !posA; }
+
+  void emit(size_t k, T x, size_t i, size_t j) const {
+    if (values)
+      values[k] = x;
+    if (posA) {
+      posA[k] = i;
+      posB[k] = j;
+    }
+  }
+};
+
+template <typename T>
+size_t merge(const T* a, size_t i, size_t na, const T* b, size_t j, size_t nb,
+             size_t k, const Output<T>& o) {
+  while (i < na && j < nb) {
+    if (a[i] < b[j]) {
+      ++i;
+    } else if (b[j] < a[i]) {
+      ++j;
+    } else {
+      o.emit(k++, a[i], i, j);
+      ++i;
+      ++j;
+    }
+  }
+  return k;
+}
+
+//! looks up each element of the small set a in the large set b by doubling
+//! steps from the previous match and a binary search within the last step
+template <typename T>
+size_t gallop(const T* a, size_t na, const T* b, size_t nb,
+              const Output<T>& o) {
+  size_t k = 0;
+  size_t j = 0;
+  for (size_t i = 0; i < na && j < nb; ++i) {
+    size_t lo   = j;
+    size_t hi   = j;
+    size_t step = 1;
+    while (hi < nb && b[hi] < a[i]) {
+      lo = hi + 1;
+      hi += step;
+      step <<= 1;
+    }
+    j = std::lower_bound(b + lo, b + std::min(hi + 1, nb), a[i]) - b;
+    if (j < nb && b[j] == a[i]) {
+      o.emit(k++, a[i], i, j);
+      ++j;
+    }
+  }
+  return k;
+}
+
+template <typename T>
+size_t intersectScalar(const T* a, size_t na, const T* b, size_t nb,
+                       const Output<T>& o) {
+  return merge(a, 0, na, b, 0, nb, 0, o);
+}
+
+#ifdef GALOIS_SET_INTERSECTION_X86
+
+/*
+ * The SIMD kernels compare a block of a with every element of a block of b,
+ * rotating or broadcasting it, which gives a mask of the elements of the
+ * block of a that are in the block of b, and then move past the block with
+ * the smaller maximum (or both).
+ * The remainder is merged.
+ */
+
+//! records the elements of a block of a at the set bits of mask
+template <typename T>
+size_t emitMask(const Output<T>& o, size_t k, const T* a, size_t i,
+                const T* b, size_t j, size_t width, unsigned mask) {
+  if (o.counting())
+    return k + __builtin_popcount(mask);
+  for (; mask; mask &= mask - 1) {
+    size_t x = i + __builtin_ctz(mask);
+    size_t y = o.posA ? std::lower_bound(b + j, b + j + width, a[x]) - b : 0;
+    o.emit(k++, a[x], x, y);
+  }
+  return k;
+}
+
+template <typename T>
+void advanceBlocks(const T* a, size_t& i, const T* b, size_t& j,
+                   size_t width) {
+  T amax = a[i + width - 1];
+  T bmax = b[j + width - 1];
+  i += (amax <= bmax) ? width : 0;
+  j += (bmax <= amax) ? width : 0;
+}
+
+GALOIS_TARGET_SSE4_2 unsigned matchMaskSSE(const uint32_t* a,
+                                           const uint32_t* b) {
+  __m128i va = _mm_loadu_si128((const __m128i*)a);
+  __m128i vb = _mm_loadu_si128((const __m128i*)b);
+  __m128i eq = _mm_or_si128(
+      _mm_or_si128(
+          _mm_cmpeq_epi32(va, vb),
+          _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(0, 3, 2, 1)))),
+      _mm_or_si128(
+          _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(1, 0, 3, 2))),
+          _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(2, 1, 0, 3)))));
+  return _mm_movemask_ps(_mm_castsi128_ps(eq));
+}
+
+GALOIS_TARGET_SSE4_2 unsigned matchMaskSSE(const uint64_t* a,
+                                           const uint64_t* b) {
+  __m128i va = _mm_loadu_si128((const __m128i*)a);
+  __m128i vb = _mm_loadu_si128((const __m128i*)b);
+  __m128i eq = _mm_or_si128(
+      _mm_cmpeq_epi64(va, vb),
+      _mm_cmpeq_epi64(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(1, 0, 3, 2))));
+  return _mm_movemask_pd(_mm_castsi128_pd(eq));
+}
+
+template <typename T>
+GALOIS_TARGET_SSE4_2 size_t intersectSSE(const T* a, size_t na, const T* b,
+                                         size_t nb, const Output<T>& o) {
+  constexpr size_t width = 16 / sizeof(T);
+  size_t i = 0, j = 0, k = 0;
+  while (i + width <= na && j + width <= nb) {
+    k = emitMask(o, k, a, i, b, j, width, matchMaskSSE(a + i, b + j));
+    advanceBlocks(a, i, b, j, width);
+  }
+  return merge(a, i, na, b, j, nb, k, o);
+}
+
+GALOIS_TARGET_AVX2 unsigned matchMaskAVX2(const uint32_t* a,
+                                          const uint32_t* b) {
+  const __m256i rotate = _mm256_setr_epi32(1, 2, 3, 4, 5, 6, 7, 0);
+  __m256i va           = _mm256_loadu_si256((const __m256i*)a);
+  __m256i vb           = _mm256_loadu_si256((const __m256i*)b);
+  __m256i eq           = _mm256_cmpeq_epi32(va, vb);
+  for (int r = 1; r < 8; ++r) {
+    vb = _mm256_permutevar8x32_epi32(vb, rotate);
+    eq = _mm256_or_si256(eq, _mm256_cmpeq_epi32(va, vb));
+  }
+  return _mm256_movemask_ps(_mm256_castsi256_ps(eq));
+}
+
+GALOIS_TARGET_AVX2 unsigned matchMaskAVX2(const uint64_t* a,
+                                          const uint64_t* b) {
+  __m256i va = _mm256_loadu_si256((const __m256i*)a);
+  __m256i vb = _mm256_loadu_si256((const __m256i*)b);
+  __m256i eq = _mm256_cmpeq_epi64(va, vb);
+  for (int r = 1; r < 4; ++r) {
+    vb = _mm256_permute4x64_epi64(vb, _MM_SHUFFLE(0, 3, 2, 1));
+    eq = _mm256_or_si256(eq, _mm256_cmpeq_epi64(va, vb));
+  }
+  return _mm256_movemask_pd(_mm256_castsi256_pd(eq));
+}
+
+template <typename T>
+GALOIS_TARGET_AVX2 size_t intersectAVX2(const T* a, size_t na, const T* b,
+                                        size_t nb, const Output<T>& o) {
+  constexpr size_t width = 32 / sizeof(T);
+  size_t i = 0, j = 0, k = 0;
+  while (i + width <= na && j + width <= nb) {
+    k = emitMask(o, k, a, i, b, j, width, matchMaskAVX2(a + i, b + j));
+    advanceBlocks(a, i, b, j, width);
+  }
+  return merge(a, i, na, b, j, nb, k, o);
+}
+
+GALOIS_TARGET_AVX512 unsigned matchMaskAVX512(const uint32_t* a,
+                                              const uint32_t* b) {
+  // compares with each element of b broadcast from memory
+  __m512i va   = _mm512_loadu_si512(a);
+  __mmask16 eq = 0;
+  for (int r = 0; r < 16; ++r)
+    eq |= _mm512_cmpeq_epi32_mask(va, _mm512_set1_epi32(b[r]));
+  return eq;
+}
+
+GALOIS_TARGET_AVX512 unsigned matchMaskAVX512(const uint64_t* a,
+                                              const uint64_t* b) {
+  __m512i va  = _mm512_loadu_si512(a);
+  __mmask8 eq = 0;
+  for (int r = 0; r < 8; ++r)
+    eq |= _mm512_cmpeq_epi64_mask(va, _mm512_set1_epi64(b[r]));
+  return eq;
+}
+
+template <typename T>
+GALOIS_TARGET_AVX512 size_t intersectAVX512(const T* a, size_t na,
+                                            const T* b, size_t nb,
+                                            const Output<T>& o) {
+  constexpr size_t width = 64 / sizeof(T);
+  size_t i = 0, j = 0, k = 0;
+  while (i + width <= na && j + width <= nb) {
+    k = emitMask(o, k, a, i, b, j, width, matchMaskAVX512(a + i, b + j));
+    advanceBlocks(a, i, b, j, width);
+  }
+  return merge(a, i, na, b, j, nb, k, o);
+}
+
+#endif // GALOIS_SET_INTERSECTION_X86
+
+template <typename T>
+using Kernel = size_t (*)(const T*, size_t, const T*, size_t,
+                          const Output<T>&);
+
+struct Kernels {
+  SetIntersectionISA isa;
+  Kernel<uint32_t> kernel32;
+  Kernel<uint64_t> kernel64;
+};
+
+Kernels kernelsFor(SetIntersectionISA isa) {
+  switch (isa) {
+#ifdef GALOIS_SET_INTERSECTION_X86
+  case SetIntersectionISA::AVX512:
+    return Kernels{isa, intersectAVX512<uint32_t>, intersectAVX512<uint64_t>};
+  case SetIntersectionISA::AVX2:
+    return Kernels{isa, intersectAVX2<uint32_t>, intersectAVX2<uint64_t>};
+  case SetIntersectionISA::SSE4_2:
+    return Kernels{isa, intersectSSE<uint32_t>, intersectSSE<uint64_t>};
+#endif
+  default:
+    return Kernels{SetIntersectionISA::SCALAR, intersectScalar<uint32_t>,
+                   intersectScalar<uint64_t>};
+  }
+}
+
+SetIntersectionISA envISA() {
+  SetIntersectionISA supported = galois::getSupportedSetIntersectionISA();
+  std::string isa;
+  if (!galois::substrate::EnvCheck("GALOIS_SET_INTERSECTION", isa) ||
+      isa.empty())
+    return supported;
+  SetIntersectionISA requested = supported;
+  if (isa == "scalar")
+    requested = SetIntersectionISA::SCALAR;
+  else if (isa == "sse4.2")
+    requested = SetIntersectionISA::SSE4_2;
+  else if (isa == "avx2")
+    requested = SetIntersectionISA::AVX2;
+  else if (isa == "avx512")
+    requested = SetIntersectionISA::AVX512;
+  else
+    galois::gWarn("Unknown GALOIS_SET_INTERSECTION instruction set ", isa);
+  return std::min(requested, supported);
+}
+
+// kernels of each instruction set; never changes after construction
+const Kernels& kernelTable(SetIntersectionISA isa) {
+  static const Kernels table[] = {
+      kernelsFor(SetIntersectionISA::SCALAR),
+      kernelsFor(SetIntersectionISA::SSE4_2),
+      kernelsFor(SetIntersectionISA::AVX2),
+      kernelsFor(SetIntersectionISA::AVX512)};
+  return table[(int)isa];
+}
+
+// kernels in use; only setSetIntersectionISA changes them, while the runtime
+// is idle, but the pointer is atomic so that a stray concurrent call reads
+// either the old or the new table and never a torn one
+std::atomic<const Kernels*>& currentKernels() {
+  static std::atomic<const Kernels*> current(&kernelTable(envISA()));
+  return current;
+}
+
+const Kernels& getKernels() {
+  return *currentKernels().load(std::memory_order_acquire);
+}
+
+template <typename T>
+size_t run(Kernel<T> kernel, const T* a, size_t na, const T* b, size_t nb,
+           Output<T> o) {
+  if (!na || !nb || a[na - 1] < b[0] || b[nb - 1] < a[0])
+    return 0;
+  if (na * GALLOP_RATIO < nb)
+    return gallop(a, na, b, nb, o);
+  if (nb * GALLOP_RATIO < na) {
+    std::swap(o.posA, o.posB);
+    return gallop(b, nb, a, na, o);
+  }
+  return kernel(a, na, b, nb, o);
+}
+
+} // namespace
+
+SetIntersectionISA galois::getSupportedSetIntersectionISA() {
+#ifdef GALOIS_SET_INTERSECTION_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f"))
+    return SetIntersectionISA::AVX512;
+  if (__builtin_cpu_supports("avx2"))
+    return SetIntersectionISA::AVX2;
+  if (__builtin_cpu_supports("sse4.2") && __builtin_cpu_supports("popcnt"))
+    return SetIntersectionISA::SSE4_2;
+#endif
+  return SetIntersectionISA::SCALAR;
+}
+
+SetIntersectionISA galois::getSetIntersectionISA() { return getKernels().isa; }
+
+void galois::setSetIntersectionISA(SetIntersectionISA isa) {
+  currentKernels().store(
+      &kernelTable(std::min(isa, getSupportedSetIntersectionISA())),
+      std::memory_order_release);
+}
+
+size_t galois::intersectCount(const uint32_t* a, size_t na, const uint32_t* b,
+                              size_t nb) {
+  return run(getKernels().kernel32, a, na, b, nb,
+             Output<uint32_t>{nullptr, nullptr, nullptr});
+}
+
+size_t galois::intersectCount(const uint64_t* a, size_t na, const uint64_t* b,
+                              size_t nb) {
+  return run(getKernels().kernel64, a, na, b, nb,
+             Output<uint64_t>{nullptr, nullptr, nullptr});
+}
+
+size_t galois::intersect(const uint32_t* a, size_t na, const uint32_t* b,
+                         size_t nb, uint32_t* out) {
+  return run(getKernels().kernel32, a, na, b, nb,
+             Output<uint32_t>{out, nullptr, nullptr});
+}
+
+size_t galois::intersect(const uint64_t* a, size_t na, const uint64_t* b,
+                         size_t nb, uint64_t* out) {
+  return run(getKernels().kernel64, a, na, b, nb,
+             Output<uint64_t>{out, nullptr, nullptr});
+}
+
+size_t galois::intersectPositions(const uint32_t* a, size_t na,
+                                  const uint32_t* b, size_t nb,
+                                  uint32_t* posA, uint32_t* posB) {
+  return run(getKernels().kernel32, a, na, b, nb,
+             Output<uint32_t>{nullptr, posA, posB});
+}
+
+void galois::SortedSetBitmap::assign(const uint32_t* s, size_t n,
+                                     size_t universe) {
+  clear();
+  if (words.size() * 64 < universe)
+    words.resize((universe + 63) / 64);
+  for (size_t i = 0; i < n; ++i) {
+    uint64_t& w = words[s[i] >> 6];
+    if (!w)
+      used.push_back(s[i] >> 6);
+    w |= uint64_t(1) << (s[i] & 63);
+  }
+}
+
+void galois::SortedSetBitmap::clear() {
+  for (size_t w : used)
+    words[w] = 0;
+  used.clear();
+}
+
+size_t galois::SortedSetBitmap::intersectCount(const uint32_t* b,
+                                               size_t nb) const {
+  if (used.empty())
+    return 0;
+  size_t k = 0;
+  for (size_t i = 0; i < nb; ++i)
+    k += test(b[i]);
+  return k;
+}
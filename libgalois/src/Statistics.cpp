@@ -19,6 +19,7 @@
 
 #include "galois/runtime/Statistics.h"
 #include "galois/runtime/Executor_OnEach.h"
+#include "galois/substrate/PageAlloc.h"
 
 #include <iostream>
 #include <fstream>
@@ -115,16 +116,31 @@ void galois::runtime::reportPageAlloc(const char* category) {
         reportStat_Tsum("PageAlloc", category, numPagePoolAllocForThread(tid));
       },
       std::make_tuple());
+
+  // large allocations bypass the page pool
+  static const char* const kindNames[] = {"1G", "2M", "THP", "Small"};
+  auto stats = substrate::getPageAllocStats();
+  std::string prefix(category);
+  for (int k = 0; k < (int)substrate::PageKind::NUM_KINDS; ++k) {
+    reportStat_Single("LargeAlloc", prefix + "_Bytes" + kindNames[k],
+                      stats.bytes[k]);
+    reportStat_Single("LargeAlloc", prefix + "_Allocs" + kindNames[k],
+                      stats.allocations[k]);
+  }
+  reportStat_Single("LargeAlloc", prefix + "_Fallbacks", stats.fallbacks);
+  reportStat_Single("LargeAlloc", prefix + "_FaultNanoseconds",
+                    stats.faultNanoseconds);
 }
 
 void galois::runtime::reportNumaAlloc(const char* category) {
-  galois::gWarn("reportNumaAlloc NOT IMPLEMENTED YET. TBD");
-  int nodes = substrate::getThreadPool().getMaxNumaNodes();
-  for (int x = 0; x < nodes; ++x) {
-    // auto rStat = Stats.getRemote(x);
-    // std::lock_guard<substrate::SimpleLock> lg(rStat->first);
-    //      rStat->second.emplace_back(loop, category, numNumaAllocForNode(x));
+  // bytes of large allocations first touched by the threads of each socket
+  auto stats = substrate::getPageAllocStats();
+  size_t sockets = substrate::getThreadPool().getMaxSockets();
+  if (stats.socketBytes.size() < sockets)
+    stats.socketBytes.resize(sockets);
+  std::string prefix(category);
+  for (size_t x = 0; x < stats.socketBytes.size(); ++x) {
+    reportStat_Single("NumaAlloc", prefix + "_Socket" + std::to_string(x),
+                      stats.socketBytes[x]);
   }
-  //  SC->addNumaAllocToStat(std::string("(NULL)"), std::string(category ?
-  //  category : "(NULL)"));
 }
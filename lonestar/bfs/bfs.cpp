@@ -22,7 +22,9 @@
 #include "galois/Reduction.h"
 #include "galois/Timer.h"
 #include "galois/Timer.h"
+#include "galois/LargeArray.h"
 #include "galois/graphs/LCGraph.h"
+#include "galois/graphs/LC_InOut_Graph.h"
 #include "galois/graphs/TypeTraits.h"
 #include "llvm/Support/CommandLine.h"
 
@@ -61,10 +63,10 @@ static cll::opt<unsigned int>
 
 enum Exec { SERIAL, PARALLEL };
 
-enum Algo { AsyncTile = 0, Async, SyncTile, Sync, Sync2pTile, Sync2p };
+enum Algo { AsyncTile = 0, Async, SyncTile, Sync, Sync2pTile, Sync2p, DirOpt };
 
-const char* const ALGO_NAMES[] = {"AsyncTile", "Async",      "SyncTile",
-                                  "Sync",      "Sync2pTile", "Sync2p"};
+const char* const ALGO_NAMES[] = {"AsyncTile",  "Async",  "SyncTile", "Sync",
+                                  "Sync2pTile", "Sync2p", "DirOpt"};
 
 static cll::opt<Exec> execution(
     "exec",
@@ -78,12 +80,46 @@ static cll::opt<Algo> algo(
     cll::values(clEnumVal(AsyncTile, "AsyncTile"), clEnumVal(Async, "Async"),
                 clEnumVal(SyncTile, "SyncTile"), clEnumVal(Sync, "Sync"),
                 clEnumVal(Sync2pTile, "Sync2pTile"),
-                clEnumVal(Sync2p, "Sync2p"), clEnumValEnd),
+                clEnumVal(Sync2p, "Sync2p"),
+                clEnumVal(DirOpt, "DirOpt (push/pull direction-optimizing; "
+                                  "needs -graphTranspose or -symmetricGraph)"),
+                clEnumValEnd),
     cll::init(SyncTile));
 
+static cll::opt<std::string>
+    transposeGraphName("graphTranspose",
+                       cll::desc("Transpose of input graph (DirOpt only)"));
+static cll::opt<bool>
+    symmetricGraph("symmetricGraph",
+                   cll::desc("Input graph is symmetric (DirOpt only)"),
+                   cll::init(false));
+static cll::opt<unsigned int> dirOptAlpha(
+    "alpha",
+    cll::desc("DirOpt switches to pull when the frontier has more than "
+              "1/alpha of the unexplored edges (default value 15)"),
+    cll::init(15));
+static cll::opt<unsigned int> dirOptBeta(
+    "beta",
+    cll::desc("DirOpt switches back to push when the frontier shrinks "
+              "below 1/beta of the nodes (default value 18)"),
+    cll::init(18));
+static cll::opt<bool> compareAsync(
+    "compareAsync",
+    cll::desc("Also run Async on the out-edges and check that DirOpt "
+              "computes the same levels (DirOpt only; default value false)"),
+    cll::init(false));
+
+static cll::opt<bool> compressed(
+    "compressed",
+    cll::desc("Use a graph with delta + varint compressed adjacency lists "
+              "(Async and Sync only; default value false)"),
+    cll::init(false));
+
 using Graph =
     galois::graphs::LC_CSR_Graph<unsigned, void>::with_no_lockable<true>::type;
 //::with_numa_alloc<true>::type;
+using CGraph = galois::graphs::LC_CCSR_Graph<unsigned, void>;
+using InOutGraph = galois::graphs::LC_InOut_Graph<Graph>;
 
 using GNode = Graph::GraphNode;
 
@@ -91,7 +127,9 @@ constexpr static const bool TRACK_WORK          = false;
 constexpr static const unsigned CHUNK_SIZE      = 256u;
 constexpr static const ptrdiff_t EDGE_TILE_SIZE = 256;
 
-using BFS = BFS_SSSP<Graph, unsigned int, false, EDGE_TILE_SIZE>;
+using BFS  = BFS_SSSP<Graph, unsigned int, false, EDGE_TILE_SIZE>;
+using CBFS = BFS_SSSP<CGraph, unsigned int, false, EDGE_TILE_SIZE>;
+using IOBFS = BFS_SSSP<InOutGraph, unsigned int, false, EDGE_TILE_SIZE>;
 
 using UpdateRequest       = BFS::UpdateRequest;
 using Dist                = BFS::Dist;
@@ -158,8 +196,8 @@ struct OneTilePushWrap {
   }
 };
 
-template <bool CONCURRENT, typename T, typename P, typename R>
-void asyncAlgo(Graph& graph, GNode source, const P& pushWrap,
+template <bool CONCURRENT, typename T, typename G, typename P, typename R>
+void asyncAlgo(G& graph, GNode source, const P& pushWrap,
                const R& edgeRange) {
 
   namespace gwl = galois::worklists;
@@ -243,9 +281,8 @@ void asyncAlgo(Graph& graph, GNode source, const P& pushWrap,
   }
 }
 
-template <bool CONCURRENT, typename T, typename P, typename R>
-void syncAlgo(Graph& graph, GNode source, const P& pushWrap,
-              const R& edgeRange) {
+template <bool CONCURRENT, typename T, typename G, typename P, typename R>
+void syncAlgo(G& graph, GNode source, const P& pushWrap, const R& edgeRange) {
 
   using Cont = typename std::conditional<CONCURRENT, galois::InsertBag<T>,
                                          galois::SerStack<T>>::type;
@@ -355,6 +392,165 @@ void sync2phaseAlgo(Graph& graph, GNode source, const P& pushWrap,
   }
 }
 
+//! One bit per node; used as the frontier of bottom-up (pull) steps
+class Bitmap {
+  galois::LargeArray<uint64_t> words;
+
+public:
+  void resize(size_t n) { words.allocateInterleaved((n + 63) / 64); }
+
+  template <typename Loop>
+  void clear(Loop& loop) {
+    loop(galois::iterate(size_t{0}, words.size()),
+         [&](size_t i) { words[i] = 0; }, galois::loopname("BitmapClear"));
+  }
+
+  bool test(size_t i) const { return (words[i / 64] >> (i % 64)) & 1; }
+
+  template <bool CONCURRENT>
+  void set(size_t i) {
+    uint64_t mask = uint64_t{1} << (i % 64);
+    if (CONCURRENT) {
+      __sync_fetch_and_or(&words[i / 64], mask);
+    } else {
+      words[i / 64] |= mask;
+    }
+  }
+};
+
+/**
+ * Direction-optimizing BFS (Beamer et al., SC'12). Top-down steps push from
+ * a sparse frontier over out-edges; when the edges leaving the frontier
+ * exceed 1/alpha of the edges not yet explored, bottom-up steps have every
+ * unvisited node pull over its in-edges until it finds a parent in the
+ * (bitmap) frontier. It goes back to pushing once the frontier is shrinking
+ * and smaller than 1/beta of the nodes.
+ */
+template <bool CONCURRENT>
+void dirOptAlgo(InOutGraph& graph, GNode source) {
+
+  using Cont = typename std::conditional<CONCURRENT, galois::InsertBag<GNode>,
+                                         galois::SerStack<GNode>>::type;
+  using Loop = typename std::conditional<CONCURRENT, galois::DoAll,
+                                         galois::StdForEach>::type;
+
+  constexpr galois::MethodFlag flag = galois::MethodFlag::UNPROTECTED;
+
+  Loop loop;
+
+  auto degree = [&](GNode n) {
+    return size_t(std::distance(graph.edge_begin(n, flag),
+                                graph.edge_end(n, flag)));
+  };
+
+  Cont* curr = new Cont();
+  Cont* next = new Cont();
+  Bitmap frontBits;
+  Bitmap nextBits;
+  frontBits.resize(graph.size());
+  nextBits.resize(graph.size());
+
+  galois::GAccumulator<size_t> scout;
+  galois::GAccumulator<size_t> awake;
+
+  Dist level                  = 0u;
+  graph.getData(source, flag) = 0u;
+  next->push(source);
+
+  size_t scoutCount   = degree(source);
+  size_t edgesToCheck = graph.sizeEdges();
+  size_t numPush      = 0;
+  size_t numPull      = 0;
+
+  while (!next->empty()) {
+    if (scoutCount > edgesToCheck / dirOptAlpha) {
+      // bottom-up: switch the frontier to a bitmap
+      frontBits.clear(loop);
+      loop(galois::iterate(*next),
+           [&](GNode n) { frontBits.template set<CONCURRENT>(n); },
+           galois::loopname("ToBitmap"));
+
+      size_t oldAwake = 0;
+      size_t numAwake = std::distance(next->begin(), next->end());
+      do {
+        ++level;
+        ++numPull;
+        oldAwake = numAwake;
+        nextBits.clear(loop);
+        awake.reset();
+
+        loop(galois::iterate(graph),
+             [&](GNode dst) {
+               auto& dstData = graph.getData(dst, flag);
+               if (dstData != BFS::DIST_INFINITY)
+                 return;
+               for (auto e : graph.in_edges(dst, flag)) {
+                 if (frontBits.test(graph.getInEdgeDst(e))) {
+                   dstData = level;
+                   nextBits.template set<CONCURRENT>(dst);
+                   awake += 1;
+                   break;
+                 }
+               }
+             },
+             galois::steal(), galois::chunk_size<CHUNK_SIZE>(),
+             galois::loopname("Pull"));
+
+        std::swap(frontBits, nextBits);
+        numAwake = awake.reduce();
+      } while (numAwake > 0 &&
+               (numAwake >= oldAwake || numAwake > graph.size() / dirOptBeta));
+
+      // back to a sparse frontier
+      next->clear();
+      scout.reset();
+      loop(galois::iterate(graph),
+           [&](GNode n) {
+             if (frontBits.test(n)) {
+               next->push(n);
+               scout += degree(n);
+             }
+           },
+           galois::loopname("ToSparse"));
+      scoutCount = scout.reduce();
+    } else {
+      // top-down
+      edgesToCheck -= std::min(scoutCount, edgesToCheck);
+      std::swap(curr, next);
+      next->clear();
+      ++level;
+      ++numPush;
+      scout.reset();
+
+      loop(galois::iterate(*curr),
+           [&](GNode src) {
+             for (auto e : graph.edges(src, flag)) {
+               auto dst      = graph.getEdgeDst(e);
+               auto& dstData = graph.getData(dst, flag);
+
+               if (dstData == BFS::DIST_INFINITY &&
+                   (!CONCURRENT || __sync_bool_compare_and_swap(
+                                       &dstData, BFS::DIST_INFINITY, level))) {
+                 dstData = level;
+                 next->push(dst);
+                 scout += degree(dst);
+               }
+             }
+           },
+           galois::steal(), galois::chunk_size<CHUNK_SIZE>(),
+           galois::loopname("Push"));
+
+      scoutCount = scout.reduce();
+    }
+  }
+
+  galois::runtime::reportStat_Single("BFS", "PushSteps", numPush);
+  galois::runtime::reportStat_Single("BFS", "PullSteps", numPull);
+
+  delete curr;
+  delete next;
+}
+
 template <bool CONCURRENT>
 void runAlgo(Graph& graph, const GNode& source) {
 
@@ -388,15 +584,84 @@ void runAlgo(Graph& graph, const GNode& source) {
   }
 }
 
-int main(int argc, char** argv) {
-  galois::SharedMemSys G;
-  LonestarStart(argc, argv, name, desc, url);
+template <bool CONCURRENT>
+void runAlgo(InOutGraph& graph, const GNode& source) {
+  dirOptAlgo<CONCURRENT>(graph, source);
+}
+
+//! Edge tiles need random access, so only untiled algorithms are available
+template <bool CONCURRENT>
+void runAlgo(CGraph& graph, const GNode& source) {
+
+  switch (algo) {
+  case Async:
+    asyncAlgo<CONCURRENT, CBFS::UpdateRequest>(
+        graph, source, CBFS::ReqPushWrap(), CBFS::OutEdgeRangeFn{graph});
+    break;
+  case Sync:
+    syncAlgo<CONCURRENT, GNode>(graph, source, NodePushWrap(),
+                                CBFS::OutEdgeRangeFn{graph});
+    break;
+  default:
+    GALOIS_DIE("algorithm ", ALGO_NAMES[algo],
+               " does not support -compressed; use Async or Sync");
+  }
+}
+
+template <typename G>
+void readInput(G& graph) {
+  galois::graphs::readGraph(graph, filename);
+}
+
+//! Pull steps need in-edges: from a transpose file, or the out-edges
+//! themselves if the graph is symmetric
+void readInput(InOutGraph& graph) {
+  if (symmetricGraph) {
+    galois::graphs::readGraph(graph, filename);
+  } else if (transposeGraphName.size()) {
+    galois::graphs::readGraph(graph, filename, transposeGraphName);
+  } else {
+    GALOIS_DIE("DirOpt needs -graphTranspose or -symmetricGraph");
+  }
+}
 
-  Graph graph;
+//! Only DirOpt has a second algorithm to check against
+template <typename G>
+void compareWithAsync(G&, const GNode&) {}
+
+//! Runs Async on a plain copy of the graph and compares levels node by node
+void compareWithAsync(InOutGraph& graph, const GNode& source) {
+  Graph ref;
+  galois::graphs::readGraph(ref, filename);
+
+  galois::do_all(galois::iterate(ref),
+                 [&ref](GNode n) { ref.getData(n) = BFS::DIST_INFINITY; });
+  ref.getData(source) = 0;
+
+  asyncAlgo<true, UpdateRequest>(ref, source, ReqPushWrap(),
+                                 OutEdgeRangeFn{ref});
+
+  galois::GAccumulator<size_t> mismatches;
+  galois::do_all(galois::iterate(ref), [&](GNode n) {
+    if (ref.getData(n) != graph.getData(n)) {
+      mismatches += 1;
+    }
+  });
+
+  if (mismatches.reduce()) {
+    GALOIS_DIE("DirOpt and Async levels differ at ", mismatches.reduce(),
+               " nodes");
+  }
+  std::cout << "DirOpt levels match Async.\n";
+}
+
+template <typename G, typename B>
+void run() {
+  G graph;
   GNode source, report;
 
   std::cout << "Reading from file: " << filename << std::endl;
-  galois::graphs::readGraph(graph, filename);
+  readInput(graph);
   std::cout << "Read " << graph.size() << " nodes, " << graph.sizeEdges()
             << " edges" << std::endl;
 
@@ -423,7 +688,7 @@ int main(int argc, char** argv) {
   galois::reportPageAlloc("MeminfoPre");
 
   galois::do_all(galois::iterate(graph),
-                 [&graph](GNode n) { graph.getData(n) = BFS::DIST_INFINITY; });
+                 [&graph](GNode n) { graph.getData(n) = B::DIST_INFINITY; });
   graph.getData(source) = 0;
 
   std::cout << "Running " << ALGO_NAMES[algo] << " algorithm with "
@@ -451,12 +716,36 @@ int main(int argc, char** argv) {
             << graph.getData(report) << "\n";
 
   if (!skipVerify) {
-    if (BFS::verify(graph, source)) {
+    if (B::verify(graph, source)) {
       std::cout << "Verification successful.\n";
     } else {
       GALOIS_DIE("Verification failed");
     }
   }
 
+  if (compareAsync) {
+    compareWithAsync(graph, source);
+  }
+}
+
+int main(int argc, char** argv) {
+  galois::SharedMemSys G;
+  LonestarStart(argc, argv, name, desc, url);
+
+  if (compareAsync && algo != DirOpt) {
+    GALOIS_DIE("-compareAsync only applies to DirOpt");
+  }
+
+  if (algo == DirOpt) {
+    if (compressed) {
+      GALOIS_DIE("DirOpt does not support -compressed");
+    }
+    run<InOutGraph, IOBFS>();
+  } else if (compressed) {
+    run<CGraph, CBFS>();
+  } else {
+    run<Graph, BFS>();
+  }
+
   return 0;
 }
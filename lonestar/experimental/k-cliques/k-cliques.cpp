@@ -23,6 +23,7 @@
 #include "galois/Timer.h"
 #include "galois/graphs/LCGraph.h"
 #include "galois/ParallelSTL.h"
+#include "galois/SetIntersection.h"
 #include "llvm/Support/CommandLine.h"
 #include "Lonestar/BoilerPlate.h"
 
@@ -123,23 +124,12 @@ void getNeighbors(DAGNode &n, std::vector<DAGNode> &neighbors, DAG &dag) {
  */
 
 size_t intersect(std::vector<DAGNode> &jointNeighbors, std::vector<DAGNode> &srcNeighbors, std::vector<DAGNode> &dstNeighbors) {
-  std::vector<DAGNode>::iterator srcItr= srcNeighbors.begin();
-  std::vector<DAGNode>::iterator dstItr= dstNeighbors.begin();
-  size_t size=0;
-
-  while (srcItr != srcNeighbors.end() && dstItr != dstNeighbors.end()) {
-    if (*srcItr < *dstItr) {
-    	++srcItr;
-    } else if (*dstItr < *srcItr) {
-    	++dstItr;
-    } else {
-    	jointNeighbors[size] = (*srcItr);
-    	size++;
-		++srcItr;
-    	++dstItr;
-    }
-  }
-  return size;
+  // nodes are sorted by address, so they are intersected as integers
+  static_assert(sizeof(DAGNode) == sizeof(uint64_t), "DAGNode is not 64 bits");
+  return galois::intersect(
+      reinterpret_cast<const uint64_t*>(srcNeighbors.data()), srcNeighbors.size(),
+      reinterpret_cast<const uint64_t*>(dstNeighbors.data()), dstNeighbors.size(),
+      reinterpret_cast<uint64_t*>(jointNeighbors.data()));
 }
 
 /**
@@ -384,6 +374,7 @@ void compute_kcliques(unsigned int k, DAG& dag) {
 						TIntersect.start();
 						size_t tmp_neighborsize=intersect(tmpNeighbors, srcNeighbors, w.neighbors);
 						TIntersect.stop();
+						tmpNeighbors.resize(tmp_neighborsize);
 
 						nextItem.neighbors.resize(tmp_neighborsize);
 
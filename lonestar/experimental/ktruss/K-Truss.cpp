@@ -22,6 +22,7 @@
 #include "galois/Bag.h"
 #include "galois/Timer.h"
 #include "galois/Timer.h"
+#include "galois/SetIntersection.h"
 #include "galois/graphs/Graph.h"
 #include "galois/graphs/TypeTraits.h"
 #include "llvm/Support/CommandLine.h"
@@ -32,6 +33,7 @@
 #include <algorithm>
 #include <fstream>
 #include <memory>
+#include <vector>
 
 enum Algo {
   bspJacobi,
@@ -161,41 +163,46 @@ void reportKTruss(Graph& g) {
   }
 }
 
+/**
+ * Intersects all edges of src and dst, valid or removed, and writes the
+ * positions of their common neighbors in the edges of src and dst to srcPos
+ * and dstPos.
+ *
+ * @returns number of common neighbors
+ */
+template <typename G, typename PosVec>
+size_t intersectAllEdges(G& g, typename G::edge_iterator srcI,
+                         typename G::edge_iterator srcE,
+                         typename G::edge_iterator dstI,
+                         typename G::edge_iterator dstE, PosVec& srcPos,
+                         PosVec& dstPos) {
+  size_t srcDegree = std::distance(srcI, srcE);
+  size_t dstDegree = std::distance(dstI, dstE);
+  srcPos.resize(std::min(srcDegree, dstDegree));
+  dstPos.resize(std::min(srcDegree, dstDegree));
+  return galois::intersectPositions(g.getEdgeDstPtr(srcI), srcDegree,
+                                    g.getEdgeDstPtr(dstI), dstDegree,
+                                    srcPos.data(), dstPos.data());
+}
+
 template <typename G>
 bool isSupportNoLessThanJ(G& g, typename G::GraphNode src,
                           typename G::GraphNode dst, unsigned int j) {
-  size_t numValidEqual = 0;
-  auto srcI            = g.edge_begin(src, galois::MethodFlag::UNPROTECTED),
-       srcE            = g.edge_end(src, galois::MethodFlag::UNPROTECTED),
-       dstI            = g.edge_begin(dst, galois::MethodFlag::UNPROTECTED),
-       dstE            = g.edge_end(dst, galois::MethodFlag::UNPROTECTED);
-
-  while (true) {
-    // find the first valid edge
-    while (srcI != srcE && (g.getEdgeData(srcI) & removed)) {
-      ++srcI;
-    }
-    while (dstI != dstE && (g.getEdgeData(dstI) & removed)) {
-      ++dstI;
-    }
+  auto srcI = g.edge_begin(src, galois::MethodFlag::UNPROTECTED),
+       srcE = g.edge_end(src, galois::MethodFlag::UNPROTECTED),
+       dstI = g.edge_begin(dst, galois::MethodFlag::UNPROTECTED),
+       dstE = g.edge_end(dst, galois::MethodFlag::UNPROTECTED);
 
-    if (srcI == srcE || dstI == dstE) {
-      return numValidEqual >= j;
-    }
+  // reused by the calls of a thread
+  static thread_local std::vector<uint32_t> srcPos, dstPos;
+  size_t numEqual =
+      intersectAllEdges(g, srcI, srcE, dstI, dstE, srcPos, dstPos);
 
-    // check for intersection
-    auto sN = g.getEdgeDst(srcI), dN = g.getEdgeDst(dstI);
-    if (sN < dN) {
-      ++srcI;
-    } else if (dN < sN) {
-      ++dstI;
-    } else {
+  size_t numValidEqual = 0;
+  for (size_t k = 0; k < numEqual && numValidEqual < j; ++k) {
+    if (!(g.getEdgeData(srcI + srcPos[k]) & removed) &&
+        !(g.getEdgeData(dstI + dstPos[k]) & removed)) {
       numValidEqual += 1;
-      if (numValidEqual >= j) {
-        return true;
-      }
-      ++srcI;
-      ++dstI;
     }
   }
   return numValidEqual >= j;
@@ -473,29 +480,14 @@ getValidCommonNeighbors(G& g, typename G::GraphNode src,
        dstI = g.edge_begin(dst, flag), dstE = g.edge_end(dst, flag);
   std::deque<GNode, PerIterAlloc<GNode>> commonNeighbors(a);
 
-  while (true) {
-    // find the first valid edge
-    while (srcI != srcE && (g.getEdgeData(srcI) & removed)) {
-      ++srcI;
-    }
-    while (dstI != dstE && (g.getEdgeData(dstI) & removed)) {
-      ++dstI;
-    }
-
-    if (srcI == srcE || dstI == dstE) {
-      break;
-    }
+  std::vector<uint32_t, PerIterAlloc<uint32_t>> srcPos(a), dstPos(a);
+  size_t numEqual =
+      intersectAllEdges(g, srcI, srcE, dstI, dstE, srcPos, dstPos);
 
-    // check for intersection
-    auto sN = g.getEdgeDst(srcI), dN = g.getEdgeDst(dstI);
-    if (sN < dN) {
-      ++srcI;
-    } else if (dN < sN) {
-      ++dstI;
-    } else {
-      commonNeighbors.push_back(sN);
-      ++srcI;
-      ++dstI;
+  for (size_t k = 0; k < numEqual; ++k) {
+    if (!(g.getEdgeData(srcI + srcPos[k]) & removed) &&
+        !(g.getEdgeData(dstI + dstPos[k]) & removed)) {
+      commonNeighbors.push_back(g.getEdgeDst(srcI + srcPos[k]));
     }
   }
   return commonNeighbors;
@@ -57,6 +57,19 @@ struct BFS_SSSP {
     }
   };
 
+  //! Indexer whose bucket width is adjusted at runtime; indices are
+  //! distances rounded down to the current width
+  struct AdaptiveUpdateRequestIndexer {
+    galois::worklists::AdaptiveDelta* delta;
+
+    template <typename R>
+    unsigned int operator()(const R& req) const {
+      return delta->index(static_cast<unsigned int>(req.dist));
+    }
+
+    void notifyScan() const { delta->noteScan(); }
+  };
+
   struct SrcEdgeTile {
     GNode src;
     Dist dist;
@@ -40,6 +40,12 @@ static cll::opt<Algo> algo("algo", cll::desc("Choose an algorithm:"),
                                        clEnumVal(Sync, "Sync"), clEnumValEnd),
                            cll::init(Async));
 
+static cll::opt<bool> compressed(
+    "compressed",
+    cll::desc("Use a graph with delta + varint compressed adjacency lists "
+              "(Async only; default value false)"),
+    cll::init(false));
+
 struct LNode {
   PRTy value;
   std::atomic<PRTy> residual;
@@ -57,9 +63,11 @@ struct LNode {
 
 typedef galois::graphs::LC_CSR_Graph<LNode, void>::with_numa_alloc<
     true>::type ::with_no_lockable<true>::type Graph;
+typedef galois::graphs::LC_CCSR_Graph<LNode, void> CGraph;
 typedef typename Graph::GraphNode GNode;
 
-void asyncPageRank(Graph& graph) {
+template <typename G>
+void asyncPageRank(G& graph) {
   typedef galois::worklists::PerSocketChunkFIFO<CHUNK_SIZE> WL;
   galois::for_each(
       galois::iterate(graph),
@@ -71,8 +79,8 @@ void asyncPageRank(Graph& graph) {
         if (sdata.residual > tolerance) {
           PRTy oldResidual = sdata.residual.exchange(0.0);
           sdata.value += oldResidual;
-          int src_nout = std::distance(graph.edge_begin(src, flag),
-                                       graph.edge_end(src, flag));
+          int src_nout =
+              graph.edge_end(src, flag) - graph.edge_begin(src, flag);
           if (src_nout > 0) {
             PRTy delta = oldResidual * ALPHA / src_nout;
             // for each out-going neighbors
@@ -181,20 +189,44 @@ void syncPageRank(Graph& graph) {
   }
 }
 
-int main(int argc, char** argv) {
-  galois::SharedMemSys G;
-  LonestarStart(argc, argv, name, desc, url);
+void runAlgo(Graph& graph) {
+  switch (algo) {
+  case Async:
+    std::cout << "Running Edge Async push version,";
+    asyncPageRank(graph);
+    break;
+
+  case Sync:
+    std::cout << "Running Edge Sync push version,";
+    syncPageRank(graph);
+    break;
+
+  default:
+    std::abort();
+  }
+}
+
+//! Sync splits adjacency lists into tiles, which needs random access
+void runAlgo(CGraph& graph) {
+  if (algo != Async)
+    GALOIS_DIE("only Async supports -compressed");
+
+  std::cout << "Running Edge Async push version on compressed graph,";
+  asyncPageRank(graph);
+}
 
+template <typename G>
+void run() {
   galois::StatTimer T("OverheadTime");
   T.start();
 
-  Graph graph;
+  G graph;
   galois::graphs::readGraph(graph, filename);
   std::cout << "Read " << graph.size() << " nodes, " << graph.sizeEdges()
             << " edges\n";
 
   galois::preAlloc(5 * numThreads +
-                   (5 * graph.size() * sizeof(typename Graph::node_data_type)) /
+                   (5 * graph.size() * sizeof(typename G::node_data_type)) /
                        galois::runtime::pagePoolSize());
   galois::reportPageAlloc("MeminfoPre");
 
@@ -208,20 +240,7 @@ int main(int argc, char** argv) {
   galois::StatTimer Tmain;
   Tmain.start();
 
-  switch (algo) {
-  case Async:
-    std::cout << "Running Edge Async push version,";
-    asyncPageRank(graph);
-    break;
-
-  case Sync:
-    std::cout << "Running Edge Sync push version,";
-    syncPageRank(graph);
-    break;
-
-  default:
-    std::abort();
-  }
+  runAlgo(graph);
 
   Tmain.stop();
 
@@ -236,6 +255,17 @@ int main(int argc, char** argv) {
 #endif
 
   T.stop();
+}
+
+int main(int argc, char** argv) {
+  galois::SharedMemSys G;
+  LonestarStart(argc, argv, name, desc, url);
+
+  if (compressed) {
+    run<CGraph>();
+  } else {
+    run<Graph>();
+  }
 
   return 0;
 }
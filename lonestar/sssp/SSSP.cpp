@@ -31,6 +31,7 @@
 #include "Lonestar/BFS_SSSP.h"
 
 #include <iostream>
+#include <memory>
 
 namespace cll = llvm::cl;
 
@@ -55,6 +56,11 @@ static cll::opt<unsigned int>
     stepShift("delta",
               cll::desc("Shift value for the deltastep (default value 13)"),
               cll::init(13));
+static cll::opt<bool> adaptiveDelta(
+    "adaptiveDelta",
+    cll::desc("Adjust the delta at runtime from the amount of stale work; "
+              "-delta gives the initial shift (default value false)"),
+    cll::init(false));
 
 enum Algo {
   deltaTile = 0,
@@ -64,12 +70,14 @@ enum Algo {
   dijkstraTile,
   dijkstra,
   topo,
-  topoTile
+  topoTile,
+  multiQueueTile,
+  multiQueue
 };
 
-const char* const ALGO_NAMES[] = {"deltaTile", "deltaStep",    "serDeltaTile",
-                                  "serDelta",  "dijkstraTile", "dijkstra",
-                                  "topo",      "topoTile"};
+const char* const ALGO_NAMES[] = {
+    "deltaTile", "deltaStep", "serDeltaTile", "serDelta",      "dijkstraTile",
+    "dijkstra",  "topo",      "topoTile",     "multiQueueTile", "multiQueue"};
 
 static cll::opt<Algo>
     algo("algo", cll::desc("Choose an algorithm:"),
@@ -79,15 +87,24 @@ static cll::opt<Algo>
                      clEnumVal(serDelta, "serDelta"),
                      clEnumVal(dijkstraTile, "dijkstraTile"),
                      clEnumVal(dijkstra, "dijkstra"), clEnumVal(topo, "topo"),
-                     clEnumVal(topoTile, "topoTile"), clEnumValEnd),
+                     clEnumVal(topoTile, "topoTile"),
+                     clEnumVal(multiQueueTile, "multiQueueTile"),
+                     clEnumVal(multiQueue, "multiQueue"), clEnumValEnd),
          cll::init(deltaTile));
 
+static cll::opt<bool> compressed(
+    "compressed",
+    cll::desc("Use a graph with delta + varint compressed adjacency lists "
+              "(untiled algorithms only; default value false)"),
+    cll::init(false));
+
 // typedef galois::graphs::LC_InlineEdge_Graph<std::atomic<unsigned int>,
 // uint32_t>::with_no_lockable<true>::type::with_numa_alloc<true>::type Graph;
 //! [withnumaalloc]
 using Graph = galois::graphs::LC_CSR_Graph<std::atomic<uint32_t>, uint32_t>::
     with_no_lockable<true>::type ::with_numa_alloc<true>::type;
 //! [withnumaalloc]
+using CGraph = galois::graphs::LC_CCSR_Graph<std::atomic<uint32_t>, uint32_t>;
 typedef Graph::GraphNode GNode;
 
 constexpr static const bool TRACK_WORK          = false;
@@ -98,15 +115,20 @@ using SSSP                 = BFS_SSSP<Graph, uint32_t, true, EDGE_TILE_SIZE>;
 using Dist                 = SSSP::Dist;
 using UpdateRequest        = SSSP::UpdateRequest;
 using UpdateRequestIndexer = SSSP::UpdateRequestIndexer;
+using AdaptiveUpdateRequestIndexer = SSSP::AdaptiveUpdateRequestIndexer;
 using SrcEdgeTile          = SSSP::SrcEdgeTile;
 using SrcEdgeTileMaker     = SSSP::SrcEdgeTileMaker;
 using SrcEdgeTilePushWrap  = SSSP::SrcEdgeTilePushWrap;
 using ReqPushWrap          = SSSP::ReqPushWrap;
 using OutEdgeRangeFn       = SSSP::OutEdgeRangeFn;
 using TileRangeFn          = SSSP::TileRangeFn;
+using CSSSP                = BFS_SSSP<CGraph, uint32_t, true, EDGE_TILE_SIZE>;
 
-template <typename T, typename P, typename R>
-void deltaStepAlgo(Graph& graph, GNode source, const P& pushWrap,
+//! UseMultiQueue schedules by exact distance with a relaxed priority queue
+//! instead of delta-stepping with OBIM
+template <typename T, bool UseMultiQueue = false, typename G, typename P,
+          typename R>
+void deltaStepAlgo(G& graph, GNode source, const P& pushWrap,
                    const R& edgeRange) {
 
   //! [reducible for self-defined stats]
@@ -118,57 +140,93 @@ void deltaStepAlgo(Graph& graph, GNode source, const P& pushWrap,
 
   using PSchunk = gwl::PerSocketChunkFIFO<CHUNK_SIZE>;
   using OBIM    = gwl::OrderedByIntegerMetric<UpdateRequestIndexer, PSchunk>;
+  using MQ      = gwl::MultiQueue<std::less<T>, T>;
+  using AdaptiveOBIM =
+      gwl::OrderedByIntegerMetric<AdaptiveUpdateRequestIndexer, PSchunk>;
+
+  std::unique_ptr<gwl::AdaptiveDelta> adaptive;
+  if (!UseMultiQueue && adaptiveDelta) {
+    adaptive.reset(new gwl::AdaptiveDelta(stepShift));
+  }
+  gwl::AdaptiveDelta* delta = adaptive.get();
 
   graph.getData(source) = 0;
 
   galois::InsertBag<T> initBag;
   pushWrap(initBag, source, 0, "parallel");
 
-  galois::for_each(galois::iterate(initBag),
-                   [&](const T& item, auto& ctx) {
-                     constexpr galois::MethodFlag flag =
-                         galois::MethodFlag::UNPROTECTED;
-                     const auto& sdata = graph.getData(item.src, flag);
+  auto relax = [&](const T& item, auto& ctx) {
+    constexpr galois::MethodFlag flag = galois::MethodFlag::UNPROTECTED;
+    const auto& sdata = graph.getData(item.src, flag);
 
-                     if (sdata < item.dist) {
-                       if (TRACK_WORK)
-                         WLEmptyWork += 1;
-                       return;
-                     }
+    if (sdata < item.dist) {
+      if (TRACK_WORK)
+        WLEmptyWork += 1;
+      if (delta)
+        delta->noteWork(1, 1);
+      return;
+    }
 
-                     for (auto ii : edgeRange(item)) {
+    // updates of nodes, and those that lowered an already reached distance
+    size_t updates = 0, redone = 0;
 
-                       GNode dst          = graph.getEdgeDst(ii);
-                       auto& ddist        = graph.getData(dst, flag);
-                       Dist ew            = graph.getEdgeData(ii, flag);
-                       const Dist newDist = sdata + ew;
+    for (auto ii : edgeRange(item)) {
 
-                       while (true) {
-                         Dist oldDist = ddist;
+      GNode dst          = graph.getEdgeDst(ii);
+      auto& ddist        = graph.getData(dst, flag);
+      Dist ew            = graph.getEdgeData(ii, flag);
+      const Dist newDist = sdata + ew;
 
-                         if (oldDist <= newDist) {
-                           break;
-                         }
+      while (true) {
+        Dist oldDist = ddist;
 
-                         if (ddist.compare_exchange_weak(
-                                 oldDist, newDist, std::memory_order_relaxed)) {
+        if (oldDist <= newDist) {
+          break;
+        }
 
-                           if (TRACK_WORK) {
-                             //! [per-thread contribution of self-defined stats]
-                             if (oldDist != SSSP::DIST_INFINITY) {
-                               BadWork += 1;
-                             }
-                             //! [per-thread contribution of self-defined stats]
-                           }
+        if (ddist.compare_exchange_weak(oldDist, newDist,
+                                        std::memory_order_relaxed)) {
 
-                           pushWrap(ctx, dst, newDist);
-                           break;
-                         }
-                       }
-                     }
-                   },
-                   galois::wl<OBIM>(UpdateRequestIndexer{stepShift}),
-                   galois::no_conflicts(), galois::loopname("SSSP"));
+          if (TRACK_WORK) {
+            //! [per-thread contribution of self-defined stats]
+            if (oldDist != SSSP::DIST_INFINITY) {
+              BadWork += 1;
+            }
+            //! [per-thread contribution of self-defined stats]
+          }
+
+          ++updates;
+          redone += oldDist != SSSP::DIST_INFINITY;
+
+          pushWrap(ctx, dst, newDist);
+          break;
+        }
+      }
+    }
+
+    if (delta) {
+      // lowering an already reached distance is wasted work
+      delta->noteWork(1 + updates, redone);
+    }
+  };
+
+  if (UseMultiQueue) {
+    galois::for_each(galois::iterate(initBag), relax, galois::wl<MQ>(),
+                     galois::no_conflicts(), galois::loopname("SSSP"));
+  } else if (delta) {
+    galois::for_each(
+        galois::iterate(initBag), relax,
+        galois::wl<AdaptiveOBIM>(AdaptiveUpdateRequestIndexer{delta}),
+        galois::no_conflicts(), galois::loopname("SSSP"));
+    galois::runtime::reportStat_Single("SSSP", "DeltaChanges",
+                                       delta->changes());
+    galois::runtime::reportStat_Single("SSSP", "FinalDeltaShift",
+                                       delta->shift());
+  } else {
+    galois::for_each(galois::iterate(initBag), relax,
+                     galois::wl<OBIM>(UpdateRequestIndexer{stepShift}),
+                     galois::no_conflicts(), galois::loopname("SSSP"));
+  }
 
   if (TRACK_WORK) {
     //! [report self-defined stats]
@@ -179,8 +237,8 @@ void deltaStepAlgo(Graph& graph, GNode source, const P& pushWrap,
   }
 }
 
-template <typename T, typename P, typename R>
-void serDeltaAlgo(Graph& graph, const GNode& source, const P& pushWrap,
+template <typename T, typename G, typename P, typename R>
+void serDeltaAlgo(G& graph, const GNode& source, const P& pushWrap,
                   const R& edgeRange) {
 
   SerialBucketWL<T, UpdateRequestIndexer> wl(UpdateRequestIndexer{stepShift});
@@ -227,8 +285,8 @@ void serDeltaAlgo(Graph& graph, const GNode& source, const P& pushWrap,
   galois::runtime::reportStat_Single("SSSP-Serial-Delta", "Iterations", iter);
 }
 
-template <typename T, typename P, typename R>
-void dijkstraAlgo(Graph& graph, const GNode& source, const P& pushWrap,
+template <typename T, typename G, typename P, typename R>
+void dijkstraAlgo(G& graph, const GNode& source, const P& pushWrap,
                   const R& edgeRange) {
 
   using WL = galois::MinHeap<T>;
@@ -267,7 +325,8 @@ void dijkstraAlgo(Graph& graph, const GNode& source, const P& pushWrap,
   galois::runtime::reportStat_Single("SSSP-Dijkstra", "Iterations", iter);
 }
 
-void topoAlgo(Graph& graph, const GNode& source) {
+template <typename G>
+void topoAlgo(G& graph, const GNode& source) {
 
   galois::LargeArray<Dist> oldDist;
   oldDist.allocateInterleaved(graph.size());
@@ -356,11 +415,82 @@ void topoTileAlgo(Graph& graph, const GNode& source) {
   galois::runtime::reportStat_Single("SSSP-topo", "rounds", rounds);
 }
 
-int main(int argc, char** argv) {
-  galois::SharedMemSys G;
-  LonestarStart(argc, argv, name, desc, url);
+void runAlgo(Graph& graph, const GNode& source) {
+  switch (algo) {
+  case deltaTile:
+    deltaStepAlgo<SrcEdgeTile>(graph, source, SrcEdgeTilePushWrap{graph},
+                               TileRangeFn());
+    break;
+  case deltaStep:
+    deltaStepAlgo<UpdateRequest>(graph, source, ReqPushWrap(),
+                                 OutEdgeRangeFn{graph});
+    break;
+  case serDeltaTile:
+    serDeltaAlgo<SrcEdgeTile>(graph, source, SrcEdgeTilePushWrap{graph},
+                              TileRangeFn());
+    break;
+  case serDelta:
+    serDeltaAlgo<UpdateRequest>(graph, source, ReqPushWrap(),
+                                OutEdgeRangeFn{graph});
+    break;
+  case dijkstraTile:
+    dijkstraAlgo<SrcEdgeTile>(graph, source, SrcEdgeTilePushWrap{graph},
+                              TileRangeFn());
+    break;
+  case dijkstra:
+    dijkstraAlgo<UpdateRequest>(graph, source, ReqPushWrap(),
+                                OutEdgeRangeFn{graph});
+    break;
+  case topo:
+    topoAlgo(graph, source);
+    break;
+  case topoTile:
+    topoTileAlgo(graph, source);
+    break;
+  case multiQueueTile:
+    deltaStepAlgo<SrcEdgeTile, true>(graph, source, SrcEdgeTilePushWrap{graph},
+                                     TileRangeFn());
+    break;
+  case multiQueue:
+    deltaStepAlgo<UpdateRequest, true>(graph, source, ReqPushWrap(),
+                                       OutEdgeRangeFn{graph});
+    break;
+  default:
+    std::abort();
+  }
+}
+
+//! Edge tiles need random access, so only untiled algorithms are available
+void runAlgo(CGraph& graph, const GNode& source) {
+  switch (algo) {
+  case deltaStep:
+    deltaStepAlgo<CSSSP::UpdateRequest>(graph, source, CSSSP::ReqPushWrap(),
+                                        CSSSP::OutEdgeRangeFn{graph});
+    break;
+  case serDelta:
+    serDeltaAlgo<CSSSP::UpdateRequest>(graph, source, CSSSP::ReqPushWrap(),
+                                       CSSSP::OutEdgeRangeFn{graph});
+    break;
+  case dijkstra:
+    dijkstraAlgo<CSSSP::UpdateRequest>(graph, source, CSSSP::ReqPushWrap(),
+                                       CSSSP::OutEdgeRangeFn{graph});
+    break;
+  case multiQueue:
+    deltaStepAlgo<CSSSP::UpdateRequest, true>(graph, source,
+                                              CSSSP::ReqPushWrap(),
+                                              CSSSP::OutEdgeRangeFn{graph});
+    break;
+  case topo:
+    topoAlgo(graph, source);
+    break;
+  default:
+    GALOIS_DIE("algorithm ", ALGO_NAMES[algo], " does not support -compressed");
+  }
+}
 
-  Graph graph;
+template <typename G, typename S>
+void run() {
+  G graph;
   GNode source, report;
 
   std::cout << "Reading from file: " << filename << std::endl;
@@ -391,15 +521,18 @@ int main(int argc, char** argv) {
 
   if (algo == deltaStep || algo == deltaTile || algo == serDelta ||
       algo == serDeltaTile) {
-    std::cout << "INFO: Using delta-step of " << (1 << stepShift) << "\n";
-    std::cout
-        << "WARNING: Performance varies considerably due to delta parameter.\n";
-    std::cout
-        << "WARNING: Do not expect the default to be good for your graph.\n";
+    std::cout << "INFO: Using delta-step of " << (1 << stepShift)
+              << (adaptiveDelta ? " (initial, adaptive)" : "") << "\n";
+    if (!adaptiveDelta) {
+      std::cout << "WARNING: Performance varies considerably due to delta "
+                   "parameter.\n";
+      std::cout
+          << "WARNING: Do not expect the default to be good for your graph.\n";
+    }
   }
 
   galois::do_all(galois::iterate(graph),
-                 [&graph](GNode n) { graph.getData(n) = SSSP::DIST_INFINITY; });
+                 [&graph](GNode n) { graph.getData(n) = S::DIST_INFINITY; });
 
   graph.getData(source) = 0;
 
@@ -408,40 +541,7 @@ int main(int argc, char** argv) {
   galois::StatTimer Tmain;
   Tmain.start();
 
-  switch (algo) {
-  case deltaTile:
-    deltaStepAlgo<SrcEdgeTile>(graph, source, SrcEdgeTilePushWrap{graph},
-                               TileRangeFn());
-    break;
-  case deltaStep:
-    deltaStepAlgo<UpdateRequest>(graph, source, ReqPushWrap(),
-                                 OutEdgeRangeFn{graph});
-    break;
-  case serDeltaTile:
-    serDeltaAlgo<SrcEdgeTile>(graph, source, SrcEdgeTilePushWrap{graph},
-                              TileRangeFn());
-    break;
-  case serDelta:
-    serDeltaAlgo<UpdateRequest>(graph, source, ReqPushWrap(),
-                                OutEdgeRangeFn{graph});
-    break;
-  case dijkstraTile:
-    dijkstraAlgo<SrcEdgeTile>(graph, source, SrcEdgeTilePushWrap{graph},
-                              TileRangeFn());
-    break;
-  case dijkstra:
-    dijkstraAlgo<UpdateRequest>(graph, source, ReqPushWrap(),
-                                OutEdgeRangeFn{graph});
-    break;
-  case topo:
-    topoAlgo(graph, source);
-    break;
-  case topoTile:
-    topoTileAlgo(graph, source);
-    break;
-  default:
-    std::abort();
-  }
+  runAlgo(graph, source);
 
   Tmain.stop();
 
@@ -451,12 +551,27 @@ int main(int argc, char** argv) {
             << graph.getData(report) << "\n";
 
   if (!skipVerify) {
-    if (SSSP::verify(graph, source)) {
+    if (S::verify(graph, source)) {
       std::cout << "Verification successful.\n";
     } else {
       GALOIS_DIE("Verification failed");
     }
   }
+}
+
+int main(int argc, char** argv) {
+  galois::SharedMemSys G;
+  LonestarStart(argc, argv, name, desc, url);
+
+  if (adaptiveDelta && algo != deltaStep && algo != deltaTile) {
+    GALOIS_DIE("-adaptiveDelta only applies to deltaStep and deltaTile");
+  }
+
+  if (compressed) {
+    run<CGraph, CSSSP>();
+  } else {
+    run<Graph, SSSP>();
+  }
 
   return 0;
 }
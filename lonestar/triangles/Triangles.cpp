@@ -22,7 +22,9 @@
 #include "galois/Bag.h"
 #include "galois/Timer.h"
 #include "galois/graphs/LCGraph.h"
-#include "galois/ParallelSTL.h"
+#include "galois/graphs/Relabel.h"
+#include "galois/SetIntersection.h"
+#include "galois/substrate/PerThreadStorage.h"
 #include "llvm/Support/CommandLine.h"
 #include "Lonestar/BoilerPlate.h"
 
@@ -34,7 +36,7 @@
 #include <vector>
 #include <algorithm>
 #include <iostream>
-#include <fstream>
+#include <cstring>
 
 const char* name = "Triangles";
 const char* desc = "Counts the triangles in a graph";
@@ -55,6 +57,12 @@ static cll::opt<Algo> algo(
                            "Edge Iterator (default)"),
                 clEnumValEnd),
     cll::init(Algo::edgeiterator));
+static cll::opt<unsigned int>
+    hubDegree("hubDegree",
+              cll::desc("Node iterator intersects with a bitmap of the higher "
+                        "neighbors of nodes with at least this many of them "
+                        "(default 1024)"),
+              cll::init(1024));
 
 typedef galois::graphs::LC_CSR_Graph<uint32_t, void>::with_numa_alloc<
     true>::type ::with_no_lockable<true>::type Graph;
@@ -87,28 +95,42 @@ Iterator lowerBound(Iterator first, Iterator last, Compare comp) {
 }
 
 /**
- * std::set_intersection over edge_iterators.
+ * Size of the intersection of the destinations of two ranges of edges sorted
+ * by destination.
  */
 template <typename G>
 size_t countEqual(G& g, typename G::edge_iterator aa,
                   typename G::edge_iterator ea, typename G::edge_iterator bb,
                   typename G::edge_iterator eb) {
-  size_t retval = 0;
-  while (aa != ea && bb != eb) {
-    typename G::GraphNode a = g.getEdgeDst(aa);
-    typename G::GraphNode b = g.getEdgeDst(bb);
-    if (a < b) {
-      ++aa;
-    } else if (b < a) {
-      ++bb;
-    } else {
-      retval += 1;
-      ++aa;
-      ++bb;
+  return galois::intersectCount(g.getEdgeDstPtr(aa), std::distance(aa, ea),
+                                g.getEdgeDstPtr(bb), std::distance(bb, eb));
+}
+
+/**
+ * Per thread bitmap of the higher neighbors of the last hub node a thread
+ * looked at in the node iterator algorithm.
+ */
+struct HubBitmap {
+  galois::SortedSetBitmap bitmap;
+  GNode hub = ~0U;
+
+  //! makes the destinations of the edges [first, last) of n the bitmap
+  void assign(Graph& g, GNode n, Graph::edge_iterator first,
+              Graph::edge_iterator last) {
+    if (hub != n) {
+      bitmap.assign(g.getEdgeDstPtr(first), std::distance(first, last),
+                    g.size());
+      hub = n;
     }
   }
-  return retval;
-}
+
+  //! number of destinations of [first, last) in the bitmap
+  size_t countEqual(Graph& g, Graph::edge_iterator first,
+                    Graph::edge_iterator last) {
+    return bitmap.intersectCount(g.getEdgeDstPtr(first),
+                                 std::distance(first, last));
+  }
+};
 
 template <typename G>
 struct LessThan {
@@ -128,40 +150,6 @@ struct GreaterThanOrEqual {
   }
 };
 
-template <typename G>
-struct DegreeLess : public std::binary_function<typename G::GraphNode,
-                                                typename G::GraphNode, bool> {
-  typedef typename G::GraphNode N;
-  G* g;
-  DegreeLess(G& g) : g(&g) {}
-
-  bool operator()(const N& n1, const N& n2) const {
-    return std::distance(g->edge_begin(n1), g->edge_end(n1)) <
-           std::distance(g->edge_begin(n2), g->edge_end(n2));
-  }
-};
-
-template <typename G>
-struct GetDegree
-    : public std::unary_function<typename G::GraphNode, ptrdiff_t> {
-  typedef typename G::GraphNode N;
-  G* g;
-  GetDegree(G& g) : g(&g) {}
-
-  ptrdiff_t operator()(const N& n) const {
-    return std::distance(g->edge_begin(n), g->edge_end(n));
-  }
-};
-
-template <typename GraphNode, typename EdgeTy>
-struct IdLess {
-  bool
-  operator()(const galois::graphs::EdgeSortValue<GraphNode, EdgeTy>& e1,
-             const galois::graphs::EdgeSortValue<GraphNode, EdgeTy>& e2) const {
-    return e1.dst < e2.dst;
-  }
-};
-
 /**
  * Node Iterator algorithm for counting triangles.
  * <code>
@@ -177,6 +165,7 @@ struct IdLess {
 void nodeIteratingAlgo(Graph& graph) {
 
   galois::GAccumulator<size_t> numTriangles;
+  galois::substrate::PerThreadStorage<HubBitmap> hubs;
 
   //! [profile w/ vtune]
   galois::runtime::profileVtune(
@@ -195,20 +184,22 @@ void nodeIteratingAlgo(Graph& graph) {
               Graph::edge_iterator bb =
                   lowerBound(first, last, GreaterThanOrEqual<Graph>(graph, n));
 
-              for (; bb != last; ++bb) {
-                GNode B = graph.getEdgeDst(bb);
-                for (auto aa = first; aa != ea; ++aa) {
-                  GNode A = graph.getEdgeDst(aa);
-                  Graph::edge_iterator vv =
-                      graph.edge_begin(A, galois::MethodFlag::UNPROTECTED);
-                  Graph::edge_iterator ev =
-                      graph.edge_end(A, galois::MethodFlag::UNPROTECTED);
-                  Graph::edge_iterator it =
-                      lowerBound(vv, ev, LessThan<Graph>(graph, B));
-                  if (it != ev && graph.getEdgeDst(it) == B) {
-                    numTriangles += 1;
-                  }
-                }
+              // the triangles (A, n, B) with A < n < B of a lower neighbor A
+              // are the higher neighbors B of n that are neighbors of A
+              HubBitmap* hub = nullptr;
+              if (std::distance(bb, last) >= hubDegree &&
+                  std::distance(first, ea) > 1) {
+                hub = hubs.getLocal();
+                hub->assign(graph, n, bb, last);
+              }
+              for (auto aa = first; aa != ea; ++aa) {
+                GNode A = graph.getEdgeDst(aa);
+                Graph::edge_iterator vv =
+                    graph.edge_begin(A, galois::MethodFlag::UNPROTECTED);
+                Graph::edge_iterator ev =
+                    graph.edge_end(A, galois::MethodFlag::UNPROTECTED);
+                numTriangles += hub ? hub->countEqual(graph, vv, ev)
+                                    : countEqual(graph, bb, last, vv, ev);
               }
             },
             galois::chunk_size<32>(), galois::steal(),
@@ -293,52 +284,13 @@ void edgeIteratingAlgo(Graph& graph) {
   std::cout << "NumTriangles: " << numTriangles.reduce() << "\n";
 }
 
-void makeGraph(Graph& graph, const std::string& triangleFilename) {
-  typedef galois::graphs::FileGraph G;
-  typedef G::GraphNode N;
-
-  G initial, permuted;
-
-  initial.fromFileInterleaved<void>(inputFilename);
-
-  // Getting around lack of resize for deque
-  std::deque<N> nodes;
-  std::copy(initial.begin(), initial.end(), std::back_inserter(nodes));
-  // Sort by degree
-  galois::ParallelSTL::sort(nodes.begin(), nodes.end(), DegreeLess<G>(initial));
-
-  std::deque<N> p;
-  std::copy(nodes.begin(), nodes.end(), std::back_inserter(p));
-  // Transpose
-  size_t idx = 0;
-  for (N n : nodes) {
-    p[n] = idx++;
-  }
-
-  galois::graphs::permute<void>(initial, p, permuted);
-  galois::do_all(galois::iterate(permuted),
-                 [&](N x) { permuted.sortEdges<void>(x, IdLess<N, void>()); });
-
-  std::cout << "Writing new input file: " << triangleFilename << "\n";
-  permuted.toFile(triangleFilename);
-  galois::graphs::readGraph(graph, permuted);
-}
-
 void readGraph(Graph& graph) {
+  galois::graphs::readGraph(graph, inputFilename);
+
+  // .gr.triangles inputs are already sorted by degree
   if (inputFilename.find(".gr.triangles") !=
       inputFilename.size() - strlen(".gr.triangles")) {
-    // Not directly passed .gr.triangles file
-    std::string triangleFilename = inputFilename + ".triangles";
-    std::ifstream triangleFile(triangleFilename.c_str());
-    if (!triangleFile.good()) {
-      // triangles doesn't already exist, create it
-      makeGraph(graph, triangleFilename);
-    } else {
-      // triangles does exist, load it
-      galois::graphs::readGraph(graph, triangleFilename);
-    }
-  } else {
-    galois::graphs::readGraph(graph, inputFilename);
+    galois::graphs::relabel(graph, galois::graphs::RelabelPolicy::DEGREE);
   }
 
   size_t index = 0;
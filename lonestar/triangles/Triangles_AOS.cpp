@@ -22,7 +22,7 @@
 #include "galois/Bag.h"
 #include "galois/Timer.h"
 #include "galois/graphs/LCGraph.h"
-#include "galois/ParallelSTL.h"
+#include "galois/graphs/Relabel.h"
 #include "llvm/Support/CommandLine.h"
 #include "Lonestar/BoilerPlate.h"
 #include "galois/gstl.h"
@@ -35,7 +35,7 @@
 #include <vector>
 #include <algorithm>
 #include <iostream>
-#include <fstream>
+#include <cstring>
 
 const char* name = "Triangles";
 const char* desc = "Counts the triangles in a graph";
@@ -132,41 +132,6 @@ struct GreaterThanOrEqual {
   }
 };
 
-template <typename G>
-struct DegreeLess : public std::binary_function<typename G::GraphNode,
-                                                typename G::GraphNode, bool> {
-  typedef typename G::GraphNode N;
-  G* g;
-  DegreeLess(G& g) : g(&g) {}
-
-  bool operator()(const N& n1, const N& n2) const {
-    return std::distance(g->edge_begin(n1), g->edge_end(n1)) <
-           std::distance(g->edge_begin(n2), g->edge_end(n2));
-  }
-};
-
-template <typename G>
-struct GetDegree
-    : public std::unary_function<typename G::GraphNode, ptrdiff_t> {
-  typedef typename G::GraphNode N;
-  G* g;
-  GetDegree(G& g) : g(&g) {}
-
-  ptrdiff_t operator()(const N& n) const {
-    return std::distance(g->edge_begin(n), g->edge_end(n));
-  }
-};
-
-template <typename GraphNode, typename EdgeTy>
-struct IdLess {
-  bool
-  operator()(const galois::graphs::EdgeSortValue<GraphNode, EdgeTy>& e1,
-             const galois::graphs::EdgeSortValue<GraphNode, EdgeTy>& e2) const {
-    return e1.dst < e2.dst;
-  }
-};
-
-
 /**
  * Edge Iterator algorithm for counting triangles.
  * <code>
@@ -245,62 +210,17 @@ void nodeIteratingAlgoPre(Graph& graph) {
   std::cout << "NumTriangles: " << numTriangles.reduce() << "\n";
 }
 
-void makeGraph(Graph& graph, const std::string& triangleFilename) {
-  typedef galois::graphs::FileGraph G;
-  typedef G::GraphNode N;
-
-  G initial, permuted;
-
-  initial.fromFileInterleaved<void>(inputFilename);
-
-  // Getting around lack of resize for deque
-  std::deque<N> nodes;
-  std::copy(initial.begin(), initial.end(), std::back_inserter(nodes));
-  // Sort by degree
-  galois::ParallelSTL::sort(nodes.begin(), nodes.end(), DegreeLess<G>(initial));
-
-  std::deque<N> p;
-  std::copy(nodes.begin(), nodes.end(), std::back_inserter(p));
-  // Transpose
-  size_t idx = 0;
-  for (N n : nodes) {
-    p[n] = idx++;
-  }
-
-  galois::graphs::permute<void>(initial, p, permuted);
-  galois::do_all(galois::iterate(permuted),
-                 [&](N x) { permuted.sortEdges<void>(x, IdLess<N, void>()); });
-
-  std::cout << "Writing new input file: " << triangleFilename << "\n";
-  permuted.toFile(triangleFilename);
-  galois::gPrint("loading file after creating triangleFilename\n");
-  galois::graphs::readGraph(graph, permuted);
-  //graph.allocateAndLoadGraph(triangleFilename);
-}
-
 void readGraph(Graph& graph) {
+  galois::gPrint("Start loading", inputFilename, "\n");
+  galois::graphs::readGraph(graph, inputFilename);
+  galois::gPrint("Done loading", inputFilename, "\n");
+
+  // .gr.triangles inputs are already sorted by degree
   if (inputFilename.find(".gr.triangles") !=
       inputFilename.size() - strlen(".gr.triangles")) {
-    // Not directly passed .gr.triangles file
-    std::string triangleFilename = inputFilename + ".triangles";
-    std::ifstream triangleFile(triangleFilename.c_str());
-    if (!triangleFile.good()) {
-      // triangles doesn't already exist, create it
-      galois::gPrint("Start makeGraph\n");
-      makeGraph(graph, triangleFilename);
-      galois::gPrint("Done makeGraph\n");
-    } else {
-      // triangles does exist, load it
-      galois::gPrint("Start loading", triangleFilename, "\n");
-      galois::graphs::readGraph(graph, triangleFilename);
-      //graph.allocateAndLoadGraph(triangleFilename);
-      galois::gPrint("Done loading", triangleFilename, "\n");
-    }
-  } else {
-    galois::gPrint("Start loading", inputFilename, "\n");
-    galois::graphs::readGraph(graph, inputFilename);
-    //graph.allocateAndLoadGraph(inputFilename);
-    galois::gPrint("Done loading", inputFilename, "\n");
+    galois::gPrint("Start relabel\n");
+    galois::graphs::relabel(graph, galois::graphs::RelabelPolicy::DEGREE);
+    galois::gPrint("Done relabel\n");
   }
 
   size_t index = 0;
@@ -0,0 +1,113 @@
+/*
+ * This file belongs to the Galois project, a C++ library for exploiting parallelism.
+ * The code is being released under the terms of the 3-Clause BSD License (a
+ * copy is located in LICENSE.txt at the top-level directory).
+ *
+ * Copyright (C) 2018, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ */
+#include "galois/Galois.h"
+#include "galois/gIO.h"
+#include "galois/worklists/ChaseLev.h"
+
+#include <atomic>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+using galois::worklists::ChunkHeader;
+
+/**
+ * The owner pushes and pops in random bursts while thieves steal; every item
+ * must be taken exactly once. Bursts larger than the initial buffer make the
+ * deque grow while thieves are reading it.
+ */
+void testDeque(size_t numItems, unsigned numThieves) {
+  galois::worklists::ChaseLevDeque deque;
+  std::vector<ChunkHeader> items(numItems);
+  std::vector<std::atomic<unsigned>> taken(numItems);
+  for (auto& t : taken)
+    t = 0;
+  std::atomic<size_t> stolen(0);
+  std::atomic<bool> done(false);
+
+  auto take = [&](ChunkHeader* c) { ++taken[c - items.data()]; };
+
+  std::vector<std::thread> thieves;
+  for (unsigned i = 0; i < numThieves; ++i) {
+    thieves.emplace_back([&] {
+      while (!done) {
+        if (ChunkHeader* c = deque.steal()) {
+          take(c);
+          ++stolen;
+        } else {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+
+  std::mt19937 gen(numThieves);
+  size_t pushed = 0;
+  while (pushed < numItems) {
+    size_t burst = std::min<size_t>(gen() % 1000 + 1, numItems - pushed);
+    for (size_t i = 0; i < burst; ++i)
+      deque.push(&items[pushed++]);
+    for (size_t i = gen() % (burst + 1); i; --i)
+      if (ChunkHeader* c = deque.pop())
+        take(c);
+  }
+  while (!deque.empty())
+    if (ChunkHeader* c = deque.pop())
+      take(c);
+
+  done = true;
+  for (auto& t : thieves)
+    t.join();
+
+  GALOIS_ASSERT(deque.pop() == nullptr && deque.steal() == nullptr);
+  for (size_t i = 0; i < numItems; ++i)
+    GALOIS_ASSERT(taken[i] == 1, "item ", i, " taken ", taken[i].load(), " times");
+  std::cout << numThieves << " thieves stole " << stolen << " of " << numItems
+            << "\n";
+}
+
+//! every item pushed to the worklist in a for_each is processed once
+void testWorklist(unsigned numItems) {
+  std::vector<std::atomic<unsigned>> seen(numItems);
+  for (auto& s : seen)
+    s = 0;
+  galois::for_each(galois::iterate(0u, 1u),
+                   [&](unsigned n, auto& ctx) {
+                     ++seen[n];
+                     // a binary tree over the items
+                     for (unsigned c = 2 * n + 1; c <= 2 * n + 2; ++c)
+                       if (c < numItems)
+                         ctx.push(c);
+                   },
+                   galois::wl<galois::worklists::ChaseLevChunkLIFO<16>>(),
+                   galois::no_stats());
+  for (unsigned n = 0; n < numItems; ++n)
+    GALOIS_ASSERT(seen[n] == 1, "item ", n, " seen ", seen[n].load(), " times");
+}
+
+int main() {
+  galois::SharedMemSys G;
+  galois::setActiveThreads(galois::substrate::getThreadPool().getMaxThreads());
+
+  for (unsigned thieves : {0u, 1u, 3u})
+    testDeque(1 << 20, thieves);
+  testWorklist(1 << 20);
+  return 0;
+}
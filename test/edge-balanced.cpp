@@ -0,0 +1,144 @@
+/*
+ * This file belongs to the Galois project, a C++ library for exploiting parallelism.
+ * The code is being released under the terms of the 3-Clause BSD License (a
+ * copy is located in LICENSE.txt at the top-level directory).
+ *
+ * Copyright (C) 2018, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ */
+
+#include "galois/Galois.h"
+#include "galois/Timer.h"
+#include "galois/graphs/LC_CSR_Graph.h"
+#include "galois/graphs/LC_InOut_Graph.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+
+typedef galois::graphs::LC_CSR_Graph<std::atomic<uint64_t>, void>::
+    with_no_lockable<true>::type Graph;
+typedef Graph::GraphNode GNode;
+
+int numNodes = 0;
+
+//! power-law like degrees: node n has about numNodes / (n + 1) edges
+void constructGraph(Graph& graph) {
+  std::vector<uint64_t> degrees(numNodes);
+  uint64_t numEdges = 0;
+  for (int n = 0; n < numNodes; ++n) {
+    degrees[n] = numNodes / (n + 1) + rand() % 4;
+    numEdges += degrees[n];
+  }
+
+  graph.allocateFrom(numNodes, numEdges);
+  graph.constructNodes();
+  uint64_t e = 0;
+  for (int n = 0; n < numNodes; ++n) {
+    for (uint64_t i = 0; i < degrees[n]; ++i)
+      graph.constructEdge(e++, rand() % numNodes);
+    graph.fixEndEdge(n, e);
+  }
+}
+
+//! pull style operator: sums the ids of the neighbors of a node
+template <typename EdgeRangeTy>
+uint64_t sumNeighbors(Graph& graph, const EdgeRangeTy& edges) {
+  uint64_t sum = 0;
+  for (auto e : edges)
+    sum += graph.getEdgeDst(e);
+  return sum;
+}
+
+template <typename RangeMakerTy, typename... Args>
+bool runNodes(Graph& graph, const char* name, const RangeMakerTy& rangeMaker,
+              const std::vector<uint64_t>& expected, Args... args) {
+  galois::do_all(galois::iterate(graph),
+                 [&](GNode n) { graph.getData(n) = 0; });
+
+  galois::Timer t;
+  t.start();
+  galois::do_all(rangeMaker,
+                 [&](GNode n) {
+                   graph.getData(n) = sumNeighbors(graph, graph.edges(n));
+                 },
+                 args...);
+  t.stop();
+
+  bool eq = true;
+  for (int n = 0; n < numNodes; ++n)
+    eq &= (graph.getData(n) == expected[n]);
+  std::cout << name << ": " << t.get() << " Equal: " << eq << "\n";
+  return eq;
+}
+
+bool runSplit(Graph& graph, const std::vector<uint64_t>& expected) {
+  galois::do_all(galois::iterate(graph),
+                 [&](GNode n) { graph.getData(n) = 0; });
+
+  galois::Timer t;
+  t.start();
+  galois::do_all(galois::iterate_edge_balanced_split(graph),
+                 [&](const galois::graphs::NodeEdgeRange<Graph>& item) {
+                   // parts of a hub are summed by several threads
+                   graph.getData(item.node) += sumNeighbors(graph, item);
+                 });
+  t.stop();
+
+  bool eq = true;
+  for (int n = 0; n < numNodes; ++n)
+    eq &= (graph.getData(n) == expected[n]);
+  std::cout << "edge balanced split: " << t.get() << " Equal: " << eq << "\n";
+  return eq;
+}
+
+int main(int argc, char** argv) {
+  galois::SharedMemSys G;
+  if (argc > 1)
+    numNodes = atoi(argv[1]);
+  if (numNodes <= 0)
+    numNodes = 1024 * 1024;
+
+  Graph graph;
+  constructGraph(graph);
+
+  std::vector<uint64_t> expected(numNodes);
+  for (int n = 0; n < numNodes; ++n)
+    expected[n] = sumNeighbors(graph, graph.edges(n));
+
+  unsigned M = galois::substrate::getThreadPool().getMaxThreads();
+  bool eq    = true;
+
+  while (M) {
+    galois::setActiveThreads(M);
+    std::cout << "Using " << M << " threads\n";
+
+    eq &= runNodes(graph, "node balanced", galois::iterate(graph), expected);
+    eq &= runNodes(graph, "node balanced steal", galois::iterate(graph),
+                   expected, galois::steal());
+    eq &= runNodes(graph, "edge balanced",
+                   galois::iterate_edge_balanced(graph), expected);
+    eq &= runNodes(graph, "edge balanced steal",
+                   galois::iterate_edge_balanced(graph), expected,
+                   galois::steal());
+    eq &= runSplit(graph, expected);
+
+    M >>= 1;
+  }
+
+  // in-out graphs are balanced by in- and out-edges once they are asymmetric
+  galois::graphs::LC_InOut_Graph<Graph> inOutGraph;
+  galois::do_all(galois::iterate_edge_balanced(inOutGraph), [](GNode) {});
+
+  return eq ? 0 : 1;
+}
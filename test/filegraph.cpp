@@ -17,9 +17,16 @@
  * Documentation, or loss or inaccuracy of data of any kind.
  */
 
+#include "galois/Galois.h"
 #include "galois/graphs/FileGraph.h"
+#include "galois/graphs/LCGraph.h"
+#include "galois/graphs/OfflineGraph.h"
 #include "galois/gIO.h"
 
+#include <algorithm>
+#include <cstdlib>
+#include <unistd.h>
+
 typedef galois::graphs::FileGraph Graph;
 
 void checkGraph(Graph& g) {
@@ -77,12 +84,110 @@ void testPart(const std::string& filename, int numParts) {
   //! [Reading part of graph]
 }
 
+void testOffline(const std::string& filename) {
+  Graph g;
+  g.fromFile(filename);
+  galois::graphs::OfflineGraph stream(filename,
+                                      galois::graphs::OFFLINE_GRAPH_STREAM);
+  galois::graphs::OfflineGraph mapped(filename,
+                                      galois::graphs::OFFLINE_GRAPH_MMAP);
+  GALOIS_ASSERT(!stream.isMapped() && mapped.isMapped());
+  GALOIS_ASSERT(stream.size() == g.size() && mapped.size() == g.size());
+  GALOIS_ASSERT(mapped.sizeEdges() == g.sizeEdges());
+
+  // ranges past the end of the file or backwards are ignored
+  mapped.prefetchEdges(0, mapped.sizeEdges() + (1 << 20));
+  mapped.prefetchEdges(mapped.sizeEdges(), 0);
+  for (auto n : g) {
+    GALOIS_ASSERT(*stream.edge_end(n) == *mapped.edge_end(n));
+    auto ii = g.edge_begin(n);
+    for (auto e : mapped.edges(n)) {
+      GALOIS_ASSERT(mapped.getEdgeDst(e) == g.getEdgeDst(ii));
+      GALOIS_ASSERT(stream.getEdgeDst(e) == g.getEdgeDst(ii));
+      if (mapped.edgeSize() == sizeof(uint32_t)) {
+        GALOIS_ASSERT(mapped.getEdgeData<uint32_t>(e) ==
+                      g.getEdgeData<uint32_t>(ii));
+      }
+      ++ii;
+    }
+  }
+  GALOIS_ASSERT(mapped.num_bytes_read() > 0 && mapped.num_seeks() == 0);
+  mapped.reset_seek_counters();
+  GALOIS_ASSERT(mapped.num_bytes_read() == 0);
+}
+
+typedef std::vector<std::pair<uint64_t, uint64_t>> Adjacency;
+
+//! Sorted (destination, edge data) pairs of node n
+template <typename G, typename It>
+Adjacency sortedAdjacency(G& g, It ii, It ei, bool hasData) {
+  Adjacency adj;
+  for (; ii != ei; ++ii)
+    adj.emplace_back(g.getEdgeDst(ii),
+                     hasData ? g.template getEdgeData<uint32_t>(ii) : 0);
+  std::sort(adj.begin(), adj.end());
+  return adj;
+}
+
+void testCompressed(const std::string& filename) {
+  Graph g;
+  g.fromFile(filename);
+  bool hasData = g.edgeSize() == sizeof(uint32_t);
+
+  char tmpl[] = "/tmp/filegraph.vgr.XXXXXX";
+  int fd      = mkstemp(tmpl);
+  GALOIS_ASSERT(fd != -1);
+  close(fd);
+  std::string vgr(tmpl);
+  g.toCompressedFile(vgr);
+
+  Graph decoded;
+  decoded.fromFile(vgr);
+  checkGraph(decoded);
+  GALOIS_ASSERT(decoded.size() == g.size());
+  GALOIS_ASSERT(decoded.sizeEdges() == g.sizeEdges());
+
+  typedef galois::graphs::LC_CCSR_Graph<void, uint32_t> CGraph;
+  CGraph fromRaw;
+  CGraph fromCompressed;
+  galois::graphs::readGraph(fromRaw, filename);
+  galois::graphs::readGraph(fromCompressed, vgr);
+  GALOIS_ASSERT(fromRaw.sizeEdgeBytes() == fromCompressed.sizeEdgeBytes());
+
+  for (auto n : g) {
+    Adjacency expected =
+        sortedAdjacency(g, g.edge_begin(n), g.edge_end(n), hasData);
+    GALOIS_ASSERT(expected == sortedAdjacency(decoded, decoded.edge_begin(n),
+                                              decoded.edge_end(n), hasData));
+
+    for (CGraph* cg : {&fromRaw, &fromCompressed}) {
+      Adjacency adj;
+      for (auto e : cg->edges(n))
+        adj.emplace_back(cg->getEdgeDst(e), hasData ? cg->getEdgeData(e) : 0);
+      GALOIS_ASSERT(std::is_sorted(
+          adj.begin(), adj.end(),
+          [](const Adjacency::value_type& a, const Adjacency::value_type& b) {
+            return a.first < b.first;
+          }));
+      std::sort(adj.begin(), adj.end());
+      GALOIS_ASSERT(adj == expected);
+      GALOIS_ASSERT(cg->edge_end(n) - cg->edge_begin(n) ==
+                    std::distance(g.edge_begin(n), g.edge_end(n)));
+    }
+  }
+
+  unlink(vgr.c_str());
+}
+
 int main(int argc, char** argv) {
+  galois::SharedMemSys G;
   GALOIS_ASSERT(argc > 1);
   testBasic(Graph(), argv[1], [](Graph& g, std::string f) { g.fromFile(f); });
   testBasic(Graph(), argv[1],
             [](Graph& g, std::string f) { g.fromFileInterleaved<void>(f); });
   testPart(argv[1], 7);
+  testOffline(argv[1]);
+  testCompressed(argv[1]);
 
   return 0;
 }
@@ -17,7 +17,10 @@
  * Documentation, or loss or inaccuracy of data of any kind.
  */
 
+#include "galois/Galois.h"
 #include "galois/runtime/Mem.h"
+#include "galois/substrate/NumaMem.h"
+#include "galois/substrate/PageAlloc.h"
 #include "galois/gIO.h"
 
 using namespace galois::runtime;
@@ -30,6 +33,7 @@ struct element {
 };
 
 int main(int argc, char** argv) {
+  galois::SharedMemSys G;
   unsigned baseAllocSize = SystemHeap::AllocSize;
 
   FixedSizeAllocator<element> falloc;
@@ -66,5 +70,25 @@ int main(int argc, char** argv) {
     GALOIS_ASSERT(allocated);
   }
 
+  // large allocations are backed by some kind of pages and faulted in
+  auto before = getPageAllocStats();
+  {
+    LAptr large = largeMallocLocal(3 * allocSize());
+    GALOIS_ASSERT(large.get());
+    GALOIS_ASSERT(pageSizeOf(large.get()) <= allocSize());
+    static_cast<char*>(large.get())[3 * allocSize() - 1] = 1;
+  }
+  auto after    = getPageAllocStats();
+  size_t allocs = 0;
+  size_t bytes  = 0;
+  for (int k = 0; k < (int)PageKind::NUM_KINDS; ++k) {
+    allocs += after.allocations[k] - before.allocations[k];
+    bytes += after.bytes[k] - before.bytes[k];
+  }
+  GALOIS_ASSERT(allocs == 1);
+  GALOIS_ASSERT(bytes >= 3 * allocSize());
+  GALOIS_ASSERT(!after.socketBytes.empty() &&
+                after.socketBytes[0] >= 3 * allocSize());
+
   return 0;
 }
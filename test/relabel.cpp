@@ -0,0 +1,169 @@
+/*
+ * This file belongs to the Galois project, a C++ library for exploiting parallelism.
+ * The code is being released under the terms of the 3-Clause BSD License (a
+ * copy is located in LICENSE.txt at the top-level directory).
+ *
+ * Copyright (C) 2018, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ */
+
+#include "galois/Galois.h"
+#include "galois/Timer.h"
+#include "galois/gIO.h"
+#include "galois/graphs/LC_CSR_Graph.h"
+#include "galois/graphs/Relabel.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <utility>
+#include <vector>
+
+typedef galois::graphs::LC_CSR_Graph<uint32_t, uint64_t>::with_no_lockable<
+    true>::type Graph;
+typedef Graph::GraphNode GNode;
+typedef std::vector<std::pair<uint32_t, uint32_t>> EdgeList;
+
+int numNodes = 0;
+
+uint64_t edgeValue(uint32_t src, uint32_t dst) {
+  return (uint64_t(src) << 32) | dst;
+}
+
+/**
+ * Symmetric graph of a randomly numbered ring with a few hubs, so that no
+ * order is good to begin with.
+ */
+void makeEdges(EdgeList& edges) {
+  std::vector<uint32_t> ids(numNodes);
+  for (int n = 0; n < numNodes; ++n)
+    ids[n] = n;
+  std::random_shuffle(ids.begin(), ids.end());
+
+  for (int n = 0; n < numNodes; ++n) {
+    uint32_t a = ids[n], b = ids[(n + 1) % numNodes];
+    edges.emplace_back(a, b);
+    edges.emplace_back(b, a);
+    if (n % 64 == 0) {
+      uint32_t hub = ids[rand() % 16];
+      if (hub != a) {
+        edges.emplace_back(a, hub);
+        edges.emplace_back(hub, a);
+      }
+    }
+  }
+  std::sort(edges.begin(), edges.end());
+  edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+}
+
+//! node data and edge data are the ids of the original nodes
+void constructGraph(Graph& graph, const EdgeList& edges) {
+  graph.allocateFrom(numNodes, edges.size());
+  graph.constructNodes();
+  size_t e = 0;
+  for (int n = 0; n < numNodes; ++n) {
+    graph.getData(n) = n;
+    for (; e < edges.size() && edges[e].first == (uint32_t)n; ++e)
+      graph.constructEdge(e, edges[e].second,
+                          edgeValue(edges[e].first, edges[e].second));
+    graph.fixEndEdge(n, e);
+  }
+}
+
+void checkRelabeled(Graph& graph, const EdgeList& edges,
+                    const std::vector<GNode>& perm) {
+  std::vector<GNode> inverse(numNodes, numNodes);
+  for (int n = 0; n < numNodes; ++n) {
+    GALOIS_ASSERT(perm[n] < (GNode)numNodes);
+    GALOIS_ASSERT(inverse[perm[n]] == (GNode)numNodes, "not a permutation");
+    inverse[perm[n]] = n;
+  }
+
+  EdgeList relabeled;
+  for (GNode n : graph) {
+    GALOIS_ASSERT(graph.getData(n) == inverse[n]);
+    GNode prev = 0;
+    for (auto e : graph.edges(n)) {
+      GNode dst = graph.getEdgeDst(e);
+      GALOIS_ASSERT(e == graph.edge_begin(n) || prev < dst, "unsorted edges");
+      GALOIS_ASSERT(graph.getEdgeData(e) ==
+                    edgeValue(inverse[n], inverse[dst]));
+      relabeled.emplace_back(inverse[n], inverse[dst]);
+      prev = dst;
+    }
+  }
+  std::sort(relabeled.begin(), relabeled.end());
+  GALOIS_ASSERT(relabeled == edges);
+}
+
+//! sums the original ids of the neighbors of every node
+double timePull(Graph& graph) {
+  std::vector<uint64_t> sums(graph.size());
+  galois::Timer t;
+  t.start();
+  for (int r = 0; r < 10; ++r) {
+    galois::do_all(galois::iterate(graph), [&](GNode n) {
+      uint64_t sum = 0;
+      for (auto e : graph.edges(n, galois::MethodFlag::UNPROTECTED))
+        sum += graph.getData(graph.getEdgeDst(e));
+      sums[n] = sum;
+    });
+  }
+  t.stop();
+  return t.get();
+}
+
+int main(int argc, char** argv) {
+  galois::SharedMemSys G;
+  if (argc > 1)
+    numNodes = atoi(argv[1]);
+  if (numNodes <= 0)
+    numNodes = 1024 * 1024;
+
+  const std::pair<galois::graphs::RelabelPolicy, const char*> policies[] = {
+      {galois::graphs::RelabelPolicy::DEGREE, "degree"},
+      {galois::graphs::RelabelPolicy::BFS, "bfs"},
+      {galois::graphs::RelabelPolicy::RCM, "rcm"},
+      {galois::graphs::RelabelPolicy::GORDER, "gorder"},
+      {galois::graphs::RelabelPolicy::HUB_CLUSTER, "hub cluster"}};
+
+  EdgeList edges;
+  makeEdges(edges);
+  Graph original;
+  constructGraph(original, edges);
+  std::cout << "original: " << timePull(original) << "\n";
+
+  for (auto& policy : policies) {
+    Graph graph;
+    constructGraph(graph, edges);
+
+    auto perm = galois::graphs::relabel(graph, policy.first);
+    checkRelabeled(graph, edges, perm);
+
+    for (GNode n = 1; n < graph.size(); ++n) {
+      size_t prev =
+          std::distance(graph.edge_begin(n - 1), graph.edge_end(n - 1));
+      size_t cur   = std::distance(graph.edge_begin(n), graph.edge_end(n));
+      bool prevHub = prev * graph.size() > graph.sizeEdges();
+      bool curHub  = cur * graph.size() > graph.sizeEdges();
+      if (policy.first == galois::graphs::RelabelPolicy::DEGREE)
+        GALOIS_ASSERT(prev <= cur);
+      if (policy.first == galois::graphs::RelabelPolicy::HUB_CLUSTER)
+        GALOIS_ASSERT(prevHub || !curHub);
+    }
+
+    std::cout << policy.second << ": " << timePull(graph) << "\n";
+  }
+
+  return 0;
+}
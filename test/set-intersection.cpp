@@ -0,0 +1,154 @@
+/*
+ * This file belongs to the Galois project, a C++ library for exploiting parallelism.
+ * The code is being released under the terms of the 3-Clause BSD License (a
+ * copy is located in LICENSE.txt at the top-level directory).
+ *
+ * Copyright (C) 2018, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ */
+
+#include "galois/Galois.h"
+#include "galois/SetIntersection.h"
+#include "galois/Timer.h"
+#include "galois/gIO.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <vector>
+
+std::mt19937 gen(0);
+
+//! n distinct sorted values below universe
+template <typename T>
+std::vector<T> randomSet(size_t n, uint64_t universe) {
+  std::uniform_int_distribution<uint64_t> dist(0, universe - 1);
+  std::vector<T> s;
+  while (s.size() < n) {
+    for (size_t i = s.size(); i < n; ++i)
+      s.push_back(dist(gen));
+    std::sort(s.begin(), s.end());
+    s.erase(std::unique(s.begin(), s.end()), s.end());
+  }
+  return s;
+}
+
+template <typename T>
+void check(const std::vector<T>& a, const std::vector<T>& b) {
+  std::vector<T> expected;
+  std::set_intersection(a.begin(), a.end(), b.begin(), b.end(),
+                        std::back_inserter(expected));
+
+  size_t n = galois::intersectCount(a.data(), a.size(), b.data(), b.size());
+  GALOIS_ASSERT(n == expected.size(), n, " ", expected.size());
+
+  std::vector<T> out(std::min(a.size(), b.size()));
+  n = galois::intersect(a.data(), a.size(), b.data(), b.size(), out.data());
+  out.resize(n);
+  GALOIS_ASSERT(out == expected);
+}
+
+void checkPositions(const std::vector<uint32_t>& setA,
+                    const std::vector<uint32_t>& setB) {
+  size_t m = std::min(setA.size(), setB.size());
+  std::vector<uint32_t> posA(m), posB(m);
+  size_t n = galois::intersectPositions(setA.data(), setA.size(),
+                                        setB.data(), setB.size(), posA.data(),
+                                        posB.data());
+  GALOIS_ASSERT(n == galois::intersectCount(setA.data(), setA.size(),
+                                            setB.data(), setB.size()));
+  for (size_t k = 0; k < n; ++k) {
+    GALOIS_ASSERT(setA[posA[k]] == setB[posB[k]]);
+    GALOIS_ASSERT(k == 0 || posA[k - 1] < posA[k]);
+  }
+}
+
+void checkAll() {
+  // sizes around the SIMD block widths and skewed sizes for galloping
+  const size_t sizes[] = {0, 1, 3, 4, 7, 8, 15, 16, 17, 33, 100, 1000, 5000};
+  for (size_t na : sizes) {
+    for (size_t nb : sizes) {
+      for (uint64_t universe : {2 * (na + nb) + 1, 10 * (na + nb) + 1}) {
+        auto a32 = randomSet<uint32_t>(na, universe);
+        auto b32 = randomSet<uint32_t>(nb, universe);
+        check(a32, b32);
+        checkPositions(a32, b32);
+        check(a32, a32);
+
+        // large values check that comparisons are unsigned
+        auto a64 = randomSet<uint64_t>(na, universe);
+        auto b64 = randomSet<uint64_t>(nb, universe);
+        for (auto& x : a64)
+          x += (uint64_t(1) << 63);
+        for (auto& x : b64)
+          x += (uint64_t(1) << 63);
+        check(a64, b64);
+      }
+    }
+  }
+}
+
+void checkBitmap() {
+  const size_t universe = 100000;
+  galois::SortedSetBitmap bitmap;
+  for (size_t n : {0, 10, 1000, 50000}) {
+    auto hub = randomSet<uint32_t>(n, universe);
+    bitmap.assign(hub.data(), hub.size(), universe);
+    for (size_t m : {0, 1, 100, 10000}) {
+      auto other = randomSet<uint32_t>(m, universe);
+      GALOIS_ASSERT(bitmap.intersectCount(other.data(), other.size()) ==
+                    galois::intersectCount(hub.data(), hub.size(),
+                                           other.data(), other.size()));
+    }
+  }
+  bitmap.clear();
+  auto other = randomSet<uint32_t>(100, universe);
+  for (uint32_t x : other)
+    GALOIS_ASSERT(!bitmap.test(x));
+}
+
+//! intersects pairs of sets of similar sizes like in triangle counting
+void timeKernel(const char* name) {
+  auto sets = std::vector<std::vector<uint32_t>>();
+  for (int i = 0; i < 64; ++i)
+    sets.push_back(randomSet<uint32_t>(20000, 200000));
+
+  galois::Timer t;
+  t.start();
+  size_t n = 0;
+  for (int r = 0; r < 10; ++r)
+    for (size_t i = 0; i + 1 < sets.size(); ++i)
+      n += galois::intersectCount(sets[i].data(), sets[i].size(),
+                                  sets[i + 1].data(), sets[i + 1].size());
+  t.stop();
+  std::cout << name << ": " << t.get() << " ms (" << n << ")\n";
+}
+
+int main() {
+  galois::SharedMemSys G;
+
+  const char* names[] = {"scalar", "sse4.2", "avx2", "avx512"};
+  auto supported      = galois::getSupportedSetIntersectionISA();
+  for (int i = 0; i <= (int)supported; ++i) {
+    galois::setSetIntersectionISA((galois::SetIntersectionISA)i);
+    GALOIS_ASSERT(galois::getSetIntersectionISA() ==
+                  (galois::SetIntersectionISA)i);
+    checkAll();
+    timeKernel(names[i]);
+  }
+
+  checkBitmap();
+  return 0;
+}
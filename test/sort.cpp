@@ -23,7 +23,11 @@
 
 #include <iostream>
 #include <cstdlib>
+#include <iterator>
 #include <numeric>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 int RandomNumber() { return (rand() % 1000000); }
 bool IsOdd(int i) { return ((i % 2) == 1); }
@@ -44,43 +48,220 @@ int do_sort() {
     galois::setActiveThreads(M); // galois::runtime::LL::getMaxThreads());
     std::cout << "Using " << M << " threads\n";
 
-    std::vector<unsigned> V(vectorSize);
-    std::generate(V.begin(), V.end(), RandomNumber);
-    std::vector<unsigned> C = V;
+    for (int size : {vectorSize, 1025, 100003}) {
+      std::vector<unsigned> V(size);
+      std::generate(V.begin(), V.end(), RandomNumber);
+      std::vector<unsigned> C = V;
+
+      std::vector<unsigned> Q = V;
+
+      // dispatches to radix_sort for integers
+      galois::Timer t;
+      t.start();
+      galois::ParallelSTL::sort(V.begin(), V.end());
+      t.stop();
+
+      galois::Timer t2;
+      t2.start();
+      std::sort(C.begin(), C.end());
+      t2.stop();
+
+      galois::Timer t3;
+      t3.start();
+      galois::ParallelSTL::sort(Q.begin(), Q.end(), std::less<unsigned>());
+      t3.stop();
+
+      bool eq = std::equal(C.begin(), C.end(), V.begin()) &&
+                std::equal(C.begin(), C.end(), Q.begin());
+
+      std::cout << "Size: " << size << " Galois: " << t.get()
+                << " STL: " << t2.get() << " Galois comparison: " << t3.get()
+                << " Equal: " << eq << "\n";
+
+      if (!eq) {
+        std::vector<unsigned> R = V;
+        std::sort(R.begin(), R.end());
+        if (!std::equal(C.begin(), C.end(), R.begin()))
+          std::cout << "Cannot be made equal, sort mutated array\n";
+        for (size_t x = 0; x < V.size(); ++x) {
+          std::cout << x << "\t" << V[x] << "\t" << C[x];
+          if (V[x] != C[x])
+            std::cout << "\tDiff";
+          if (V[x] < C[x])
+            std::cout << "\tLT";
+          if (V[x] > C[x])
+            std::cout << "\tGT";
+          std::cout << "\n";
+        }
+        return 1;
+      }
+    }
 
-    galois::Timer t;
-    t.start();
-    galois::ParallelSTL::sort(V.begin(), V.end());
-    t.stop();
+    M >>= 1;
+  }
 
-    galois::Timer t2;
-    t2.start();
-    std::sort(C.begin(), C.end());
-    t2.stop();
+  return 0;
+}
 
-    bool eq = std::equal(C.begin(), C.end(), V.begin());
+/**
+ * Keys that are the same within the block of each active thread but differ
+ * between blocks, so that no single thread sees all the varying bits.
+ */
+template <typename T>
+std::vector<T> blockKeys(size_t size) {
+  unsigned numT = galois::getActiveThreads();
+  std::vector<T> V(size);
+  for (unsigned t = 0; t < numT; ++t) {
+    auto r = galois::block_range(size_t{0}, size, t, numT);
+    std::fill(V.begin() + r.first, V.begin() + r.second, T(t % 2 ? 5 : 7));
+  }
+  // with one thread, split the only block instead
+  if (numT == 1)
+    std::fill(V.begin() + size / 2, V.end(), T(5));
+  return V;
+}
 
-    std::cout << "Galois: " << t.get() << " STL: " << t2.get()
-              << " Equal: " << eq << "\n";
-
-    if (!eq) {
-      std::vector<unsigned> R = V;
-      std::sort(R.begin(), R.end());
-      if (!std::equal(C.begin(), C.end(), R.begin()))
-        std::cout << "Cannot be made equal, sort mutated array\n";
-      for (size_t x = 0; x < V.size(); ++x) {
-        std::cout << x << "\t" << V[x] << "\t" << C[x];
-        if (V[x] != C[x])
-          std::cout << "\tDiff";
-        if (V[x] < C[x])
-          std::cout << "\tLT";
-        if (V[x] > C[x])
-          std::cout << "\tGT";
-        std::cout << "\n";
+//! radix_sort of keys with all bits in use, including negative ones
+template <typename T>
+int do_radix_sort(const char* name) {
+  unsigned M = galois::substrate::getThreadPool().getMaxThreads();
+  std::cout << "radix_sort " << name << ":\n";
+
+  while (M) {
+    galois::setActiveThreads(M);
+    std::cout << "Using " << M << " threads\n";
+
+    for (int size : {vectorSize, 1025, 100003}) {
+      for (bool blocked : {false, true}) {
+        std::vector<T> V;
+        if (blocked) {
+          V = blockKeys<T>(size);
+        } else {
+          // shifting a negative signed value is undefined
+          typedef typename std::make_unsigned<T>::type U;
+          V.resize(size);
+          for (auto& x : V) {
+            U u = 0;
+            for (size_t i = 0; i < sizeof(T); i += 2)
+              u = (u << 16) ^ U(rand());
+            x = T(u);
+          }
+        }
+        std::vector<T> C = V;
+
+        galois::Timer t;
+        t.start();
+        galois::ParallelSTL::radix_sort(V.begin(), V.end());
+        t.stop();
+
+        galois::Timer t2;
+        t2.start();
+        std::sort(C.begin(), C.end());
+        t2.stop();
+
+        bool eq = (V == C);
+        std::cout << "Size: " << size << (blocked ? " blocked" : "")
+                  << " Galois: " << t.get() << " STL: " << t2.get()
+                  << " Equal: " << eq << "\n";
+        if (!eq)
+          return 1;
       }
-      return 1;
     }
+    M >>= 1;
+  }
+
+  return 0;
+}
+
+//! radix_sort of key-value pairs by key, which is stable
+int do_radix_sort_pairs() {
+  typedef std::pair<uint32_t, uint32_t> KV;
+  unsigned M = galois::substrate::getThreadPool().getMaxThreads();
+  std::cout << "radix_sort pairs:\n";
 
+  while (M) {
+    galois::setActiveThreads(M);
+    std::cout << "Using " << M << " threads\n";
+
+    for (int size : {vectorSize, 1025, 100003}) {
+      std::vector<KV> V(size);
+      for (size_t i = 0; i < V.size(); ++i)
+        V[i] = KV(RandomNumber(), i);
+      std::vector<KV> C = V;
+
+      galois::Timer t;
+      t.start();
+      galois::ParallelSTL::radix_sort(V.begin(), V.end(),
+                                      [](const KV& x) { return x.first; });
+      t.stop();
+
+      galois::Timer t2;
+      t2.start();
+      std::stable_sort(C.begin(), C.end(), [](const KV& a, const KV& b) {
+        return a.first < b.first;
+      });
+      t2.stop();
+
+      bool eq = (V == C);
+      std::cout << "Size: " << size << " Galois: " << t.get()
+                << " STL: " << t2.get() << " Equal: " << eq << "\n";
+      if (!eq)
+        return 1;
+    }
+    M >>= 1;
+  }
+
+  return 0;
+}
+
+//! scans and compaction, also of sizes that leave some threads no elements
+int do_scan() {
+  unsigned M = galois::substrate::getThreadPool().getMaxThreads();
+  std::cout << "scan:\n";
+
+  while (M) {
+    galois::setActiveThreads(M);
+    std::cout << "Using " << M << " threads\n";
+
+    for (int size : {vectorSize, 1025, 7}) {
+      std::vector<uint64_t> V(size);
+      std::generate(V.begin(), V.end(), RandomNumber);
+
+      std::vector<uint64_t> C(size), E(size), F(size);
+      std::partial_sum(V.begin(), V.end(), C.begin());
+      uint64_t sum = 5;
+      for (int i = 0; i < size; ++i) {
+        E[i] = sum;
+        sum += V[i];
+      }
+      std::vector<uint64_t> O;
+      std::copy_if(V.begin(), V.end(), std::back_inserter(O), IsOdd);
+
+      std::vector<uint64_t> X = V, Y(size), Z(size);
+      galois::Timer t;
+      t.start();
+      galois::ParallelSTL::inclusive_scan(X.begin(), X.end(), X.begin());
+      t.stop();
+      galois::ParallelSTL::exclusive_scan(V.begin(), V.end(), Y.begin(),
+                                          uint64_t{5});
+
+      galois::Timer t2;
+      t2.start();
+      auto end = galois::ParallelSTL::compact(V.begin(), V.end(), Z.begin(),
+                                              IsOdd);
+      t2.stop();
+      Z.erase(end, Z.end());
+
+      std::vector<uint64_t> W(1);
+      galois::ParallelSTL::compact_into(V.begin(), V.end(), W, IsOdd);
+
+      bool eq = (X == C) && (Y == E) && (Z == O) && (W == O);
+      if (size == vectorSize)
+        std::cout << "Galois scan: " << t.get() << " compact: " << t2.get()
+                  << " Equal: " << eq << "\n";
+      if (!eq)
+        return 1;
+    }
     M >>= 1;
   }
 
@@ -161,13 +342,18 @@ int do_accumulate() {
 }
 
 int main(int argc, char** argv) {
+  galois::SharedMemSys G;
   if (argc > 1)
     vectorSize = atoi(argv[1]);
   if (vectorSize <= 0)
     vectorSize = 1024 * 1024 * 16;
 
   int ret = 0;
-  //  ret |= do_sort();
+  ret |= do_sort();
+  ret |= do_radix_sort<int32_t>("int32_t");
+  ret |= do_radix_sort<uint64_t>("uint64_t");
+  ret |= do_radix_sort_pairs();
+  ret |= do_scan();
   //  ret |= do_count_if();
   ret |= do_accumulate();
   return ret;
@@ -0,0 +1,128 @@
+/*
+ * This file belongs to the Galois project, a C++ library for exploiting parallelism.
+ * The code is being released under the terms of the 3-Clause BSD License (a
+ * copy is located in LICENSE.txt at the top-level directory).
+ *
+ * Copyright (C) 2018, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ */
+#include "galois/gIO.h"
+#include "galois/runtime/SyncCompression.h"
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+std::mt19937 gen(0);
+
+void checkRuns(const std::vector<uint32_t>& offsets) {
+  size_t size = galois::runtime::offsetRunsSize(offsets.data(), offsets.size());
+  std::vector<uint8_t> encoded(size);
+  GALOIS_ASSERT(galois::runtime::encodeOffsetRuns(
+                    offsets.data(), offsets.size(), encoded.data()) == size);
+
+  std::vector<uint32_t> decoded(offsets.size());
+  GALOIS_ASSERT(galois::runtime::decodeOffsetRuns(
+      encoded.data(), encoded.size(), decoded.data(), decoded.size()));
+  GALOIS_ASSERT(decoded == offsets);
+
+  // a wrong count or a truncated encoding is rejected
+  if (!offsets.empty()) {
+    GALOIS_ASSERT(!galois::runtime::decodeOffsetRuns(
+        encoded.data(), encoded.size(), decoded.data(), offsets.size() - 1));
+    GALOIS_ASSERT(!galois::runtime::decodeOffsetRuns(
+        encoded.data(), encoded.size() - 1, decoded.data(), decoded.size()));
+  }
+}
+
+void checkAllRuns() {
+  checkRuns({});
+  checkRuns({0});
+  checkRuns({UINT32_MAX});
+
+  std::vector<uint32_t> dense, sparse, clustered;
+  for (uint32_t i = 0; i < 10000; ++i) {
+    dense.push_back(i + 7);
+    // no two offsets are consecutive, so every run has length 1
+    sparse.push_back(5 * i + gen() % 3);
+  }
+  for (uint32_t next = 0; clustered.size() < 10000;) {
+    next += gen() % 1000;
+    for (uint32_t len = 1 + gen() % 50; len; --len)
+      clustered.push_back(next++);
+  }
+  checkRuns(dense);
+  checkRuns(sparse);
+  checkRuns(clustered);
+
+  // one run: a gap and a length
+  GALOIS_ASSERT(galois::runtime::offsetRunsSize(dense.data(), dense.size()) ==
+                3);
+}
+
+//! Round trip of a block through blockCompress and blockDecompress
+size_t checkBlock(const std::vector<uint8_t>& src) {
+  size_t capacity = src.size() + src.size() / 255 + 16;
+  std::vector<uint8_t> compressed(capacity);
+  size_t size = galois::runtime::blockCompress(src.data(), src.size(),
+                                               compressed.data(), capacity);
+  GALOIS_ASSERT(size > 0);
+
+  std::vector<uint8_t> decoded(src.size());
+  GALOIS_ASSERT(galois::runtime::blockDecompress(compressed.data(), size,
+                                                 decoded.data(),
+                                                 decoded.size()));
+  GALOIS_ASSERT(decoded == src);
+
+  // the original size is part of the check
+  std::vector<uint8_t> bigger(src.size() + 1);
+  GALOIS_ASSERT(!galois::runtime::blockDecompress(
+      compressed.data(), size, bigger.data(), bigger.size()));
+  return size;
+}
+
+void checkAllBlocks() {
+  // sizes around the minimum match, the literal limits, the 15 and 255 length
+  // codes, and the 64KB match window, most not a multiple of any of them
+  const size_t sizes[] = {0,   1,   4,    5,    12,    13,    17,    100,
+                          270, 271, 4096, 4099, 65535, 65536, 65537, 200003};
+  for (size_t n : sizes) {
+    std::vector<uint8_t> unique(n), same(n, 0xAB), pattern(n), mixed(n);
+    for (size_t i = 0; i < n; ++i) {
+      unique[i]  = gen();
+      pattern[i] = "sync message "[i % 13];
+      mixed[i]   = (i / 1000) % 2 ? unique[i] : uint8_t(i % 7);
+    }
+
+    checkBlock(unique);
+    checkBlock(mixed);
+    size_t sameSize    = checkBlock(same);
+    size_t patternSize = checkBlock(pattern);
+    if (n >= 100) {
+      GALOIS_ASSERT(sameSize < n / 4 && patternSize < n / 4);
+    }
+
+    // data that does not compress does not fit in the size of the input
+    if (n >= 16) {
+      std::vector<uint8_t> out(n);
+      GALOIS_ASSERT(galois::runtime::blockCompress(unique.data(), n,
+                                                   out.data(), n) == 0);
+    }
+  }
+}
+
+int main() {
+  checkAllRuns();
+  checkAllBlocks();
+  return 0;
+}
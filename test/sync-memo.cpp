@@ -0,0 +1,160 @@
+/*
+ * This file belongs to the Galois project, a C++ library for exploiting parallelism.
+ * The code is being released under the terms of the 3-Clause BSD License (a
+ * copy is located in LICENSE.txt at the top-level directory).
+ *
+ * Copyright (C) 2018, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ */
+
+/**
+ * Memoized sync (-syncMemoRounds) must send what the normal path would:
+ * mirrors are all dirty for a few rounds, so that the list switches to raw
+ * value streams, and then the dirty set shrinks. Clean mirrors hold junk
+ * that must never reach their masters. Broadcasts are checked the same way
+ * with dirty masters. Run on two or more hosts.
+ */
+#include "galois/DistGalois.h"
+#include "galois/graphs/DistributedGraph_EdgeCut.h"
+#include "galois/graphs/FileGraph.h"
+#include "galois/runtime/SyncStructures.h"
+#include "galois/gIO.h"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+struct NodeData {
+  uint32_t value;
+};
+
+galois::DynamicBitSet bitset_value;
+
+GALOIS_SYNC_STRUCTURE_REDUCE_ADD(value, uint32_t);
+GALOIS_SYNC_STRUCTURE_BROADCAST(value, uint32_t);
+GALOIS_SYNC_STRUCTURE_BITSET(value);
+
+using Graph = galois::graphs::DistGraphEdgeCut<NodeData, void>;
+
+const size_t numNodes    = 2000;
+const uint32_t junk      = 1000;
+const unsigned numRounds = 12;
+
+//! all mirrors are dirty in rounds 0-3 and 8-11; in between only a few are
+bool dirty(uint64_t gid, unsigned round) {
+  return round < 4 || round >= 8 || gid % 97 == round;
+}
+
+//! only even nodes have in-edges, so only they have mirrors
+void writeGraph(const std::string& name) {
+  galois::graphs::FileGraphWriter w;
+  w.setNumNodes(numNodes);
+  w.setNumEdges(numNodes * 4);
+  w.setSizeofEdgeData(0);
+  w.phase1();
+  for (size_t n = 0; n < numNodes; ++n)
+    w.incrementDegree(n, 4);
+  w.phase2();
+  for (size_t n = 0; n < numNodes; ++n)
+    for (size_t j = 0; j < 4; ++j)
+      w.addNeighbor(n, ((n * 7 + j * 613) % numNodes) & ~size_t(1));
+  w.finish<void>();
+  w.toFile(name);
+}
+
+int main() {
+  galois::DistMemSys G;
+  auto& net = galois::runtime::getSystemNetworkInterface();
+  GALOIS_ASSERT(net.Num >= 2, "run on two or more hosts");
+
+  std::string name = "sync-memo-" + std::to_string(net.ID) + ".gr";
+  writeGraph(name);
+  std::vector<unsigned> scaleFactor;
+  Graph graph(name, "", net.ID, net.Num, scaleFactor);
+  std::remove(name.c_str());
+
+  syncMemoRounds = 100;
+  bitset_value.resize(graph.size());
+
+  // number of mirrors of each master, from the all-dirty round 0
+  std::vector<uint32_t> mirrors(graph.size());
+  std::vector<bool> master(graph.size());
+  for (size_t lid = 0; lid < graph.size(); ++lid)
+    master[lid] = graph.isOwned(graph.getGID(lid));
+
+  for (unsigned r = 0; r < numRounds; ++r) {
+    bitset_value.reset();
+    for (size_t lid = 0; lid < graph.size(); ++lid) {
+      auto& data = graph.getData(lid);
+      if (master[lid]) {
+        data.value = 0;
+      } else if (dirty(graph.getGID(lid), r)) {
+        data.value = 1;
+        bitset_value.set(lid);
+      } else {
+        data.value = junk;
+      }
+    }
+
+    graph.sync<writeDestination, readSource, Reduce_add_value,
+               Broadcast_value, Bitset_value>("SyncMemo");
+
+    for (size_t lid = 0; lid < graph.size(); ++lid) {
+      if (!master[lid])
+        continue;
+      uint32_t value = graph.getData(lid).value;
+      if (r == 0)
+        mirrors[lid] = value;
+      uint32_t expected = dirty(graph.getGID(lid), r) ? mirrors[lid] : 0;
+      GALOIS_ASSERT(value == expected, "round ", r, " node ",
+                    graph.getGID(lid), ": ", value, " instead of ", expected);
+      GALOIS_ASSERT(bitset_value.test(lid) == (expected > 0), "round ", r,
+                    " node ", graph.getGID(lid), ": wrong dirty bit");
+    }
+  }
+
+  // broadcast only: the master lists are subsets of the masters
+  for (unsigned r = 0; r < numRounds; ++r) {
+    bitset_value.reset();
+    for (size_t lid = 0; lid < graph.size(); ++lid) {
+      auto& data = graph.getData(lid);
+      if (!master[lid]) {
+        data.value = junk;
+      } else if (dirty(graph.getGID(lid), r)) {
+        data.value = graph.getGID(lid) + r;
+        bitset_value.set(lid);
+      } else {
+        data.value = junk + 1;
+      }
+    }
+
+    graph.sync<writeSource, readDestination, Reduce_add_value,
+               Broadcast_value, Bitset_value>("SyncMemoBroadcast");
+
+    for (size_t lid = 0; lid < graph.size(); ++lid) {
+      if (master[lid])
+        continue;
+      uint64_t gid      = graph.getGID(lid);
+      uint32_t value    = graph.getData(lid).value;
+      uint32_t expected = dirty(gid, r) ? gid + r : junk;
+      GALOIS_ASSERT(value == expected, "broadcast round ", r, " node ", gid,
+                    ": ", value, " instead of ", expected);
+    }
+  }
+
+  size_t shared = 0;
+  for (size_t lid = 0; lid < graph.size(); ++lid)
+    shared += mirrors[lid];
+  GALOIS_ASSERT(shared > 0, "no master has a mirror");
+  return 0;
+}
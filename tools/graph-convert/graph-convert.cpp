@@ -75,6 +75,7 @@ enum ConvertMode {
   gr2treegr,
   gr2trigr,
   gr2totem,
+  gr2vgr,
   mtx2gr,
   nodelist2gr,
   pbbs2gr,
@@ -172,6 +173,8 @@ static cll::opt<ConvertMode> convertMode(
         clEnumVal(gr2trigr, "Convert symmetric binary gr to triangular form by "
                             "removing reverse edges"),
         clEnumVal(gr2totem, "Convert binary gr totem input format"),
+        clEnumVal(gr2vgr, "Convert binary gr to compressed (version 3) gr "
+                          "with delta + varint encoded edges"),
         clEnumVal(mtx2gr, "Convert matrix market format to binary gr"),
         clEnumVal(nodelist2gr, "Convert node list to binary gr"),
         clEnumVal(pbbs2gr, "Convert pbbs graph to binary gr"),
@@ -2507,6 +2510,22 @@ struct Gr2Totem : public HasNoVoidSpecialization {
     printStatus(graph.size(), graph.sizeEdges());
   }
 };
+
+/**
+ * Writes the graph in the compressed (version 3) format: sorted neighbors
+ * stored as varint encoded gaps. Edge data is kept as is.
+ */
+struct Gr2Vgr : public Conversion {
+  template <typename EdgeTy>
+  void convert(const std::string& infilename, const std::string& outfilename) {
+    typedef galois::graphs::FileGraph Graph;
+
+    Graph graph;
+    graph.fromFile(infilename);
+    graph.toCompressedFile(outfilename);
+    printStatus(graph.size(), graph.sizeEdges());
+  }
+};
 /**
  * METIS format (1-indexed). See METIS 4.10 manual, section 4.5.
  *  % comment prefix
@@ -2877,6 +2896,9 @@ int main(int argc, char** argv) {
   case gr2totem:
     convert<Gr2Totem<IdLess>>();
     break;
+  case gr2vgr:
+    convert<Gr2Vgr>();
+    break;
   case mtx2gr:
     convert<Mtx2Gr>();
     break;